@@ -0,0 +1,26 @@
+/**
+ * @file ffconf.h
+ * @brief FatFs配置覆盖 - 在FatFs自带的ffconf.h之上打开micro_sd需要的选项
+ * @version 1.0.0
+ *
+ * ff.h以 #include "ffconf.h" 包含同目录下的配置，其中的#define会覆盖命令行上的
+ * -DFF_USE_xxx。CMakeLists.txt把FatFs源文件复制到构建目录，自带的ffconf.h改名为
+ * ffconf_stock.h，并用本文件代替它。其余选项 (及FFCONF_DEF) 保持FatFs自带的值。
+ */
+
+#include "ffconf_stock.h"
+
+#undef FF_USE_LFN
+#define FF_USE_LFN 1            // 长文件名，缓冲区在静态存储区
+
+#undef FF_LFN_UNICODE
+#define FF_LFN_UNICODE 0        // 文件名使用ANSI/OEM编码
+
+#undef FF_USE_FASTSEEK
+#define FF_USE_FASTSEEK 1       // 打开文件的fast_seek选项 (簇链映射表)
+
+#undef FF_USE_EXPAND
+#define FF_USE_EXPAND 1         // 连续预分配 (f_expand)，ExtentWriter依赖
+
+#undef FF_USE_CHMOD
+#define FF_USE_CHMOD 1          // copy_file保留属性和修改时间 (f_chmod/f_utime)
@@ -0,0 +1,103 @@
+/**
+ * @file bench_common.hpp
+ * @brief 主机基准公共部分 - 镜像文件上的SD卡模拟器、挂载和虚拟总线计时
+ * @version 1.0.0
+ *
+ * 各host_*_bench只包含自己的负载：
+ *   Bench::Fixture bench(argc > 1 ? argv[1] : "xxx_bench.img");
+ *   if (!bench.mount("LABEL")) return 1;
+ *   Bench::Stopwatch watch(bench.emulator());
+ *   ... 负载 ...
+ *   Bench::report("标签", "阶段", 次数, watch);
+ */
+
+#pragma once
+
+#include "rw_sd.hpp"
+#include "sd_spi_block_device.hpp"
+#include "image_block_device.hpp"
+#include "sd_card_emulator.hpp"
+#include <stdio.h>
+
+namespace MicroSD {
+namespace Bench {
+
+constexpr uint32_t IMAGE_SECTORS = 64 * 1024 * 1024 / BlockDevice::SECTOR_SIZE;
+
+/**
+ * @brief 基准环境: 64MB镜像文件 → SD卡模拟器 → SdSpiBlockDevice → RWSD
+ */
+class Fixture {
+private:
+    ImageBlockDevice image_;
+    SdCardEmulator* emulator_;          // 由sd_经块设备持有
+    RWSD sd_;
+
+public:
+    explicit Fixture(const char* image_path)
+        : image_(image_path, IMAGE_SECTORS), emulator_(new SdCardEmulator(image_)),
+          sd_(std::make_unique<SdSpiBlockDevice>(std::unique_ptr<SpiTransport>(emulator_), Config::DEFAULT)) {}
+
+    Fixture(const Fixture&) = delete;
+    Fixture& operator=(const Fixture&) = delete;
+
+    /**
+     * @brief 挂载镜像，镜像尚未格式化时以label格式化
+     */
+    bool mount(const char* label) {
+        if (!sd_.initialize().is_ok() && !sd_.format(label).is_ok()) {
+            printf("无法挂载或格式化镜像\n");
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 同步并打印结束行
+     */
+    void finish() {
+        (void)sd_.sync();
+        printf("===== 基准完成 =====\n");
+    }
+
+    RWSD& sd() { return sd_; }
+    SdCardEmulator& emulator() { return *emulator_; }
+};
+
+/**
+ * @brief 按模拟器的虚拟总线时间计时，并统计期间卡上读写的块数
+ */
+class Stopwatch {
+private:
+    const SdCardEmulator& emulator_;
+    uint64_t start_us_;
+    uint32_t blocks_read_;
+    uint32_t blocks_written_;
+
+public:
+    explicit Stopwatch(const SdCardEmulator& emulator) : emulator_(emulator) { restart(); }
+
+    void restart() {
+        start_us_ = emulator_.elapsed_us();
+        blocks_read_ = emulator_.get_stats().blocks_read;
+        blocks_written_ = emulator_.get_stats().blocks_written;
+    }
+
+    uint64_t elapsed_us() const { return emulator_.elapsed_us() - start_us_; }
+    uint32_t blocks_read() const { return emulator_.get_stats().blocks_read - blocks_read_; }
+    uint32_t blocks_written() const { return emulator_.get_stats().blocks_written - blocks_written_; }
+};
+
+/**
+ * @brief 打印一个阶段的次数、耗时、每秒次数和卡上读写的块数
+ */
+inline void report(const char* label, const char* phase, uint32_t operations, const Stopwatch& watch) {
+    uint64_t elapsed_us = watch.elapsed_us();
+    double seconds = elapsed_us / 1e6;
+    printf("[%s] %s: %u 次, %.1f ms, %.0f 次/秒, 读 %u 块, 写 %u 块\n", label, phase, operations,
+           elapsed_us / 1000.0, seconds > 0 ? operations / seconds : 0.0, watch.blocks_read(),
+           watch.blocks_written());
+}
+
+} // namespace Bench
+} // namespace MicroSD
@@ -0,0 +1,237 @@
+/**
+ * @file host_heap_check.cpp
+ * @brief 无堆检查 - 锁定全局分配器后运行热路径API，统计堆分配次数
+ * @version 1.0.0
+ *
+ * 用法: host_heap_check [镜像文件]
+ * 内部缓冲区全部来自静态数组上的std::pmr内存池。准备阶段 (构造设备、
+ * 初始化、预先构造路径字符串) 允许使用堆；之后全局operator new被锁定，
+ * 文件句柄读写、一次性读写、复制、容量查询、同步、重命名、删除、目录迭代器、
+ * TreeWalker遍历和目录树打印循环执行，期间任何堆分配都会被记录，存在分配时
+ * 以非零状态退出。list_directory()和list_directory_tree()按设计返回std::vector/
+ * std::string，同样在锁定期间调用，其分配单独统计，不计入检查结果。
+ */
+
+#include "rw_sd.hpp"
+#include "image_block_device.hpp"
+#include "tree_walker.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+using namespace MicroSD;
+
+namespace {
+
+bool g_heap_locked = false;
+bool g_heap_expected = false;       // 正在调用返回容器的API，分配单独统计
+size_t g_locked_allocations = 0;
+size_t g_locked_bytes = 0;
+size_t g_expected_allocations = 0;
+
+void* counted_malloc(size_t size) noexcept {
+    if (g_heap_locked && g_heap_expected) {
+        ++g_expected_allocations;
+    } else if (g_heap_locked) {
+        ++g_locked_allocations;
+        g_locked_bytes += size;
+    }
+    return malloc(size ? size : 1);
+}
+
+void* counted_alloc(size_t size) {
+    void* memory = counted_malloc(size);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+/**
+ * @brief 统计遍历到的文件数
+ */
+class CountingSink : public WalkSink {
+public:
+    uint32_t files = 0;
+
+    WalkAction enter(const WalkEntry& entry) override {
+        files += !entry.is_directory();
+        return WalkAction::CONTINUE;
+    }
+};
+
+constexpr uint32_t ITERATIONS = 200;
+constexpr size_t ARENA_SIZE = 192 * 1024;     // 池按块逐次加倍向上游申请，预留增长空间
+
+alignas(std::max_align_t) uint8_t g_arena_storage[ARENA_SIZE];
+
+} // namespace
+
+void* operator new(size_t size) { return counted_alloc(size); }
+void* operator new[](size_t size) { return counted_alloc(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return counted_malloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return counted_malloc(size); }
+void operator delete(void* memory) noexcept { free(memory); }
+void operator delete[](void* memory) noexcept { free(memory); }
+void operator delete(void* memory, size_t) noexcept { free(memory); }
+void operator delete[](void* memory, size_t) noexcept { free(memory); }
+
+int main(int argc, char** argv) {
+    const char* image_path = argc > 1 ? argv[1] : "heap_check.img";
+
+    printf("\n===== 无堆检查 =====\n");
+#if MICRO_SD_HEAP_FREE
+    printf("构建模式: MICRO_SD_HEAP_FREE\n");
+#else
+    printf("构建模式: 默认 (显式提供内存资源)\n");
+#endif
+
+    // 内存池: 静态数组 -> 单调分配 -> 可回收的池
+    std::pmr::monotonic_buffer_resource arena(g_arena_storage, sizeof(g_arena_storage),
+                                              std::pmr::null_memory_resource());
+    std::pmr::pool_options pool_options;
+    pool_options.largest_required_pool_block = 8 * 1024;
+    std::pmr::unsynchronized_pool_resource pool(pool_options, &arena);
+
+    auto device = std::make_unique<ImageBlockDevice>(image_path, 16 * 1024 * 1024 / BlockDevice::SECTOR_SIZE);
+    RWSD sd(std::move(device));
+    sd.set_memory_resource(&pool);
+
+    CacheConfig cache_config;
+    cache_config.ram_budget = 16 * 1024;
+    if (!sd.configure_cache(cache_config).is_ok()) {
+        printf("配置缓存失败\n");
+        return 1;
+    }
+    if (!sd.initialize().is_ok() && !sd.format("HEAPCHK").is_ok()) {
+        printf("无法挂载或格式化镜像\n");
+        return 1;
+    }
+
+    // 路径在锁定前构造 (超出短字符串优化的std::string本身需要堆)
+    const std::string dir = "/heap_check";
+    const std::string log_path = "/heap_check/sensor_log.bin";
+    const std::string text_path = "/heap_check/status_text.txt";
+    const std::string copy_path = "/heap_check/sensor_copy.bin";
+    const std::string moved_path = "/heap_check/sensor_moved.bin";
+    const std::string nested_dir = "/heap_check/nested";
+    const std::string nested_path = "/heap_check/nested/nested_file.bin";
+    const std::string tree_path = "/heap_check/nested/tree_dump.txt";
+    const std::string append_mode = "a";
+    const std::string read_mode = "r";
+    const std::string write_mode = "w";
+    (void)sd.create_directory(dir);
+    (void)sd.create_directory(nested_dir);
+    (void)sd.delete_file(log_path);
+    (void)sd.write_text_file(nested_path, "nested\n");
+
+    // 目录树打印的目标和遍历器在锁定前准备
+    FILE* null_stream = fopen("/dev/null", "w");
+    if (null_stream == nullptr) {
+        printf("无法打开/dev/null\n");
+        return 1;
+    }
+    TreeWalker walker(sd);
+    DirectoryFilter bin_filter;
+    bin_filter.extension = "bin";
+
+    uint8_t sample[48];
+    uint8_t readback[sizeof(sample)];
+    std::string line;
+    line.reserve(64);
+    size_t failures = 0;
+
+    g_heap_locked = true;
+    for (uint32_t i = 0; i < ITERATIONS; ++i) {
+        for (size_t j = 0; j < sizeof(sample); ++j) {
+            sample[j] = static_cast<uint8_t>(i + j);
+        }
+
+        // 文件句柄
+        auto handle = sd.open_file(log_path, append_mode);
+        if (!handle.is_ok()) {
+            ++failures;
+            continue;
+        }
+        failures += handle->write(sample, sizeof(sample)).value_or(0) != sizeof(sample);
+        failures += !handle->write_line("sample").is_ok();
+        failures += !handle->flush().is_ok();
+        size_t end = handle->tell().value_or(0);
+        failures += handle->size().value_or(0) != end;
+        handle->close();
+
+        auto reader = sd.open_file(log_path, read_mode);
+        if (reader.is_ok()) {
+            failures += !reader->seek(end - sizeof(sample) - 7).is_ok();
+            failures += reader->read_into(readback, sizeof(readback)).value_or(0) != sizeof(readback);
+            failures += memcmp(sample, readback, sizeof(sample)) != 0;
+            failures += !reader->read_text(line, 16).is_ok();
+            reader->close();
+        } else {
+            ++failures;
+        }
+
+        // 一次性读写与复制
+        failures += !sd.write_text_file(text_path, "status: ok\n").is_ok();
+        failures += !sd.append_file(text_path, sample, sizeof(sample)).is_ok();
+        failures += sd.read_file_into(text_path, readback, sizeof(readback), 11).value_or(0) != sizeof(readback);
+        failures += !sd.copy_file(log_path, copy_path, CopyOptions()).is_ok();
+        failures += !sd.rename(copy_path, moved_path).is_ok();
+        failures += !sd.delete_file(moved_path).is_ok();
+
+        // 查询与同步
+        failures += !sd.file_exists(log_path);
+        failures += !sd.get_capacity().is_ok();
+        failures += !sd.sync().is_ok();
+
+        // 目录迭代器
+        auto directory = sd.open_directory(dir, bin_filter);
+        if (directory.is_ok()) {
+            size_t entries = 0;
+            for (const FILINFO& entry : *directory) {
+                entries += entry.fname[0] != '\0';
+            }
+            failures += entries == 0 || directory->error() != ErrorCode::SUCCESS;
+            DirectoryCursor cursor = directory->cursor();
+            failures += !directory->rewind().is_ok();
+            failures += !directory->seek(cursor).is_ok();
+            directory->close();
+        } else {
+            ++failures;
+        }
+
+        // 目录树遍历与打印 (未排序和排序两种模式)
+        for (bool sorted : {false, true}) {
+            CountingSink sink;
+            WalkOptions options;
+            options.sorted = sorted;
+            failures += !walker.walk(dir, sink, options).is_ok() || sink.files < 3;
+            failures += !sd.print_directory_tree(dir, null_stream, 10, sorted).is_ok();
+        }
+        auto dump = sd.open_file(tree_path, write_mode);
+        if (dump.is_ok()) {
+            TreePrinter printer(*dump);
+            failures += !walker.walk(nested_dir, printer).is_ok() || printer.error() != ErrorCode::SUCCESS;
+            dump->close();
+        } else {
+            ++failures;
+        }
+
+        // 返回容器的API: 结果本身需要堆，分配单独统计
+        g_heap_expected = true;
+        failures += sd.list_directory(dir).map([](const std::vector<FileInfo>& files) {
+            return files.size();
+        }).value_or(0) == 0;
+        failures += !sd.list_directory_tree(dir).is_ok();
+        g_heap_expected = false;
+    }
+    g_heap_locked = false;
+    fclose(null_stream);
+
+    printf("迭代 %u 次, 操作失败 %zu 次\n", ITERATIONS, failures);
+    printf("锁定期间堆分配: %zu 次 (%zu 字节)\n", g_locked_allocations, g_locked_bytes);
+    printf("list_directory/list_directory_tree的结果分配: %zu 次 (不计入)\n", g_expected_allocations);
+    printf("===== %s =====\n", g_locked_allocations == 0 && failures == 0 ? "检查通过" : "检查失败");
+    return g_locked_allocations == 0 && failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+/**
+ * @file host_image_demo.cpp
+ * @brief 主机磁盘镜像示例 - 在Linux上运行RWSD
+ * @version 1.0.0
+ *
+ * 用法: host_image_demo [镜像文件] [容量MB]
+ * 镜像不存在时按指定容量创建并格式化为FAT32
+ */
+
+#include "rw_sd.hpp"
+#include "image_block_device.hpp"
+#include "platform.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace MicroSD;
+
+int main(int argc, char** argv) {
+    const char* image_path = argc > 1 ? argv[1] : "sdcard.img";
+    uint32_t size_mb = argc > 2 ? static_cast<uint32_t>(atoi(argv[2])) : 64;
+
+    printf("\n===== RWSD 主机镜像示例 =====\n");
+
+    auto device = std::make_unique<ImageBlockDevice>(image_path, size_mb * 1024 * 1024 / BlockDevice::SECTOR_SIZE);
+    RWSD sd(std::move(device));
+
+    auto init_result = sd.initialize();
+    if (!init_result.is_ok()) {
+        printf("挂载失败 (%s)，格式化镜像...\n", StorageDevice::get_error_description(init_result.error_code()).c_str());
+        auto format_result = sd.format("HOSTIMG");
+        if (!format_result.is_ok()) {
+            printf("格式化失败: %s\n", StorageDevice::get_error_description(format_result.error_code()).c_str());
+            return 1;
+        }
+    }
+    printf("%s", sd.get_config_info().c_str());
+    printf("%s", sd.get_status_info().c_str());
+
+    // 顺序写入/读取吞吐量
+    const size_t file_size = 1024 * 1024;
+    std::vector<uint8_t> data(file_size);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>(i * 31 + 7);
+    }
+
+    uint64_t start = Platform::now_us();
+    auto write_result = sd.write_file("/host_test.bin", data);
+    uint64_t write_us = Platform::now_us() - start;
+    if (!write_result.is_ok()) {
+        printf("写入失败: %s\n", StorageDevice::get_error_description(write_result.error_code()).c_str());
+        return 1;
+    }
+
+    start = Platform::now_us();
+    auto read_result = sd.read_file("/host_test.bin");
+    uint64_t read_us = Platform::now_us() - start;
+    if (!read_result.is_ok() || *read_result != data) {
+        printf("读取校验失败\n");
+        return 1;
+    }
+
+    printf("顺序写入: %zu 字节, %llu us\n", file_size, (unsigned long long)write_us);
+    printf("顺序读取: %zu 字节, %llu us\n", file_size, (unsigned long long)read_us);
+
+    // 原子替换配置文件: 启动时先恢复可能被中断的写入
+    auto recovered = sd.recover_file("/config.ini");
+    if (recovered.is_ok() && *recovered) {
+        printf("已完成被中断的 /config.ini 替换\n");
+    }
+    for (int revision = 1; revision <= 3; ++revision) {
+        char config[64];
+        int length = snprintf(config, sizeof(config), "revision=%d\nmode=host\n", revision);
+        if (!sd.write_file_atomic("/config.ini", std::string_view(config, length)).is_ok()) {
+            printf("原子写入失败\n");
+            return 1;
+        }
+    }
+    auto config_result = sd.read_text_file("/config.ini");
+    if (config_result.is_ok()) {
+        printf("原子写入后的配置:\n%s", config_result->c_str());
+    }
+
+    // 轮询文件是否存在: 第一次之后由路径查找缓存回答，包括不存在的文件
+    for (int poll = 0; poll < 100; ++poll) {
+        (void)sd.file_exists("/config.ini");
+        (void)sd.file_exists("/update/firmware.bin");
+    }
+    DentryCacheStats dentry_stats = sd.get_dentry_cache_stats();
+    printf("路径查找缓存: 命中 %u (不存在 %u) / 未命中 %u, 命中率 %.1f%%\n", dentry_stats.hits,
+           dentry_stats.negative_hits, dentry_stats.misses, dentry_stats.hit_rate() * 100.0f);
+
+    printf("\n目录树:\n");
+    (void)sd.print_directory_tree("/", stdout);
+
+    // 目录占用: 第一次遍历后由缓存回答，写入按变化量更新
+    printf("\n目录占用 (字节 / 簇 / 簇内浪费):\n");
+    auto print_usage = [](const char* path, const DirectoryUsage& usage) {
+        printf("%10llu %6u %8llu  %s\n", (unsigned long long)usage.bytes, usage.clusters,
+               (unsigned long long)usage.slack_bytes(), path);
+    };
+    (void)sd.disk_usage("/", print_usage, 1);
+    (void)sd.append_text_file("/config.ini", "note=appended\n");
+    auto usage = sd.disk_usage("/");
+    if (usage.is_ok()) {
+        UsageCacheStats usage_stats = sd.get_usage_cache_stats();
+        printf("追加后: %llu 字节, %u 个文件 (缓存命中 %u, 增量更新 %u)\n", (unsigned long long)usage->bytes,
+               usage->files, usage_stats.hits, usage_stats.updates);
+    }
+
+    (void)sd.sync();
+    printf("\n===== 示例完成 =====\n");
+    return 0;
+}
@@ -0,0 +1,129 @@
+/**
+ * @file host_kv_bench.cpp
+ * @brief 键值存储基准 - 对比每个记录一个文件 (write_text_file) 与KvStore
+ * @version 1.0.0
+ *
+ * 用法: host_kv_bench [镜像文件]
+ * 通过SD卡模拟器运行，耗时按虚拟总线时间计算。
+ */
+
+#include "bench_common.hpp"
+#include "kv_store.hpp"
+#include <stdio.h>
+#include <random>
+
+using namespace MicroSD;
+
+namespace {
+
+constexpr uint32_t KEY_COUNT = 500;
+constexpr uint32_t UPDATES = 2000;
+
+int format_key(char* buffer, size_t size, uint32_t index) {
+    return snprintf(buffer, size, "sensor%04u", index);
+}
+
+int format_value(char* buffer, size_t size, uint32_t round) {
+    return snprintf(buffer, size, "{\"round\":%u,\"min\":%d,\"max\":%d}", round, (int)(round % 17), (int)(round % 31) + 20);
+}
+
+void run_file_pass(Bench::Fixture& bench) {
+    RWSD& sd = bench.sd();
+    (void)sd.create_directory("/records");
+    char path[48];
+    char value[64];
+    std::mt19937 rng(7);
+
+    Bench::Stopwatch watch(bench.emulator());
+    for (uint32_t i = 0; i < UPDATES; ++i) {
+        uint32_t key = rng() % KEY_COUNT;
+        snprintf(path, sizeof(path), "/records/sensor%04u.txt", key);
+        int length = format_value(value, sizeof(value), i);
+        if (!sd.write_text_file(path, std::string_view(value, length)).is_ok()) {
+            printf("[单独文件] 写入失败\n");
+            return;
+        }
+    }
+    Bench::report("单独文件", "写入", UPDATES, watch);
+
+    watch.restart();
+    uint32_t found = 0;
+    for (uint32_t key = 0; key < KEY_COUNT; ++key) {
+        snprintf(path, sizeof(path), "/records/sensor%04u.txt", key);
+        found += sd.read_file_into(path, value, sizeof(value)).is_ok();
+    }
+    Bench::report("单独文件", "读取", KEY_COUNT, watch);
+    printf("[单独文件] 命中 %u 个键\n", found);
+}
+
+void run_kv_pass(Bench::Fixture& bench) {
+    RWSD& sd = bench.sd();
+    KvConfig config;
+    config.directory = "/kvbench";
+    config.max_keys = KEY_COUNT;
+    config.segment_bytes = 16 * 1024;
+    config.max_value_size = 64;
+    KvStore kv(sd, config);
+    if (!kv.open().is_ok()) {
+        printf("[KvStore] 打开失败\n");
+        return;
+    }
+
+    char key[32];
+    char value[64];
+    std::mt19937 rng(7);
+    Bench::Stopwatch watch(bench.emulator());
+    for (uint32_t i = 0; i < UPDATES; ++i) {
+        int key_length = format_key(key, sizeof(key), rng() % KEY_COUNT);
+        int length = format_value(value, sizeof(value), i);
+        if (!kv.put(std::string_view(key, key_length), std::string_view(value, length)).is_ok()) {
+            printf("[KvStore] 写入失败\n");
+            return;
+        }
+        // 主循环中的后台压缩
+        if (kv.needs_compaction()) {
+            (void)kv.compact_step(32);
+        }
+    }
+    if (!kv.sync().is_ok()) {
+        printf("[KvStore] 同步失败\n");
+        return;
+    }
+    Bench::report("KvStore", "写入", UPDATES, watch);
+
+    watch.restart();
+    uint32_t found = 0;
+    for (uint32_t i = 0; i < KEY_COUNT; ++i) {
+        int key_length = format_key(key, sizeof(key), i);
+        found += kv.get(std::string_view(key, key_length), value, sizeof(value)).is_ok();
+    }
+    Bench::report("KvStore", "读取", KEY_COUNT, watch);
+
+    KvStats stats = kv.get_stats();
+    printf("[KvStore] 命中 %u 个键, %u 个段, 有效 %llu / %llu 字节, 压缩 %u 次\n", found, stats.segments,
+           (unsigned long long)stats.live_bytes, (unsigned long long)stats.total_bytes, stats.compactions);
+
+    // 重新打开: 扫描段文件重建索引
+    (void)kv.close();
+    watch.restart();
+    if (kv.open().is_ok()) {
+        Bench::report("KvStore", "重新打开", kv.get_stats().recovered_records, watch);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Bench::Fixture bench(argc > 1 ? argv[1] : "kv_bench.img");
+
+    printf("\n===== 键值存储基准 =====\n");
+    if (!bench.mount("KVBENCH")) {
+        return 1;
+    }
+
+    run_file_pass(bench);
+    run_kv_pass(bench);
+
+    bench.finish();
+    return 0;
+}
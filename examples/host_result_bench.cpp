@@ -0,0 +1,150 @@
+/**
+ * @file host_result_bench.cpp
+ * @brief Result<T>返回开销基准 - 对比旧版 (std::string消息) 与当前实现
+ * @version 1.0.0
+ *
+ * 用法: host_result_bench [镜像文件]
+ * 第一部分在纯CPU循环中比较两种结果类型的单次返回开销；
+ * 第二部分在镜像上以FileHandle::write小块写入测量真实每次调用耗时，
+ * 同一写入循环分别经由旧版布局 (结果转换为LegacyResult返回) 和当前布局各运行一次。
+ */
+
+#include "rw_sd.hpp"
+#include "image_block_device.hpp"
+#include "platform.hpp"
+#include <stdio.h>
+#include <string>
+
+using namespace MicroSD;
+
+namespace {
+
+/**
+ * @brief 旧版结果类型 (携带std::string消息)，仅用于对比
+ */
+template<typename T>
+class LegacyResult {
+private:
+    std::optional<T> value_;
+    ErrorCode error_code_;
+    std::string error_message_;
+
+public:
+    LegacyResult(T&& value) : value_(std::move(value)), error_code_(ErrorCode::SUCCESS) {}
+    LegacyResult(ErrorCode error, std::string message = "")
+        : error_code_(error), error_message_(std::move(message)) {}
+
+    bool is_ok() const { return error_code_ == ErrorCode::SUCCESS; }
+    const T& operator*() const { return value_.value(); }
+};
+
+constexpr uint32_t CPU_ITERATIONS = 10000000;
+constexpr uint32_t WRITE_CALLS = 20000;
+constexpr size_t WRITE_CHUNK = 32;
+
+// 模拟FileHandle::write的返回路径: 检查参数后返回写入字节数
+__attribute__((noinline)) LegacyResult<size_t> legacy_write(const void* data, size_t size) {
+    if (data == nullptr) {
+        return LegacyResult<size_t>(ErrorCode::INVALID_PARAMETER);
+    }
+    return LegacyResult<size_t>(size_t(size));
+}
+
+__attribute__((noinline)) Result<size_t> lean_write(const void* data, size_t size) {
+    if (data == nullptr) {
+        return Result<size_t>(ErrorCode::INVALID_PARAMETER);
+    }
+    return Result<size_t>(size_t(size));
+}
+
+// 旧版布局的FileHandle::write: 同一写入，结果以LegacyResult返回 (出错时构造消息字符串)
+__attribute__((noinline)) LegacyResult<size_t> legacy_file_write(RWSD::FileHandle& handle, const void* data,
+                                                                size_t size) {
+    auto result = handle.write(data, size);
+    if (!result.is_ok()) {
+        return LegacyResult<size_t>(result.error_code(), result.error_message());
+    }
+    return LegacyResult<size_t>(size_t(*result));
+}
+
+__attribute__((noinline)) Result<size_t> lean_file_write(RWSD::FileHandle& handle, const void* data, size_t size) {
+    return handle.write(data, size);
+}
+
+template<typename F>
+double time_loop(F&& call) {
+    uint8_t byte = 0;
+    volatile size_t total = 0;
+    uint64_t start = Platform::now_us();
+    for (uint32_t i = 0; i < CPU_ITERATIONS; ++i) {
+        total = total + call(&byte, i & 0xFF);
+    }
+    uint64_t elapsed = Platform::now_us() - start;
+    return elapsed * 1000.0 / CPU_ITERATIONS;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* image_path = argc > 1 ? argv[1] : "result_bench.img";
+
+    printf("\n===== Result<T> 返回开销基准 =====\n");
+    printf("sizeof(LegacyResult<size_t>) = %zu, sizeof(Result<size_t>) = %zu\n",
+           sizeof(LegacyResult<size_t>), sizeof(Result<size_t>));
+
+    double legacy_ns = time_loop([](const void* d, size_t n) {
+        auto r = legacy_write(d, n);
+        return r.is_ok() ? *r : 0;
+    });
+    double lean_ns = time_loop([](const void* d, size_t n) {
+        auto r = lean_write(d, n);
+        return r.is_ok() ? *r : 0;
+    });
+    printf("CPU循环: 旧版 %.2f ns/次, 当前 %.2f ns/次\n", legacy_ns, lean_ns);
+
+    // 真实写入路径
+    auto device = std::make_unique<ImageBlockDevice>(image_path, 16 * 1024 * 1024 / BlockDevice::SECTOR_SIZE);
+    RWSD sd(std::move(device));
+    if (!sd.initialize().is_ok() && !sd.format("RESBENCH").is_ok()) {
+        printf("无法挂载或格式化镜像\n");
+        return 1;
+    }
+
+    // 两种布局各在新文件上运行同一写入循环
+    auto time_writes = [&sd](const char* label, auto&& call) {
+        auto handle = sd.open_file("/result_bench.bin", "w");
+        if (!handle.is_ok()) {
+            printf("打开文件失败: %s\n", StorageDevice::get_error_description(handle.error_code()).c_str());
+            return false;
+        }
+
+        uint8_t chunk[WRITE_CHUNK] = {};
+        size_t written = 0;
+        uint64_t start = Platform::now_us();
+        for (uint32_t i = 0; i < WRITE_CALLS; ++i) {
+            chunk[0] = static_cast<uint8_t>(i);
+            written += call(*handle, chunk, sizeof(chunk));
+        }
+        uint64_t elapsed = Platform::now_us() - start;
+        handle->close();
+        (void)sd.delete_file("/result_bench.bin");
+
+        printf("FileHandle::write %zu字节 x %u (%s): %.1f ns/次 (共 %zu 字节)\n",
+               WRITE_CHUNK, WRITE_CALLS, label, elapsed * 1000.0 / WRITE_CALLS, written);
+        return true;
+    };
+
+    bool ok = time_writes("旧版", [](RWSD::FileHandle& h, const void* d, size_t n) {
+        auto r = legacy_file_write(h, d, n);
+        return r.is_ok() ? *r : 0;
+    });
+    ok = ok && time_writes("当前", [](RWSD::FileHandle& h, const void* d, size_t n) {
+        return lean_file_write(h, d, n).value_or(0);
+    });
+    if (!ok) {
+        return 1;
+    }
+
+    printf("===== 基准完成 =====\n");
+    return 0;
+}
@@ -0,0 +1,113 @@
+/**
+ * @file host_seek_bench.cpp
+ * @brief 随机定位基准 - 对比普通定位与快速定位 (簇链映射表) 的4KB随机读取
+ * @version 1.0.0
+ *
+ * 用法: host_seek_bench [镜像文件]
+ * 交替追加两个文件制造碎片，然后在其中一个文件上执行随机4KB读取。
+ * 通过SD卡模拟器运行，耗时按虚拟总线时间计算；扇区缓存被禁用，
+ * 因此普通定位遍历FAT的开销直接体现为卡上的块读取。
+ */
+
+#include "bench_common.hpp"
+#include <stdio.h>
+#include <string.h>
+#include <random>
+
+using namespace MicroSD;
+
+namespace {
+
+constexpr size_t FILE_SIZE = 8 * 1024 * 1024;
+constexpr size_t FRAGMENT_SIZE = 64 * 1024;     // 交替写入的粒度，决定片段大小
+constexpr size_t READ_SIZE = 4096;
+constexpr uint32_t READ_COUNT = 200;
+
+bool build_fragmented_file(RWSD& sd) {
+    auto target = sd.open_file("/seek_target.bin", "w");
+    auto filler = sd.open_file("/seek_filler.bin", "w");
+    if (!target.is_ok() || !filler.is_ok()) {
+        return false;
+    }
+    std::vector<uint8_t> chunk(FRAGMENT_SIZE);
+    for (size_t offset = 0; offset < FILE_SIZE; offset += FRAGMENT_SIZE) {
+        for (size_t i = 0; i < chunk.size(); i += 4) {
+            uint32_t value = static_cast<uint32_t>(offset + i);
+            memcpy(&chunk[i], &value, sizeof(value));
+        }
+        if (target->write(chunk).value_or(0) != chunk.size() ||
+            filler->write(chunk).value_or(0) != chunk.size()) {
+            return false;
+        }
+        // 每次写入后同步，使两个文件的簇交错分配
+        if (!target->flush().is_ok() || !filler->flush().is_ok()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void run_pass(Bench::Fixture& bench, bool fast_seek) {
+    const char* label = fast_seek ? "快速定位" : "普通定位";
+    OpenOptions options;
+    options.fast_seek = fast_seek;
+    options.max_link_map_bytes = 16 * 1024;
+
+    Bench::Stopwatch watch(bench.emulator());
+    auto handle = bench.sd().open_file("/seek_target.bin", "r", options);
+    if (!handle.is_ok()) {
+        printf("[%s] 打开文件失败\n", label);
+        return;
+    }
+    Bench::report(label, "打开", 1, watch);
+    FastSeekInfo info = handle->fast_seek_info();
+
+    std::mt19937 rng(12345);
+    uint8_t buffer[READ_SIZE];
+    uint32_t errors = 0;
+    watch.restart();
+    for (uint32_t i = 0; i < READ_COUNT; ++i) {
+        size_t offset = (rng() % (FILE_SIZE / READ_SIZE)) * READ_SIZE;
+        if (!handle->seek(offset).is_ok() || handle->read_into(buffer, sizeof(buffer)).value_or(0) != sizeof(buffer)) {
+            ++errors;
+            continue;
+        }
+        uint32_t value;
+        memcpy(&value, buffer, sizeof(value));
+        errors += value != offset;
+    }
+    Bench::report(label, "4KB随机读取", READ_COUNT, watch);
+    handle->close();
+
+    if (errors > 0) {
+        printf("[%s] 错误 %u\n", label, errors);
+    }
+    if (info.enabled) {
+        printf("[%s] 片段 %zu, 映射表 %zu 字节\n", label, info.fragments, info.table_bytes);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Bench::Fixture bench(argc > 1 ? argv[1] : "seek_bench.img");
+
+    printf("\n===== 随机定位基准 =====\n");
+    CacheConfig cache_config;
+    cache_config.ram_budget = 0;
+    (void)bench.sd().configure_cache(cache_config);
+    if (!bench.mount("SEEKBENCH")) {
+        return 1;
+    }
+
+    if (!bench.sd().file_exists("/seek_target.bin") && !build_fragmented_file(bench.sd())) {
+        printf("生成测试文件失败\n");
+        return 1;
+    }
+
+    run_pass(bench, false);
+    run_pass(bench, true);
+
+    bench.finish();
+    return 0;
+}
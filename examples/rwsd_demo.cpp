@@ -65,6 +65,17 @@ int main() {
         printf("追加内容失败: %s\n", StorageDevice::get_error_description(append_result.error_code()).c_str());
     }
 
+    // 固定缓冲区读写 (不分配堆内存)
+    static uint8_t sample_buffer[64];
+    for (size_t i = 0; i < sizeof(sample_buffer); ++i) {
+        sample_buffer[i] = static_cast<uint8_t>(i);
+    }
+    (void)sd.write_file("/data/samples.bin", sample_buffer, sizeof(sample_buffer));
+    auto into_result = sd.read_file_into("/data/samples.bin", sample_buffer, sizeof(sample_buffer));
+    if (into_result.is_ok()) {
+        printf("固定缓冲区读取 %zu 字节\n", *into_result);
+    }
+
     // === 流式文件操作示例 ===
     printf("\n===== 流式文件操作 =====\n");
     
@@ -74,9 +85,9 @@ int main() {
         printf("成功打开文件句柄进行写入\n");
         
         // 写入多行数据
-        file_handle->write_line("第一行数据");
-        file_handle->write_line("第二行数据");
-        file_handle->write_line("第三行数据");
+        (void)file_handle->write_line("第一行数据");
+        (void)file_handle->write_line("第二行数据");
+        (void)file_handle->write_line("第三行数据");
         
         file_handle->close();
         printf("文件句柄写入完成\n");
@@ -135,14 +146,14 @@ int main() {
     printf("\n===== 树形目录结构 =====\n");
     
     // 创建一些测试目录和文件来演示树形结构
-    sd.create_directory("/data/subdir1");
-    sd.create_directory("/data/subdir2");
-    sd.create_directory("/data/subdir1/nested");
-    sd.write_text_file("/data/subdir1/file1.txt", "测试文件1");
-    sd.write_text_file("/data/subdir1/file2.txt", "测试文件2");
-    sd.write_text_file("/data/subdir1/nested/deep.txt", "深层文件");
-    sd.write_text_file("/data/subdir2/config.ini", "配置文件");
-    sd.write_text_file("/data/subdir2/data.bin", "二进制数据文件");
+    (void)sd.create_directory("/data/subdir1");
+    (void)sd.create_directory("/data/subdir2");
+    (void)sd.create_directory("/data/subdir1/nested");
+    (void)sd.write_text_file("/data/subdir1/file1.txt", "测试文件1");
+    (void)sd.write_text_file("/data/subdir1/file2.txt", "测试文件2");
+    (void)sd.write_text_file("/data/subdir1/nested/deep.txt", "深层文件");
+    (void)sd.write_text_file("/data/subdir2/config.ini", "配置文件");
+    (void)sd.write_text_file("/data/subdir2/data.bin", "二进制数据文件");
     
     // 显示完整的树形结构
     auto tree_result = sd.list_directory_tree("/");
@@ -166,9 +177,11 @@ int main() {
     printf("\n===== 文件管理操作 =====\n");
     
     // 复制文件
-    auto copy_result = sd.copy_file("/data/example.txt", "/data/example_copy.txt");
+    CopyOptions copy_options;
+    copy_options.buffer_size = 2048;
+    auto copy_result = sd.copy_file("/data/example.txt", "/data/example_copy.txt", copy_options);
     if (copy_result.is_ok()) {
-        printf("成功复制文件\n");
+        printf("成功复制文件: %zu 字节, %.1f KB/s\n", copy_result->bytes_copied, copy_result->kb_per_second());
     } else {
         printf("复制文件失败: %s\n", StorageDevice::get_error_description(copy_result.error_code()).c_str());
     }
@@ -0,0 +1,266 @@
+/**
+ * @file throughput_bench.cpp
+ * @brief 顺序读写吞吐量基准 - 对比单块 (CMD17/CMD24) 与多块 (CMD18/CMD25) 传输，
+ *        以及预分配连续空间后的写入、连续区段写入器与直接写卡，
+ *        和CRC计算与DMA重叠的多块传输、双缓冲流水线传输
+ * @version 1.0.0
+ *
+ * 主机构建时使用SD卡模拟器 (用法: throughput_bench [镜像文件])，
+ * 吞吐量按模拟器的虚拟总线时间计算，结果可重复。流水线一节把主机CPU时间
+ * 按比例计入虚拟时间，分别以同步和异步数据阶段运行，结果随主机负载略有波动。
+ */
+
+#include "rw_sd.hpp"
+#include "sd_spi_block_device.hpp"
+#include "platform.hpp"
+#if MICRO_SD_HOST
+#include "image_block_device.hpp"
+#include "sd_card_emulator.hpp"
+#else
+#include "pico/stdlib.h"
+#endif
+#include <stdio.h>
+
+using namespace MicroSD;
+
+namespace {
+
+constexpr size_t FILE_SIZE = 512 * 1024;
+constexpr size_t CHUNK_SIZE = 8 * 1024;
+
+#if MICRO_SD_HOST
+constexpr uint32_t CPU_SCALE = 50;      // 主机与RP2040 (133MHz Cortex-M0+) 的大致速度比
+SdCardEmulator* g_emulator = nullptr;
+#endif
+
+uint64_t bench_now_us() {
+#if MICRO_SD_HOST
+    return g_emulator->elapsed_us();
+#else
+    return Platform::now_us();
+#endif
+}
+
+double kb_per_second(size_t bytes, uint64_t elapsed_us) {
+    return elapsed_us > 0 ? (double)bytes / 1024.0 / ((double)elapsed_us / 1e6) : 0.0;
+}
+
+void run_pass(RWSD& sd, SdSpiBlockDevice& card, bool multi_block, bool preallocate,
+              std::vector<uint8_t>& chunk) {
+    card.set_multi_block(multi_block);
+    const char* label = preallocate ? "多块+预分配" : multi_block ? "多块" : "单块";
+
+    // 流式写入 (预分配时打开文件即分配好全部连续簇，写入过程中不再修改FAT)
+    OpenOptions options;
+    if (preallocate) {
+        options.preallocate_bytes = FILE_SIZE;
+        options.contiguous = true;
+    }
+    uint64_t start = bench_now_us();
+    auto handle = sd.open_file("/bench.bin", "w", options);
+    if (!handle.is_ok()) {
+        printf("[%s] 打开文件失败\n", label);
+        return;
+    }
+    for (size_t written = 0; written < FILE_SIZE; written += chunk.size()) {
+        if (!handle->write(chunk).is_ok()) {
+            printf("[%s] 写入失败\n", label);
+            return;
+        }
+    }
+    handle->close();
+    uint64_t write_us = bench_now_us() - start;
+
+    // 流式读取
+    start = bench_now_us();
+    auto reader = sd.open_file("/bench.bin", "r");
+    if (!reader.is_ok()) {
+        printf("[%s] 打开文件失败\n", label);
+        return;
+    }
+    size_t total = 0;
+    while (true) {
+        auto data = reader->read(CHUNK_SIZE);
+        if (!data.is_ok() || data->empty()) {
+            break;
+        }
+        total += data->size();
+    }
+    reader->close();
+    uint64_t read_us = bench_now_us() - start;
+
+    printf("[%s] 写入 %.1f KB/s, 读取 %.1f KB/s (%zu 字节)\n", label,
+           kb_per_second(FILE_SIZE, write_us), kb_per_second(total, read_us), total);
+}
+
+uint32_t run_extent_pass(RWSD& sd, SdSpiBlockDevice& card, std::vector<uint8_t>& chunk) {
+    card.set_multi_block(true);
+
+    // 连续区段写入器: 整扇区直接送往块设备，目录项只在检查点更新
+    ExtentWriterOptions options;
+    options.checkpoint_bytes = FILE_SIZE / 4;
+    uint64_t start = bench_now_us();
+    auto writer = sd.open_extent_writer("/bench.bin", FILE_SIZE, options);
+    if (!writer.is_ok()) {
+        printf("[区段写入] 打开失败\n");
+        return 0;
+    }
+    for (size_t written = 0; written < FILE_SIZE; written += chunk.size()) {
+        if (writer->write(chunk.data(), chunk.size()).value_or(0) != chunk.size()) {
+            printf("[区段写入] 写入失败\n");
+            return 0;
+        }
+    }
+    uint32_t first_sector = writer->first_sector();
+    if (!writer->close().is_ok()) {
+        printf("[区段写入] 关闭失败\n");
+        return 0;
+    }
+    uint64_t extent_us = bench_now_us() - start;
+
+    // 直接写卡同一区域作为上限参考
+    start = bench_now_us();
+    uint32_t sectors_per_chunk = chunk.size() / BlockDevice::SECTOR_SIZE;
+    for (uint32_t sector = 0; sector < FILE_SIZE / BlockDevice::SECTOR_SIZE; sector += sectors_per_chunk) {
+        if (!card.write(first_sector + sector, chunk.data(), sectors_per_chunk).is_ok()) {
+            printf("[直接写卡] 写入失败\n");
+            return 0;
+        }
+    }
+    uint64_t raw_us = bench_now_us() - start;
+
+    printf("[区段写入] 写入 %.1f KB/s, 直接写卡 %.1f KB/s (%.0f%%)\n", kb_per_second(FILE_SIZE, extent_us),
+           kb_per_second(FILE_SIZE, raw_us), extent_us > 0 ? 100.0 * raw_us / extent_us : 0.0);
+    return first_sector;
+}
+
+void run_pipeline_pass(SdSpiBlockDevice& card, uint32_t first_sector, std::vector<uint8_t>& chunk,
+                       const char* label) {
+    card.set_multi_block(true);
+    const uint32_t sectors = FILE_SIZE / BlockDevice::SECTOR_SIZE;
+    const uint32_t sectors_per_chunk = chunk.size() / BlockDevice::SECTOR_SIZE;
+
+    // 多块读写: 每块的CRC计算/校验与相邻块的DMA重叠
+    uint64_t start = bench_now_us();
+    for (uint32_t sector = 0; sector < sectors; sector += sectors_per_chunk) {
+        if (!card.write(first_sector + sector, chunk.data(), sectors_per_chunk).is_ok()) {
+            printf("[%s] 写入失败\n", label);
+            return;
+        }
+    }
+    uint64_t write_us = bench_now_us() - start;
+
+    start = bench_now_us();
+    for (uint32_t sector = 0; sector < sectors; sector += sectors_per_chunk) {
+        if (!card.read(first_sector + sector, chunk.data(), sectors_per_chunk).is_ok()) {
+            printf("[%s] 读取失败\n", label);
+            return;
+        }
+    }
+    uint64_t read_us = bench_now_us() - start;
+
+    // 双缓冲流水线: 发送第N块时生成第N+1块，接收第N块时处理第N-1块
+    uint8_t* buffers = chunk.data();
+    start = bench_now_us();
+    auto written = card.write_pipelined(first_sector, sectors, buffers, [](uint32_t index, uint8_t* data) {
+        for (size_t i = 0; i < BlockDevice::SECTOR_SIZE; ++i) {
+            data[i] = static_cast<uint8_t>(index + i);
+        }
+        return true;
+    });
+    uint64_t pipelined_write_us = bench_now_us() - start;
+
+    uint32_t mismatches = 0;
+    start = bench_now_us();
+    auto read = card.read_pipelined(first_sector, sectors, buffers, [&](uint32_t index, const uint8_t* data) {
+        for (size_t i = 0; i < BlockDevice::SECTOR_SIZE; ++i) {
+            mismatches += data[i] != static_cast<uint8_t>(index + i);
+        }
+        return true;
+    });
+    uint64_t pipelined_read_us = bench_now_us() - start;
+    if (!written.is_ok() || !read.is_ok() || mismatches > 0) {
+        printf("[%s] 流水线传输失败 (%u 字节不一致)\n", label, mismatches);
+        return;
+    }
+
+    printf("[%s] 多块写 %.1f KB/s, 多块读 %.1f KB/s, 流水线写 %.1f KB/s, 流水线读 %.1f KB/s\n", label,
+           kb_per_second(FILE_SIZE, write_us), kb_per_second(FILE_SIZE, read_us),
+           kb_per_second(FILE_SIZE, pipelined_write_us), kb_per_second(FILE_SIZE, pipelined_read_us));
+}
+
+
+
+} // namespace
+
+int main(int argc, char** argv) {
+#if MICRO_SD_HOST
+    const char* image_path = argc > 1 ? argv[1] : "bench.img";
+    ImageBlockDevice image(image_path, 64 * 1024 * 1024 / BlockDevice::SECTOR_SIZE);
+    auto emulator = std::make_unique<SdCardEmulator>(image);
+    g_emulator = emulator.get();
+    auto device = std::make_unique<SdSpiBlockDevice>(std::move(emulator), Config::DEFAULT);
+#else
+    (void)argc;
+    (void)argv;
+    stdio_init_all();
+    sleep_ms(2000);
+    auto device = std::make_unique<SdSpiBlockDevice>(Config::DEFAULT);
+#endif
+    printf("\n===== 顺序吞吐量基准 =====\n");
+
+    SdSpiBlockDevice& card = *device;
+    RWSD sd(std::move(device));
+
+    auto init_result = sd.initialize();
+#if MICRO_SD_HOST
+    if (!init_result.is_ok()) {
+        init_result = sd.format("BENCH");
+    }
+#endif
+    if (!init_result.is_ok()) {
+        printf("SD卡初始化失败: %s\n", StorageDevice::get_error_description(init_result.error_code()).c_str());
+        return 1;
+    }
+    printf("%s", sd.get_config_info().c_str());
+
+    std::vector<uint8_t> chunk(CHUNK_SIZE);
+    for (size_t i = 0; i < chunk.size(); ++i) {
+        chunk[i] = static_cast<uint8_t>(i);
+    }
+
+    run_pass(sd, card, false, false, chunk);
+    run_pass(sd, card, true, false, chunk);
+    run_pass(sd, card, true, true, chunk);
+    uint32_t first_sector = run_extent_pass(sd, card, chunk);
+    if (first_sector != 0) {
+#if MICRO_SD_HOST
+        // CPU时间计入虚拟时间，对比同步与DMA风格的异步数据阶段
+        EmulatorTiming timing = g_emulator->get_timing();
+        timing.cpu_scale = CPU_SCALE;
+        g_emulator->set_timing(timing);
+        g_emulator->set_async(false);
+        run_pipeline_pass(card, first_sector, chunk, "流水线 同步");
+        g_emulator->set_async(true);
+        run_pipeline_pass(card, first_sector, chunk, "流水线 异步");
+        timing.cpu_scale = 0;
+        g_emulator->set_timing(timing);
+#else
+        run_pipeline_pass(card, first_sector, chunk, "流水线 DMA");
+#endif
+    }
+
+    (void)sd.delete_file("/bench.bin");
+    printf("===== 基准完成 =====\n");
+#if MICRO_SD_HOST
+    (void)sd.sync();
+    const EmulatorStats& stats = g_emulator->get_stats();
+    printf("模拟器: %u 条命令, 读 %u 块, 写 %u 块, 总线 %llu 字节\n", stats.commands,
+           stats.blocks_read, stats.blocks_written, (unsigned long long)stats.bytes);
+    return 0;
+#else
+    while (true) {
+        sleep_ms(1000);
+    }
+#endif
+}
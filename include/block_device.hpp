@@ -0,0 +1,121 @@
+/**
+ * @file block_device.hpp
+ * @brief 扇区级块设备抽象 - FatFs与物理存储之间的接口层
+ * @version 1.0.0
+ */
+
+#pragma once
+
+#include "storage_device.hpp"
+#include <cstdint>
+#include <string>
+
+namespace MicroSD {
+
+/**
+ * @brief 块设备几何信息
+ */
+struct BlockGeometry {
+    uint32_t sector_count = 0;          // 扇区总数
+    uint16_t sector_size = 512;         // 扇区大小 (字节)
+    uint32_t erase_block_sectors = 1;   // 擦除块大小 (扇区数)
+};
+
+/**
+ * @brief 块设备抽象基类
+ * RWSD通过该接口访问底层存储，SPI SD卡和磁盘镜像文件均为其实现
+ */
+class BlockDevice {
+public:
+    static constexpr uint16_t SECTOR_SIZE = 512;
+
+    virtual ~BlockDevice() = default;
+
+    /**
+     * @brief 初始化设备
+     */
+    virtual Result<void> initialize() = 0;
+
+    /**
+     * @brief 释放设备资源
+     */
+    virtual void deinitialize() {}
+
+    /**
+     * @brief 设备是否已就绪
+     */
+    virtual bool is_ready() const = 0;
+
+    /**
+     * @brief 获取设备几何信息
+     */
+    virtual BlockGeometry geometry() const = 0;
+
+    /**
+     * @brief 读取连续扇区
+     * @param sector 起始扇区号
+     * @param buffer 目标缓冲区 (至少 count * 512 字节)
+     * @param count 扇区数
+     */
+    virtual Result<void> read(uint32_t sector, uint8_t* buffer, uint32_t count) = 0;
+
+    /**
+     * @brief 写入连续扇区
+     */
+    virtual Result<void> write(uint32_t sector, const uint8_t* buffer, uint32_t count) = 0;
+
+    /**
+     * @brief 写入连续扇区，第i个扇区的数据取自blocks[i] (各缓冲区不必相邻)
+     * 默认逐扇区调用write()；支持多块命令的设备应重写为一次传输
+     */
+    virtual Result<void> write_gather(uint32_t sector, const uint8_t* const* blocks, uint32_t count) {
+        for (uint32_t i = 0; i < count; ++i) {
+            auto result = write(sector + i, blocks[i], 1);
+            if (!result.is_ok()) {
+                return result;
+            }
+        }
+        return Result<void>();
+    }
+
+    /**
+     * @brief 等待所有写入落盘
+     */
+    virtual Result<void> sync() = 0;
+
+    /**
+     * @brief 通知设备扇区范围不再使用 (默认忽略)
+     */
+    virtual Result<void> trim(uint32_t first_sector, uint32_t count) {
+        (void)first_sector;
+        (void)count;
+        return Result<void>();
+    }
+
+    /**
+     * @brief 空闲时的设备维护 (默认无操作)
+     * 由调用者在两次读写之间调用，不会在read()/write()内部执行
+     */
+    virtual Result<void> maintain() {
+        return Result<void>();
+    }
+
+    /**
+     * @brief 获取设备配置描述
+     */
+    virtual std::string get_config_info() const = 0;
+};
+
+/**
+ * @brief 将块设备挂接到FatFs物理驱动器号
+ * @param pdrv FatFs物理驱动器号
+ * @param device 块设备，传入nullptr表示解除挂接
+ */
+void attach_block_device(uint8_t pdrv, BlockDevice* device);
+
+/**
+ * @brief 获取挂接在指定驱动器号上的块设备
+ */
+BlockDevice* attached_block_device(uint8_t pdrv);
+
+} // namespace MicroSD
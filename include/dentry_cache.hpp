@@ -0,0 +1,118 @@
+/**
+ * @file dentry_cache.hpp
+ * @brief 目录项查找缓存 - 重复的file_exists/get_file_info跳过f_stat的逐级目录扫描
+ * @version 1.0.0
+ */
+
+#pragma once
+
+#include "ff.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef MICRO_SD_DENTRY_CACHE_ENTRIES
+#define MICRO_SD_DENTRY_CACHE_ENTRIES 8     // 缓存的路径查找结果数 (0禁用)
+#endif
+
+#ifndef MICRO_SD_DENTRY_CACHE_PATH
+#define MICRO_SD_DENTRY_CACHE_PATH 64       // 可缓存的规范化路径最大长度 (含结尾0)，更长的路径直接f_stat
+#endif
+
+namespace MicroSD {
+
+/**
+ * @brief 目录项缓存统计
+ */
+struct DentryCacheStats {
+    uint32_t hits = 0;              // 命中 (含不存在的结果)
+    uint32_t negative_hits = 0;     // 命中"不存在"的结果
+    uint32_t misses = 0;            // 需要f_stat
+    uint32_t invalidations = 0;     // 因创建/写入/重命名/删除失效的条目
+
+    float hit_rate() const {
+        uint32_t total = hits + misses;
+        return total > 0 ? (float)hits / total : 0.0f;
+    }
+};
+
+/**
+ * @brief 目录项元数据 (f_stat结果中file_exists/get_file_info用到的部分)
+ */
+struct DentryInfo {
+    FSIZE_t size;
+    WORD date;
+    WORD time;
+    BYTE attributes;
+};
+
+/**
+ * @brief 路径查找结果LRU缓存
+ * 按规范化路径 (去掉开头、重复和结尾的'/'，比较时不区分大小写) 保存f_stat的结果，
+ * 包括"不存在"的结果。路径上的任何创建、写入、重命名或删除都由RWSD使对应条目失效；
+ * 失效某个路径时其下的所有路径一并失效，因此重命名或删除目录也只需失效该目录。
+ * 正在被写入的文件由RWSD绕过缓存，其大小以句柄为准。
+ */
+class DentryCache {
+public:
+    static constexpr uint8_t CAPACITY = MICRO_SD_DENTRY_CACHE_ENTRIES > 0 ? MICRO_SD_DENTRY_CACHE_ENTRIES : 1;
+    static constexpr size_t MAX_PATH = MICRO_SD_DENTRY_CACHE_PATH;
+
+private:
+    struct Entry {
+        uint32_t hash;              // 规范化路径的哈希 (不区分大小写)
+        uint32_t last_use;
+        DentryInfo info;
+        bool valid;
+        bool exists;
+        uint16_t length;
+        char path[MAX_PATH];        // 规范化路径，存在时最后一级为卡上的名字
+    };
+
+    Entry entries_[CAPACITY];
+    uint32_t clock_;
+    DentryCacheStats stats_;
+
+    /**
+     * @brief 规范化路径并计算哈希
+     * @return 规范化后的长度；根目录返回0，放不下时返回MAX_PATH
+     */
+    static size_t normalize(const char* path, char* out, uint32_t& hash);
+    Entry* find(const char* normalized, size_t length, uint32_t hash);
+
+public:
+    DentryCache();
+
+    DentryCache(const DentryCache&) = delete;
+    DentryCache& operator=(const DentryCache&) = delete;
+
+    /**
+     * @brief 查找路径
+     * @param exists 输出: 路径是否存在
+     * @param info 输出: 存在时的元数据，可为nullptr
+     * @param name 输出: 存在时卡上的名字 (指向缓存内部，下次修改缓存前有效)，可为nullptr
+     * @return 是否命中
+     */
+    bool lookup(const char* path, bool& exists, DentryInfo* info, const char** name);
+
+    /**
+     * @brief 保存f_stat的结果
+     * @param fno f_stat成功时的结果；为nullptr表示路径不存在
+     * 名字与路径最后一级不一致 (如通过8.3短名访问) 时不缓存
+     */
+    void insert(const char* path, const FILINFO* fno);
+
+    /**
+     * @brief 使路径及其下所有路径的条目失效
+     */
+    void invalidate(const char* path);
+
+    /**
+     * @brief 使所有条目失效 (格式化、卸载时)
+     */
+    void invalidate_all();
+
+    const DentryCacheStats& get_stats() const { return stats_; }
+    void reset_stats() { stats_ = DentryCacheStats(); }
+};
+
+} // namespace MicroSD
@@ -0,0 +1,138 @@
+/**
+ * @file free_cluster_map.hpp
+ * @brief 内存中的空闲簇索引 - 常数时间容量查询和空闲区定位
+ * @version 1.0.0
+ */
+
+#pragma once
+
+#include "block_device.hpp"
+#include "memory_config.hpp"
+#include <vector>
+
+namespace MicroSD {
+
+/**
+ * @brief 空闲簇索引配置
+ */
+struct FreeSpaceConfig {
+    bool enabled = true;                // 是否维护空闲簇索引
+    bool background_scan = false;       // true时挂载不扫描FAT，由RWSD::scan_free_space()分步建立
+    size_t ram_budget = 4 * 1024;       // 索引RAM预算 (字节)，决定每组包含的FAT扇区数
+};
+
+/**
+ * @brief 空闲簇索引
+ * 包装另一个块设备，按FAT扇区分组记录空闲簇数量。索引建立后通过观察
+ * FatFs对FAT区的写入增量维护 (写入前读取旧内容，通常命中扇区缓存)，
+ * 因此容量查询为常数时间，分配器可以跳过没有空闲簇的区域。
+ * 仅支持FAT16/FAT32 (FAT12的表项跨扇区，且卷很小，直接扫描即可)。
+ */
+class FreeClusterMap : public BlockDevice {
+private:
+    BlockDevice* device_;
+    size_t ram_budget_;
+    std::pmr::vector<uint32_t> group_free_;  // 每组空闲簇数
+    std::pmr::vector<uint8_t> scan_buffer_;  // 扫描用的多扇区缓冲区 (跟踪期间保留)
+    uint32_t fat_first_;                // FAT区起始扇区
+    uint32_t fat_sectors_;              // 单个FAT的扇区数
+    uint32_t cluster_count_;            // FAT表项数 (有效簇号为2..cluster_count_-1)
+    uint32_t entries_per_sector_;
+    uint32_t sectors_per_group_;
+    uint32_t scanned_sectors_;          // 已建立索引的FAT扇区数 (按组推进)
+    uint32_t free_clusters_;
+    uint8_t entry_size_;
+    bool tracking_;
+
+    uint32_t count_free(uint32_t fat_index, const uint8_t* data) const;
+    uint32_t group_capacity(uint32_t group) const;
+    uint32_t group_first_cluster(uint32_t group) const;
+    Result<void> update_from_write(uint32_t sector, const uint8_t* buffer, uint32_t count);
+
+public:
+    /**
+     * @brief 构造函数
+     * @param device 被包装的块设备 (通常为扇区缓存，不转移所有权)
+     * @param ram_budget 索引RAM预算 (字节)
+     * @param memory 索引的内存来源
+     */
+    explicit FreeClusterMap(BlockDevice& device, size_t ram_budget = 4 * 1024,
+                            std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+
+    FreeClusterMap(const FreeClusterMap&) = delete;
+    FreeClusterMap& operator=(const FreeClusterMap&) = delete;
+
+    Result<void> initialize() override { return device_->initialize(); }
+    void deinitialize() override;
+    bool is_ready() const override { return device_->is_ready(); }
+    BlockGeometry geometry() const override { return device_->geometry(); }
+
+    Result<void> read(uint32_t sector, uint8_t* buffer, uint32_t count) override;
+    Result<void> write(uint32_t sector, const uint8_t* buffer, uint32_t count) override;
+    Result<void> sync() override { return device_->sync(); }
+    Result<void> trim(uint32_t first_sector, uint32_t count) override { return device_->trim(first_sector, count); }
+    Result<void> maintain() override { return device_->maintain(); }
+
+    std::string get_config_info() const override { return device_->get_config_info(); }
+
+    /**
+     * @brief 更换被包装的块设备 (如重建扇区缓存后)，索引内容保持不变
+     */
+    void set_device(BlockDevice& device) { device_ = &device; }
+
+    /**
+     * @brief 开始跟踪一个已挂载的卷，清空索引
+     * @param fs_type FatFs卷类型 (FS_FAT16/FS_FAT32)
+     * @param fat_first FAT区起始扇区
+     * @param fat_sectors 单个FAT的扇区数
+     * @param cluster_count FAT表项数 (FATFS::n_fatent)
+     * @return 不支持的卷类型返回false
+     */
+    bool attach(uint8_t fs_type, uint32_t fat_first, uint32_t fat_sectors, uint32_t cluster_count);
+
+    /**
+     * @brief 停止跟踪 (卸载或格式化前调用)
+     */
+    void detach();
+
+    /**
+     * @brief 扫描FAT建立索引
+     * @param max_sectors 本次最多读取的FAT扇区数 (至少处理一组)
+     * @return 索引是否已完整
+     */
+    Result<bool> scan(uint32_t max_sectors = UINT32_MAX);
+
+    bool is_tracking() const { return tracking_; }
+    bool is_complete() const { return tracking_ && scanned_sectors_ >= fat_sectors_; }
+
+    /**
+     * @brief 建立进度 (0-100)
+     */
+    uint8_t scan_progress() const {
+        return fat_sectors_ > 0 ? static_cast<uint8_t>((uint64_t)scanned_sectors_ * 100 / fat_sectors_) : 0;
+    }
+
+    /**
+     * @brief 空闲簇数 (仅在is_complete()时有效)
+     */
+    uint32_t free_clusters() const { return free_clusters_; }
+
+    /**
+     * @brief 查找不小于from的第一个可能空闲的簇所在位置
+     * @return 所在组的起始簇号 (不小于from)，没有空闲簇时返回0
+     */
+    uint32_t find_free(uint32_t from) const;
+
+    /**
+     * @brief 查找由完全空闲的组构成、至少包含clusters个簇的连续区域
+     * @return 起始簇号，未找到返回0
+     */
+    uint32_t find_free_run(uint32_t clusters) const;
+
+    /**
+     * @brief 索引占用的RAM (字节)
+     */
+    size_t memory_usage() const { return group_free_.capacity() * sizeof(uint32_t); }
+};
+
+} // namespace MicroSD
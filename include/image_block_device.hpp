@@ -0,0 +1,55 @@
+/**
+ * @file image_block_device.hpp
+ * @brief 磁盘镜像文件块设备 (Linux主机构建)
+ * @version 1.0.0
+ */
+
+#pragma once
+
+#include "block_device.hpp"
+#include <cstdio>
+#include <string>
+
+namespace MicroSD {
+
+/**
+ * @brief 以普通文件作为存储介质的块设备
+ * 用于在主机上运行RWSD，对吞吐量和延迟进行离线分析和回归测试
+ */
+class ImageBlockDevice : public BlockDevice {
+private:
+    std::string path_;
+    uint32_t create_sectors_;
+    FILE* file_;
+    BlockGeometry geometry_;
+
+public:
+    /**
+     * @brief 构造函数
+     * @param path 镜像文件路径
+     * @param create_sectors 镜像不存在时按该扇区数创建，0表示必须已存在
+     */
+    explicit ImageBlockDevice(std::string path, uint32_t create_sectors = 0);
+    ~ImageBlockDevice() override;
+
+    ImageBlockDevice(const ImageBlockDevice&) = delete;
+    ImageBlockDevice& operator=(const ImageBlockDevice&) = delete;
+
+    Result<void> initialize() override;
+    void deinitialize() override;
+    bool is_ready() const override { return file_ != nullptr; }
+    BlockGeometry geometry() const override { return geometry_; }
+
+    Result<void> read(uint32_t sector, uint8_t* buffer, uint32_t count) override;
+    Result<void> write(uint32_t sector, const uint8_t* buffer, uint32_t count) override;
+    Result<void> sync() override;
+
+    std::string get_config_info() const override;
+
+    /**
+     * @brief 获取镜像文件路径
+     */
+    const std::string& get_path() const { return path_; }
+};
+
+} // namespace MicroSD
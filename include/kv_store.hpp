@@ -0,0 +1,178 @@
+/**
+ * @file kv_store.hpp
+ * @brief 日志结构键值存储 - 记录追加到段文件，内存中只保存键哈希到位置的索引
+ * @version 1.0.0
+ */
+
+#pragma once
+
+#include "rw_sd.hpp"
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+#ifndef MICRO_SD_KV_MAX_SEGMENTS
+#define MICRO_SD_KV_MAX_SEGMENTS 16     // 段文件数上限 (达到上限时写入前先压缩)
+#endif
+
+namespace MicroSD {
+
+/**
+ * @brief 键值存储配置
+ */
+struct KvConfig {
+    const char* directory = "/kv";      // 段文件所在目录 (构造时复制)
+    size_t max_keys = 512;              // 键数上限，决定索引大小 (每个键约24字节)
+    size_t segment_bytes = 32 * 1024;   // 活动段超过该大小后封存并开始新段
+    size_t max_value_size = 512;        // 值的最大长度，决定记录缓冲区大小
+    bool sync_on_write = false;         // 每次put/remove后同步 (否则由sync()或close()同步)
+};
+
+/**
+ * @brief 键值存储统计
+ */
+struct KvStats {
+    uint32_t keys = 0;                  // 当前键数
+    uint32_t segments = 0;              // 段文件数
+    uint64_t live_bytes = 0;            // 仍被索引引用的记录字节数
+    uint64_t total_bytes = 0;           // 段文件总字节数
+    uint32_t compactions = 0;           // 完成的压缩次数
+    uint32_t recovered_records = 0;     // 打开时扫描到的有效记录数
+    uint32_t truncated_bytes = 0;       // 打开时截掉的不完整尾部字节数
+};
+
+/**
+ * @brief 日志结构键值存储
+ * put/remove把记录追加到活动段文件，索引 (开放寻址哈希表) 只保存键的32位哈希和
+ * (段, 偏移, 长度)；哈希相同时读取卡上的键比较。被覆盖或删除的记录由压缩回收:
+ * 压缩把所有封存段中仍有效的记录复制到一个新段，然后按编号从小到大删除旧段，
+ * 可以通过compact_step()在主循环中分步进行。
+ * 打开时按段编号顺序扫描所有记录重建索引，校验失败处为掉电时未写完的尾部，
+ * 活动段从该处截断。RAM占用: 索引、段表和一个记录缓冲区，均在open()时分配
+ *
+ * 记录格式: 'K' 'V' 标志(1) 键长(1) 值长(4) 校验(4) 键 值
+ */
+class KvStore {
+public:
+    static constexpr uint8_t MAX_SEGMENTS = MICRO_SD_KV_MAX_SEGMENTS;
+    static constexpr size_t MAX_KEY_SIZE = 255;
+
+private:
+    struct Entry {
+        uint32_t hash;
+        uint32_t offset;                // 记录在段文件中的偏移
+        uint16_t size;                  // 记录长度 (含头部)
+        uint8_t segment;                // segments_中的槽位
+        uint8_t state;                  // EMPTY/USED/DELETED
+    };
+
+    struct Segment {
+        uint32_t id;                    // 文件编号，0表示槽位空闲；编号越大记录越新
+        uint32_t size;
+        uint32_t live;
+    };
+
+    RWSD& sd_;
+    KvConfig config_;
+    char directory_[MICRO_SD_MAX_PATH];
+    std::pmr::vector<Entry> index_;
+    std::pmr::vector<uint8_t> record_;  // 记录缓冲区 (压缩复制和恢复扫描)
+    Segment segments_[MAX_SEGMENTS];
+    RWSD::FileHandle active_;           // 活动段 (读写模式打开，对它的读取也经过该句柄)
+    uint8_t active_slot_;
+    uint32_t next_id_;
+    size_t used_;                       // 索引中的有效条目
+    size_t deleted_;                    // 索引中的删除标记
+    bool open_;
+
+    // 分步压缩状态
+    bool compacting_;
+    uint8_t compact_slot_;              // 输出段
+    uint32_t compact_id_;               // 编号小于该值的段在压缩完成后删除
+    size_t compact_cursor_;             // 下一个要检查的索引位置
+    RWSD::FileHandle compact_file_;
+    KvStats stats_;
+
+    void segment_path(uint8_t slot, char* path, size_t size) const;
+    uint8_t free_slots() const;
+    Result<uint8_t> create_segment(RWSD::FileHandle& handle);
+    RWSD::FileHandle* handle_for(uint8_t slot);
+    Result<void> read_at(uint8_t slot, uint32_t offset, void* buffer, size_t size);
+    Result<void> scan_segment(uint8_t slot, uint32_t size, bool active);
+    Result<void> write_record(uint8_t flags, std::string_view key, const void* value, size_t size);
+    Result<size_t> find(std::string_view key, uint32_t hash);
+    Result<void> update(size_t position, uint32_t hash, uint8_t flags, uint8_t slot, uint32_t offset, uint16_t size);
+    Result<void> roll_segment();
+    Result<void> finish_compaction();
+    void rebuild_index();
+
+public:
+    /**
+     * @brief 构造函数
+     * @param sd 已初始化的RWSD，索引和缓冲区从其内存资源分配
+     */
+    KvStore(RWSD& sd, const KvConfig& config = KvConfig());
+    ~KvStore() { (void)close(); }
+
+    KvStore(const KvStore&) = delete;
+    KvStore& operator=(const KvStore&) = delete;
+
+    /**
+     * @brief 打开存储: 创建目录、扫描段文件重建索引并截断不完整的尾部
+     * @return 段中有完整但超过max_value_size的记录时返回INVALID_PARAMETER，不修改段文件
+     */
+    Result<void> open();
+
+    /**
+     * @brief 完成进行中的压缩，同步并关闭段文件
+     */
+    Result<void> close();
+
+    /**
+     * @brief 读取键对应的值
+     * @return 值的长度；键不存在时返回FILE_NOT_FOUND，缓冲区不足时返回INVALID_PARAMETER
+     */
+    Result<size_t> get(std::string_view key, void* buffer, size_t capacity);
+
+    /**
+     * @brief 写入键值 (追加新记录，旧记录在压缩时回收)
+     */
+    Result<void> put(std::string_view key, const void* value, size_t size);
+    Result<void> put(std::string_view key, std::string_view value);
+
+    /**
+     * @brief 删除键 (追加删除记录)；键不存在时返回FILE_NOT_FOUND
+     */
+    Result<void> remove(std::string_view key);
+
+    /**
+     * @brief 键是否存在
+     */
+    bool contains(std::string_view key);
+
+    /**
+     * @brief 同步活动段
+     */
+    Result<void> sync();
+
+    /**
+     * @brief 是否值得压缩 (无效记录多于有效记录，或段数接近上限)
+     */
+    bool needs_compaction() const;
+
+    /**
+     * @brief 分步压缩，每次最多复制max_records条记录
+     * @return 压缩是否已完成；当前没有进行中的压缩时先开始一次新的压缩
+     */
+    Result<bool> compact_step(size_t max_records);
+
+    /**
+     * @brief 完整压缩
+     */
+    Result<void> compact();
+
+    bool is_open() const { return open_; }
+    KvStats get_stats() const;
+};
+
+} // namespace MicroSD
@@ -0,0 +1,114 @@
+/**
+ * @file logger.hpp
+ * @brief 追加日志 - 保持文件打开，环形缓冲区按扇区对齐写出，按大小轮转
+ * @version 1.0.0
+ */
+
+#pragma once
+
+#include "rw_sd.hpp"
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+namespace MicroSD {
+
+/**
+ * @brief 日志配置
+ */
+struct LoggerConfig {
+    const char* path = "/log.txt";      // 日志文件路径 (构造时复制)
+    size_t buffer_size = 2048;          // 环形缓冲区大小，向下取整到扇区大小 (至少一个扇区)
+    size_t sync_bytes = 16 * 1024;      // 写出这么多字节后同步目录项，0表示不按大小同步
+    uint32_t sync_interval_ms = 1000;   // 距上次同步超过该时间后同步，0表示不按时间同步
+    size_t rotate_bytes = 0;            // 文件达到该大小后轮转，0表示不轮转
+    uint8_t max_files = 4;              // 轮转时保留的文件数 (含当前文件)，旧文件命名为path.1、path.2...
+};
+
+/**
+ * @brief 日志统计
+ */
+struct LoggerStats {
+    uint32_t records = 0;               // 写入的记录数
+    uint64_t bytes = 0;                 // 写入的字节数
+    uint32_t writes = 0;                // 对文件的写入次数
+    uint32_t syncs = 0;                 // 目录项同步次数
+    uint32_t rotations = 0;             // 轮转次数
+};
+
+/**
+ * @brief 追加日志
+ * 代替逐条调用append_text_file (每次打开、定位到文件末尾、写入并关闭)。文件在open()
+ * 后保持打开，记录先进入环形缓冲区；缓冲区满时只写出完整的扇区，且缓冲区偏移与文件
+ * 偏移按扇区对齐，使FatFs直接以整扇区写卡而不经过FIL缓冲区。
+ * 同步 (写出尾部并更新目录项) 按写入量和时间间隔触发，也可以调用flush()。
+ * 占用RWSD打开文件表的一个槽位，不得比RWSD存活更久
+ */
+class Logger {
+private:
+    RWSD& sd_;
+    LoggerConfig config_;
+    char path_[MICRO_SD_MAX_PATH];
+    RWSD::FileHandle file_;
+    std::pmr::vector<uint8_t> buffer_;
+    size_t head_;                       // 下一个待写出字节的缓冲区偏移
+    size_t count_;                      // 缓冲区中的字节数
+    size_t file_size_;                  // 文件大小 (含缓冲区中的数据)
+    size_t unsynced_bytes_;
+    uint64_t last_sync_us_;
+    LoggerStats stats_;
+
+    Result<void> open_file();
+    Result<void> begin_record(size_t size);
+    Result<void> append(const void* data, size_t size);
+    Result<void> end_record(size_t size);
+    Result<void> write_out(bool partial);
+    Result<void> rotate();
+
+public:
+    /**
+     * @brief 构造函数
+     * @param sd 已初始化的RWSD，缓冲区从其内存资源分配
+     */
+    Logger(RWSD& sd, const LoggerConfig& config = LoggerConfig());
+    ~Logger() { (void)close(); }
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    /**
+     * @brief 打开 (或创建) 日志文件，之后的记录追加到文件末尾
+     */
+    Result<void> open();
+
+    /**
+     * @brief 追加原始数据
+     */
+    Result<void> write(const void* data, size_t size);
+
+    /**
+     * @brief 追加一行 (自动添加换行符)
+     */
+    Result<void> log(std::string_view line);
+
+    /**
+     * @brief 按时间策略检查是否需要同步 (没有新记录时在主循环中调用)
+     */
+    Result<void> poll();
+
+    /**
+     * @brief 写出缓冲区中的全部数据并同步目录项
+     */
+    Result<void> flush();
+
+    /**
+     * @brief 刷新并关闭日志文件
+     */
+    Result<void> close();
+
+    bool is_open() const { return file_.is_open(); }
+    size_t file_size() const { return file_size_; }
+    const LoggerStats& get_stats() const { return stats_; }
+};
+
+} // namespace MicroSD
@@ -0,0 +1,66 @@
+/**
+ * @file memory_config.hpp
+ * @brief 内部缓冲区的内存来源 (std::pmr) 与无堆构建模式
+ * @version 1.0.0
+ *
+ * 扇区缓存、空闲簇索引和复制缓冲区等内部缓冲区都从std::pmr::memory_resource
+ * 分配。定义MICRO_SD_HEAP_FREE=1 (CMake选项MICRO_SD_HEAP_FREE) 时没有默认
+ * 资源，必须在初始化前通过RWSD::set_memory_resource()提供调用者的内存池，
+ * 例如建立在静态数组上的std::pmr::monotonic_buffer_resource。
+ */
+
+#pragma once
+
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+#ifndef MICRO_SD_HEAP_FREE
+#define MICRO_SD_HEAP_FREE 0
+#endif
+
+#ifndef MICRO_SD_MAX_PATH
+#define MICRO_SD_MAX_PATH 256           // FileHandle保存的路径最大长度 (含结尾0)
+#endif
+
+namespace MicroSD {
+
+/**
+ * @brief 库内部缓冲区的默认内存资源
+ * @return 无堆模式下为nullptr (必须由调用者提供)，否则为全局new/delete
+ */
+inline std::pmr::memory_resource* default_memory_resource() {
+#if MICRO_SD_HEAP_FREE
+    return nullptr;
+#else
+    return std::pmr::new_delete_resource();
+#endif
+}
+
+/**
+ * @brief 释放在内存资源中构造的对象
+ */
+template<typename T>
+struct PmrDelete {
+    std::pmr::memory_resource* resource = nullptr;
+
+    void operator()(T* object) const {
+        object->~T();
+        resource->deallocate(object, sizeof(T), alignof(T));
+    }
+};
+
+template<typename T>
+using PmrPtr = std::unique_ptr<T, PmrDelete<T>>;
+
+/**
+ * @brief 在内存资源中构造对象 (C++17没有polymorphic_allocator::new_object)
+ */
+template<typename T, typename... Args>
+PmrPtr<T> make_pmr(std::pmr::memory_resource* resource, Args&&... args) {
+    void* memory = resource->allocate(sizeof(T), alignof(T));
+    return PmrPtr<T>(new (memory) T(std::forward<Args>(args)...), PmrDelete<T>{resource});
+}
+
+} // namespace MicroSD
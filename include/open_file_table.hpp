@@ -0,0 +1,120 @@
+/**
+ * @file open_file_table.hpp
+ * @brief 打开文件表 - 固定数量的FIL槽位，供轻量文件句柄引用
+ * @version 1.0.0
+ */
+
+#pragma once
+
+#include "memory_config.hpp"
+#include "ff.h"
+#include <cstddef>
+#include <cstdint>
+
+#ifndef MICRO_SD_MAX_OPEN_FILES
+#define MICRO_SD_MAX_OPEN_FILES 4       // 同时打开的文件数上限 (每个槽位约FIL + MICRO_SD_MAX_PATH字节)
+#endif
+
+namespace MicroSD {
+
+/**
+ * @brief 打开文件表
+ * 由RWSD持有，所有FIL对象存放在编译期确定大小的槽位数组中，句柄只保存
+ * (槽位, 代数)。槽位关闭后代数递增，已关闭或卸载后残留的句柄因代数不匹配而失效。
+ */
+class OpenFileTable {
+public:
+    static constexpr uint8_t CAPACITY = MICRO_SD_MAX_OPEN_FILES;
+    static constexpr uint8_t INVALID_SLOT = 0xFF;
+
+    /**
+     * @brief 槽位
+     */
+    struct Slot {
+        FIL file;
+        DWORD* link_map;            // 快速定位的簇链映射表 (FIL::cltbl)，未启用时为nullptr
+        size_t link_map_words;
+        FSIZE_t reserved_end;       // 预分配后的文件大小，0表示未预分配
+        FSIZE_t data_end;           // 预分配时实际写入的末尾，关闭时截断到此处
+        uint16_t generation;
+        bool in_use;
+        char path[MICRO_SD_MAX_PATH];
+        char mode[8];
+    };
+
+private:
+    std::pmr::memory_resource* memory_;     // 簇链映射表的内存来源
+    Slot slots_[CAPACITY];
+    uint8_t open_count_;
+    uint8_t peak_count_;
+
+    void release_link_map(Slot& slot);
+
+public:
+    explicit OpenFileTable(std::pmr::memory_resource* memory);
+    ~OpenFileTable() { close_all(); }
+
+    OpenFileTable(const OpenFileTable&) = delete;
+    OpenFileTable& operator=(const OpenFileTable&) = delete;
+
+    /**
+     * @brief 在空闲槽位中打开文件
+     * @param slot 输出: 槽位号
+     * @param generation 输出: 槽位当前代数
+     * @return FatFs结果；没有空闲槽位时返回FR_TOO_MANY_OPEN_FILES
+     */
+    FRESULT open(const char* path, const char* mode, BYTE flags, uint8_t& slot, uint16_t& generation);
+
+    /**
+     * @brief 查找仍然有效的槽位
+     * @return 槽位已关闭或代数不匹配时返回nullptr
+     */
+    Slot* get(uint8_t slot, uint16_t generation);
+    const Slot* get(uint8_t slot, uint16_t generation) const;
+
+    /**
+     * @brief 关闭槽位中的文件并释放槽位
+     * 有预分配时先截断到实际写入的末尾，归还未用的簇
+     */
+    FRESULT close(uint8_t slot, uint16_t generation);
+
+    /**
+     * @brief 为打开的文件建立簇链映射表 (FatFs快速定位模式)
+     * 先分配一个小表尝试，不足时按FatFs报告的所需大小重新分配。
+     * 启用后f_lseek/f_read不再访问FAT，但文件不能再通过写入扩展
+     * @param max_bytes 映射表大小上限，超出时不启用并返回FR_NOT_ENOUGH_CORE
+     */
+    FRESULT enable_fast_seek(uint8_t slot, uint16_t generation, size_t max_bytes);
+
+    /**
+     * @brief 是否有以写入方式打开的同一路径
+     */
+    bool is_open_for_write(const char* path) const;
+
+    /**
+     * @brief 目录directory之下 (任意层) 是否有以写入方式打开的文件
+     */
+    bool is_writing_under(const char* directory) const;
+
+    /**
+     * @brief 比较两个路径是否指向同一文件 (FAT对ASCII字母不区分大小写，忽略开头的'/')
+     */
+    static bool same_path(const char* a, const char* b);
+
+    /**
+     * @brief 同步所有打开的文件 (回写FIL缓冲区和目录项)
+     * @return 第一个失败的结果，全部成功返回FR_OK
+     */
+    FRESULT sync_all();
+
+    /**
+     * @brief 关闭所有打开的文件 (卸载前调用)
+     */
+    void close_all();
+
+    size_t open_count() const { return open_count_; }
+    size_t peak_count() const { return peak_count_; }
+    static constexpr size_t capacity() { return CAPACITY; }
+};
+
+} // namespace MicroSD
@@ -0,0 +1,74 @@
+/**
+ * @file pico_spi_transport.hpp
+ * @brief RP2040硬件SPI传输，数据阶段使用DMA
+ * @version 1.0.0
+ */
+
+#pragma once
+
+#include "spi_transport.hpp"
+#include "pin_config.hpp"
+
+namespace MicroSD {
+
+/**
+ * @brief RP2040硬件SPI + DMA传输
+ * 数据块使用一对DMA通道 (TX发送哑元/数据，RX接收数据/丢弃)，
+ * 无可用DMA通道时退化为阻塞式传输。
+ */
+class PicoSpiTransport : public SpiTransport {
+private:
+    SPIConfig config_;
+    uint32_t clock_;
+    int tx_channel_;
+    int rx_channel_;
+    bool use_dma_;
+    bool busy_;
+    uint8_t dummy_tx_;
+    uint8_t dummy_rx_;
+
+    bool has_dma() const { return tx_channel_ >= 0 && rx_channel_ >= 0; }
+    void start_dma(const uint8_t* tx, uint8_t* rx, size_t length);
+
+public:
+    /**
+     * @brief DMA启用阈值 (字节)，更短的传输直接使用CPU
+     */
+    static constexpr size_t DMA_MIN_LENGTH = 32;
+
+    /**
+     * @brief 构造函数
+     * @param config SPI配置
+     * @param use_dma 是否使用DMA
+     */
+    explicit PicoSpiTransport(const SPIConfig& config, bool use_dma = true);
+    ~PicoSpiTransport() override;
+
+    PicoSpiTransport(const PicoSpiTransport&) = delete;
+    PicoSpiTransport& operator=(const PicoSpiTransport&) = delete;
+
+    Result<void> begin(uint32_t baudrate) override;
+    void end() override;
+    uint32_t set_clock(uint32_t baudrate) override;
+    uint32_t get_clock() const override { return clock_; }
+
+    void select() override;
+    void deselect() override;
+    uint8_t transfer(uint8_t data) override;
+    void write_bytes(const uint8_t* data, size_t length) override;
+    void read_bytes(uint8_t* data, size_t length) override;
+
+    void start_read(uint8_t* data, size_t length) override;
+    void start_write(const uint8_t* data, size_t length) override;
+    void wait_transfer() override;
+    bool is_async() const override { return has_dma(); }
+
+    std::string get_config_info() const override;
+
+    /**
+     * @brief 获取SPI配置
+     */
+    const SPIConfig& get_config() const { return config_; }
+};
+
+} // namespace MicroSD
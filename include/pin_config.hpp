@@ -14,8 +14,17 @@
 
 #pragma once
 
+#if MICRO_SD_HOST
+#include <cstdint>
+// 主机构建: 提供与Pico SDK兼容的最小类型定义
+typedef unsigned int uint;
+typedef struct spi_inst spi_inst_t;
+#define spi0 ((spi_inst_t*)0x4003c000u)
+#define spi1 ((spi_inst_t*)0x40040000u)
+#else
 #include "pico/stdlib.h"
 #include "hardware/spi.h"
+#endif
 #include <string>
 
 namespace MicroSD {
@@ -32,6 +41,7 @@ namespace MicroSD {
 #define SPI_CLK_SLOW_COMPAT     (200 * 1000)      // 兼容性慢速频率
 #define SPI_CLK_FAST_COMPAT     (20 * 1000 * 1000) // 兼容性快速频率
 #define SPI_CLK_FAST_HIGH       (50 * 1000 * 1000) // 高速频率
+#define SPI_CLK_MAX_DEFAULT     (62500 * 1000)     // 自适应时钟上限 (RP2040 clk_peri/2)
 
 // === 配置标志 ===
 #define USE_INTERNAL_PULLUP_DEFAULT  true    // 默认使用内部上拉电阻
@@ -69,6 +79,8 @@ struct SPIConfig {
     uint32_t clk_slow = SPI_CLK_SLOW_DEFAULT;       // 慢速时钟频率
     uint32_t clk_fast = SPI_CLK_FAST_DEFAULT;       // 快速时钟频率
     PinConfig pins;                       // 引脚配置
+    uint32_t clk_max = SPI_CLK_MAX_DEFAULT;         // 自适应时钟探测上限
+    bool adaptive_clock = true;           // 从clk_fast起探测最高稳定频率，链路出错时自动降频，由maintain()恢复
     
     // 验证配置
     bool is_valid() const {
@@ -80,6 +92,7 @@ struct SPIConfig {
         return "SPI" + std::to_string(spi_port == spi0 ? 0 : 1) + 
                " Slow:" + std::to_string(clk_slow/1000) + "KHz" +
                " Fast:" + std::to_string(clk_fast/1000000) + "MHz" +
+               (adaptive_clock ? " Max:" + std::to_string(clk_max/1000000) + "MHz" : std::string(" Fixed")) +
                " Pins:" + pins.get_description();
     }
 };
@@ -109,7 +122,8 @@ namespace Config {
         .spi_port = spi0,
         .clk_slow = SPI_CLK_SLOW_COMPAT,
         .clk_fast = SPI_CLK_FAST_COMPAT,
-        .pins = {PIN_MISO_DEFAULT, PIN_CS_DEFAULT, PIN_SCK_DEFAULT, PIN_MOSI_DEFAULT, USE_INTERNAL_PULLUP_DEFAULT}
+        .pins = {PIN_MISO_DEFAULT, PIN_CS_DEFAULT, PIN_SCK_DEFAULT, PIN_MOSI_DEFAULT, USE_INTERNAL_PULLUP_DEFAULT},
+        .clk_max = SPI_CLK_FAST_COMPAT    // 不向上探测，仅在出错时降频
     };
 }
 
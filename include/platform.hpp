@@ -0,0 +1,25 @@
+/**
+ * @file platform.hpp
+ * @brief 平台相关的时间函数 (Pico SDK / Linux主机)
+ * @version 1.0.0
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace MicroSD {
+namespace Platform {
+
+/**
+ * @brief 获取单调递增的微秒时间戳
+ */
+uint64_t now_us();
+
+/**
+ * @brief 毫秒级延时
+ */
+void delay_ms(uint32_t ms);
+
+} // namespace Platform
+} // namespace MicroSD
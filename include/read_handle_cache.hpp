@@ -0,0 +1,82 @@
+/**
+ * @file read_handle_cache.hpp
+ * @brief 只读文件句柄缓存 - 重复的分块读取跳过路径解析和簇链遍历
+ * @version 1.0.0
+ */
+
+#pragma once
+
+#include "open_file_table.hpp"
+
+#ifndef MICRO_SD_READ_CACHE_FILES
+#define MICRO_SD_READ_CACHE_FILES 2     // 缓存的只读FIL数量 (0禁用)
+#endif
+
+namespace MicroSD {
+
+/**
+ * @brief 只读句柄缓存统计
+ */
+struct ReadCacheStats {
+    uint32_t hits = 0;              // 复用已打开的FIL
+    uint32_t misses = 0;            // 需要重新打开
+    uint32_t invalidations = 0;     // 因写入/重命名/删除失效的条目
+};
+
+/**
+ * @brief 只读文件句柄LRU缓存
+ * 按路径保存最近读取的文件的FIL。命中时只需f_lseek，且向后定位从当前簇继续，
+ * 不必从头遍历簇链。文件被写入、重命名或删除时由RWSD使对应条目失效。
+ */
+class ReadHandleCache {
+public:
+    static constexpr uint8_t CAPACITY = MICRO_SD_READ_CACHE_FILES > 0 ? MICRO_SD_READ_CACHE_FILES : 1;
+
+private:
+    struct Entry {
+        FIL file;
+        uint32_t last_use;
+        bool valid;
+        char path[MICRO_SD_MAX_PATH];
+    };
+
+    Entry entries_[CAPACITY];
+    uint32_t clock_;
+    ReadCacheStats stats_;
+
+    void drop(Entry& entry);
+
+public:
+    ReadHandleCache();
+    ~ReadHandleCache() { invalidate_all(); }
+
+    ReadHandleCache(const ReadHandleCache&) = delete;
+    ReadHandleCache& operator=(const ReadHandleCache&) = delete;
+
+    /**
+     * @brief 获取路径对应的只读FIL，未缓存时打开并替换最久未用的条目
+     * @param fr 输出: 打开失败时的FatFs结果
+     * @return 路径过长无法缓存时返回nullptr且fr为FR_OK
+     */
+    FIL* acquire(const char* path, FRESULT& fr);
+
+    /**
+     * @brief 读取出错后丢弃该FIL
+     */
+    void release_on_error(FIL* file);
+
+    /**
+     * @brief 使某个路径的条目失效
+     */
+    void invalidate(const char* path);
+
+    /**
+     * @brief 使所有条目失效 (重命名目录、格式化、卸载时)
+     */
+    void invalidate_all();
+
+    const ReadCacheStats& get_stats() const { return stats_; }
+    void reset_stats() { stats_ = ReadCacheStats(); }
+};
+
+} // namespace MicroSD
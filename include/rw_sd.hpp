@@ -7,41 +7,219 @@
 #pragma once
 
 #include "storage_device.hpp"
+#include "block_device.hpp"
+#include "sector_cache.hpp"
+#include "free_cluster_map.hpp"
+#include "memory_config.hpp"
+#include "open_file_table.hpp"
+#include "read_handle_cache.hpp"
+#include "dentry_cache.hpp"
+#include "usage_cache.hpp"
 #include "pin_config.hpp"
 #include "ff.h"
+#include <stdio.h>
+#include <functional>
 #include <memory>
+#include <string_view>
 #include <vector>
 
 namespace MicroSD {
 
+/**
+ * @brief 文件复制进度
+ */
+struct CopyProgress {
+    size_t bytes_copied = 0;            // 已复制字节数
+    size_t total_bytes = 0;             // 源文件大小
+    uint64_t elapsed_us = 0;            // 已用时间 (微秒)
+    bool attributes_preserved = false;  // 属性和修改时间已复制到目标文件
+    
+    uint8_t percent() const {
+        return total_bytes > 0 ? static_cast<uint8_t>((uint64_t)bytes_copied * 100 / total_bytes) : 100;
+    }
+    
+    float kb_per_second() const {
+        return elapsed_us > 0 ? (float)bytes_copied / 1024.0f / ((float)elapsed_us / 1e6f) : 0.0f;
+    }
+};
+
+/**
+ * @brief 文件复制选项
+ */
+struct CopyOptions {
+    size_t buffer_size = 4096;          // 缓冲区大小，向下取整到扇区大小
+    uint8_t* buffer = nullptr;          // 调用者提供的缓冲区 (至少buffer_size字节)，为空时临时分配
+    bool preallocate = true;            // 预先为目标文件分配空间 (优先连续分配)
+    bool preserve_attributes = true;    // 保留属性和修改时间 (结果见CopyProgress)
+    std::function<bool(const CopyProgress&)> on_progress;  // 每个缓冲区后回调，返回false取消
+};
+
+/**
+ * @brief 文件打开选项
+ */
+struct OpenOptions {
+    bool fast_seek = false;             // 建立簇链映射表，随机定位不再遍历FAT (文件不能再被写入扩展)
+    size_t max_link_map_bytes = 4096;   // 映射表大小上限，超出时打开成功但不启用快速定位
+    size_t preallocate_bytes = 0;       // 在文件末尾之后预留的字节数 (仅写入模式)，关闭时截断未写入的部分
+    bool contiguous = false;            // 预留空间必须连续 (仅适用于空文件)，找不到连续空间时打开失败
+};
+
+/**
+ * @brief 连续区段写入器选项
+ */
+struct ExtentWriterOptions {
+    size_t checkpoint_bytes = 0;        // 每写入这么多字节更新一次目录项中的文件大小，0表示只在关闭时更新
+};
+
+/**
+ * @brief 目录迭代过滤条件 (字符串在迭代期间必须有效)
+ */
+struct DirectoryFilter {
+    const char* pattern = nullptr;      // 名字通配符 ('*'和'?')，不区分大小写，nullptr匹配全部
+    const char* extension = nullptr;    // 扩展名 (不含'.')，不区分大小写，nullptr匹配全部
+    uint8_t attributes = 0;             // 必须具有的属性 (如AM_DIR只列出子目录)
+    uint8_t exclude_attributes = 0;     // 不能具有的属性 (如AM_DIR只列出文件，AM_HID | AM_SYS跳过隐藏和系统文件)
+    
+    /**
+     * @brief 目录项是否符合条件
+     */
+    bool matches(const char* name, uint8_t attributes) const;
+};
+
+/**
+ * @brief 目录迭代位置，用于分页时从上次停下的目录项继续
+ */
+struct DirectoryCursor {
+    uint32_t index = 0;                 // 已读取的目录项数 (含被过滤的)
+    uint32_t offset = 0;                // 目录内字节偏移 (FatFs DIR::dptr)
+    uint32_t cluster = 0;               // 当前簇
+    LBA_t sector = 0;                   // 当前扇区，0表示已到末尾
+    uint32_t start_cluster = 0;         // 目录起始簇 (校验用)
+    uint16_t volume_id = 0;             // 挂载编号，重新挂载后按index逐项跳过
+};
+
+/**
+ * @brief 快速定位状态
+ */
+struct FastSeekInfo {
+    bool enabled = false;
+    size_t fragments = 0;               // 文件的连续片段数
+    size_t table_bytes = 0;             // 映射表占用的RAM
+};
+
+class TreePrinter;
+
+/**
+ * @brief 文件系统变更类型
+ */
+enum class FileChange : uint8_t {
+    CREATED,                            // 文件被创建或以写入方式打开 (可能原本就存在)
+    REMOVED,                            // 文件或空目录被删除
+    RENAMED,                            // 文件或目录被重命名
+    FORMATTED                           // 卷被格式化
+};
+
+/**
+ * @brief 文件系统变更监听器 (如搜索索引)
+ * RWSD在修改成功后同步调用；回调中可以调用RWSD的文件操作，由此产生的变更同样会通知
+ */
+class FileChangeListener {
+public:
+    virtual ~FileChangeListener() = default;
+    
+    /**
+     * @param new_path 仅RENAMED时有效
+     */
+    virtual void on_file_change(FileChange change, const char* path, const char* new_path) = 0;
+};
+
 /**
  * @brief 可读写SD卡类 - 生产级实现
  * 支持完整的读写操作，针对Pico内存有限的情况进行优化
  */
 class RWSD : public StorageDevice {
 private:
-    SPIConfig config_;
+    friend class TreeWalker;
+    
+    std::unique_ptr<BlockDevice> device_;
+    std::pmr::memory_resource* memory_;     // 内部缓冲区的内存来源
+    PmrPtr<SectorCache> cache_;
+    CacheConfig cache_config_;
+    PmrPtr<FreeClusterMap> free_map_;
+    PmrPtr<OpenFileTable> files_;           // 打开文件表 (初始化时从memory_分配)
+    PmrPtr<ReadHandleCache> read_cache_;    // read_file_into/read_file_chunk的只读句柄缓存
+    PmrPtr<DentryCache> dentry_cache_;      // file_exists/get_file_info的路径查找缓存
+    PmrPtr<UsageCache> usage_cache_;        // disk_usage的目录汇总缓存
+    FileChangeListener* listener_;          // 文件变更监听器 (可为空)
+    FreeSpaceConfig free_space_config_;
     FATFS fs_;
     uint8_t fs_type_;
     bool is_initialized_;
+    bool fast_mount_;
+    uint64_t mount_time_us_;
+    mutable bool fsinfo_loaded_;
     
     // RAII资源管理
     std::unique_ptr<DIR> current_dir_;
     std::string current_path_;
     
+    /**
+     * @brief 在作用域内修改一个文件或空目录: 构造时记录原来的占用，析构时把差值计入目录占用缓存
+     * 必须在invalidate_path()之前构造 (之后查到的可能是已失效的结果)
+     */
+    class UsageUpdate {
+    private:
+        const RWSD& sd_;
+        const std::string& path_;
+        DirectoryUsage before_;
+        bool tracked_;
+        
+    public:
+        UsageUpdate(const RWSD& sd, const std::string& path);
+        UsageUpdate(const RWSD& sd, const std::string& path, bool tracked);
+        ~UsageUpdate();
+        
+        UsageUpdate(const UsageUpdate&) = delete;
+        UsageUpdate& operator=(const UsageUpdate&) = delete;
+        
+        bool was_directory() const { return before_.directories > 0; }
+    };
+    
     // 私有方法
-    void initialize_spi();
-    void deinitialize_spi();
+    Result<void> initialize_device();
+    void deinitialize_device();
+    void setup_cache();
+    void setup_free_map();
+    void start_free_tracking();
+    void apply_free_map();
+    bool load_fsinfo() const;
+    Result<void> write_fsinfo();
+    void invalidate_path(const std::string& path);
+    void notify_change(FileChange change, const std::string& path, const char* new_path = nullptr);
+    FRESULT stat_path(const std::string& path, FILINFO& fno) const;
+    DirectoryUsage path_usage(const std::string& path) const;
+    uint32_t cluster_bytes() const { return (uint32_t)fs_.csize * BlockDevice::SECTOR_SIZE; }
+    Result<void> write_barrier();
+    Result<void> reserve_space(FIL* fp, FSIZE_t size, bool contiguous);
+    Result<void> print_tree(const std::string& path, TreePrinter& printer, int max_depth, bool sorted) const;
     Result<void> mount_filesystem();
     void unmount_filesystem();
-    ErrorCode fresult_to_error_code(FRESULT fr) const;
+    static ErrorCode fresult_to_error_code(FRESULT fr);
     
 public:
+#if !MICRO_SD_HOST
     /**
      * @brief 构造函数
      * @param config SPI配置，如果不提供则使用默认配置
      */
     explicit RWSD(SPIConfig config = Config::DEFAULT);
+#endif
+    
+    /**
+     * @brief 构造函数 - 使用自定义块设备 (如主机上的磁盘镜像)
+     * @param device 块设备，所有权转移给RWSD
+     */
+    explicit RWSD(std::unique_ptr<BlockDevice> device);
     
     /**
      * @brief 析构函数 - RAII自动资源清理
@@ -66,6 +244,11 @@ public:
      */
     bool is_initialized() const { return is_initialized_; }
     
+    /**
+     * @brief 获取底层块设备
+     */
+    BlockDevice* get_block_device() const { return device_.get(); }
+    
     /**
      * @brief 获取文件系统类型
      */
@@ -84,12 +267,121 @@ public:
     Result<std::vector<FileInfo>> list_directory(const std::string& path = "") override;
     
     /**
-     * @brief 递归列出目录树结构
+     * @brief 列出目录树结构
+     * 整棵树保存在返回的字符串中；大目录树使用print_directory_tree()直接输出
      * @param path 起始路径，默认为根目录
-     * @param max_depth 最大递归深度，默认为10
+     * @param max_depth 最大层数，默认为10 (不超过MICRO_SD_WALK_MAX_DEPTH)
+     * @param sorted 目录在前、按名字排序；默认按目录中的顺序，排序的代价见TreeWalker
      * @return 树形结构字符串
      */
-    Result<std::string> list_directory_tree(const std::string& path = "", int max_depth = 10) const;
+    Result<std::string> list_directory_tree(const std::string& path = "", int max_depth = 10,
+                                            bool sorted = false) const;
+    
+    /**
+     * @brief 打印目录树，逐行写到stream (stdout或已打开的文件)，不在内存中保存整棵树
+     * 遍历器从内存资源分配 (固定大小，见TreeWalker)；sorted同list_directory_tree()
+     */
+    Result<void> print_directory_tree(const std::string& path, FILE* stream, int max_depth = 10,
+                                      bool sorted = false) const;
+    
+    /**
+     * @brief 目录占用回调 (路径在回调返回前有效)
+     */
+    using UsageVisitor = std::function<void(const char* path, const DirectoryUsage& usage)>;
+    
+    /**
+     * @brief 目录的递归占用 (du): 文件大小、文件数、子目录数、占用的簇数和簇内浪费
+     * 遍历中得到的各目录汇总被缓存 (MICRO_SD_USAGE_CACHE_ENTRIES)，之后经由本对象的写入、
+     * 删除和重命名按变化量更新缓存，再次查询不必重新遍历；已缓存的子目录在遍历中直接计入。
+     * 含有以写入方式打开的文件的目录在文件关闭前不缓存
+     * @param per_directory 可选: 逐个报告目录的递归占用 (子目录在上级之前)，path本身最后报告
+     * @param report_depth per_directory报告的子目录层数，0只报告path本身
+     */
+    Result<DirectoryUsage> disk_usage(const std::string& path, const UsageVisitor& per_directory = nullptr,
+                                      uint8_t report_depth = 0) const;
+    
+    /**
+     * @brief 目录迭代器 - 逐项读取目录，不分配内存
+     * 每次读取复用同一个FILINFO，返回的引用在下一次读取前有效。支持range-for:
+     * range-for从当前位置开始，中途break后cursor()指向最后返回的目录项之后。
+     * 读取出错时range-for提前结束，之后error()返回错误码
+     */
+    class DirectoryIterator {
+    private:
+        friend class RWSD;
+        
+        DIR dir_;
+        FILINFO entry_;
+        DirectoryFilter filter_;
+        uint32_t index_;                // 已读取的目录项数 (含被过滤的)
+        ErrorCode error_;
+        bool open_;
+        
+        bool matches() const;
+        
+    public:
+        /**
+         * @brief range-for迭代器 (单遍)
+         */
+        class iterator {
+        private:
+            DirectoryIterator* owner_;  // nullptr表示结束
+            
+        public:
+            explicit iterator(DirectoryIterator* owner) : owner_(owner) {}
+            const FILINFO& operator*() const { return owner_->entry_; }
+            const FILINFO* operator->() const { return &owner_->entry_; }
+            iterator& operator++();
+            bool operator==(const iterator& other) const { return owner_ == other.owner_; }
+            bool operator!=(const iterator& other) const { return owner_ != other.owner_; }
+        };
+        
+        DirectoryIterator();
+        ~DirectoryIterator() { close(); }
+        
+        DirectoryIterator(const DirectoryIterator&) = delete;
+        DirectoryIterator& operator=(const DirectoryIterator&) = delete;
+        DirectoryIterator(DirectoryIterator&& other) noexcept;
+        DirectoryIterator& operator=(DirectoryIterator&& other) noexcept;
+        
+        bool is_open() const { return open_; }
+        
+        /**
+         * @brief 读取下一个符合过滤条件的目录项 ("."和".."被跳过)
+         * @return 指向复用的FILINFO；已到末尾时返回nullptr
+         */
+        Result<const FILINFO*> next();
+        
+        iterator begin();
+        iterator end() { return iterator(nullptr); }
+        
+        /**
+         * @brief 当前位置 (最后返回的目录项之后)
+         */
+        DirectoryCursor cursor() const;
+        
+        /**
+         * @brief 回到保存的位置
+         * 同一次挂载中直接恢复目录读取位置；重新挂载后或目录已被替换时从头逐项跳过。
+         * 两次之间在前面插入的目录项可能被跳过
+         */
+        Result<void> seek(const DirectoryCursor& cursor);
+        
+        /**
+         * @brief 回到目录开头
+         */
+        Result<void> rewind();
+        
+        ErrorCode error() const { return error_; }
+        void close();
+    };
+    
+    /**
+     * @brief 打开目录迭代器
+     * @param filter 过滤条件，不符合的目录项不返回 (仍计入游标)
+     */
+    Result<DirectoryIterator> open_directory(const std::string& path,
+                                             const DirectoryFilter& filter = DirectoryFilter());
     
     /**
      * @brief 创建目录
@@ -124,6 +416,17 @@ public:
     Result<std::vector<uint8_t>> read_file_chunk(const std::string& path, 
                                                  size_t offset, size_t size) const override;
     
+    /**
+     * @brief 读取文件到调用者提供的缓冲区 (不分配堆内存)
+     * 最近读取的文件的只读句柄被缓存，重复的分块读取不再解析路径
+     * @param buffer 目标缓冲区
+     * @param capacity 缓冲区大小，最多读取该字节数
+     * @param offset 文件内起始偏移
+     * @return 实际读取的字节数 (到达文件末尾时小于capacity)
+     */
+    Result<size_t> read_file_into(const std::string& path, void* buffer, size_t capacity,
+                                  size_t offset = 0) const;
+    
     /**
      * @brief 读取文本文件
      */
@@ -134,20 +437,57 @@ public:
      */
     Result<void> write_file(const std::string& path, const std::vector<uint8_t>& data);
     
+    /**
+     * @brief 从调用者的缓冲区写入文件 (覆盖模式，不分配堆内存)
+     */
+    Result<void> write_file(const std::string& path, const void* data, size_t size);
+    
     /**
      * @brief 写入文本文件 (覆盖模式)
      */
-    Result<void> write_text_file(const std::string& path, const std::string& content);
+    Result<void> write_text_file(const std::string& path, std::string_view content);
     
     /**
      * @brief 追加写入文件
      */
     Result<void> append_file(const std::string& path, const std::vector<uint8_t>& data);
     
+    /**
+     * @brief 从调用者的缓冲区追加写入文件 (不分配堆内存)
+     */
+    Result<void> append_file(const std::string& path, const void* data, size_t size);
+    
     /**
      * @brief 追加写入文本文件
      */
-    Result<void> append_text_file(const std::string& path, const std::string& content);
+    Result<void> append_text_file(const std::string& path, std::string_view content);
+    
+    /**
+     * @brief 原子替换文件内容
+     * 先写入同目录下的临时文件path.tmp，再经replace_file()换为path。任何时刻掉电，
+     * 卡上都保留旧内容或新内容之一 (新内容可能以path.new的形式存在，启动时调用
+     * recover_file()恢复)。开始前先调用recover_file(path)
+     */
+    Result<void> write_file_atomic(const std::string& path, const void* data, size_t size);
+    Result<void> write_file_atomic(const std::string& path, std::string_view content);
+    
+    /**
+     * @brief 以已写完并关闭的source原子替换path
+     * path不存在时直接重命名；存在时先把source重命名为path.new并落盘，再删除path、
+     * 把path.new重命名为path，每一步之后都回写缓存。比write_file多至多三次目录项修改
+     * 和四次缓存回写 (每次只写回刚修改的目录扇区；没有扇区缓存时回写为空操作)
+     * @note source应与path在同一目录。提交前掉电时source原样留下，由调用方处理
+     *       (source为path.tmp时由recover_file()删除)
+     */
+    Result<void> replace_file(const std::string& path, const std::string& source);
+    
+    /**
+     * @brief 恢复被中断的原子写入
+     * path.tmp可能在写入中途掉电而不完整 (首次写入时path也不存在)，一律删除；
+     * path.new只在内容落盘后才出现，存在时删除path并把它重命名为path
+     * @return 是否采用了path.new
+     */
+    Result<bool> recover_file(const std::string& path);
     
     /**
      * @brief 删除文件
@@ -164,6 +504,15 @@ public:
      */
     Result<void> copy_file(const std::string& src_path, const std::string& dst_path);
     
+    /**
+     * @brief 流式复制文件 - 使用固定大小的缓冲区，内存占用与文件大小无关
+     * @return 最终进度 (字节数、耗时、吞吐量)；取消时返回CANCELLED并删除目标文件
+     * 源和目标为同一文件 (包括大小写或分隔符不同的路径) 时返回INVALID_PARAMETER，
+     * 目标正以写入方式打开时返回PERMISSION_DENIED
+     */
+    Result<CopyProgress> copy_file(const std::string& src_path, const std::string& dst_path,
+                                   const CopyOptions& options);
+    
     /**
      * @brief 同步文件系统
      */
@@ -173,16 +522,24 @@ public:
     
     /**
      * @brief 文件句柄类 - 支持流式读写
+     * 只保存打开文件表中的(槽位, 代数)，FIL位于RWSD的打开文件表中，移动句柄不复制FIL。
+     * 卸载时所有文件被关闭，残留句柄随之失效；句柄不得比创建它的RWSD存活更久
      */
     class FileHandle {
     private:
-        FIL file_;
-        bool is_open_;
-        std::string path_;
-        std::string mode_;
+        friend class RWSD;
+        
+        OpenFileTable* table_;
+        uint8_t slot_;
+        uint16_t generation_;
+        
+        FileHandle(OpenFileTable* table, uint8_t slot, uint16_t generation)
+            : table_(table), slot_(slot), generation_(generation) {}
+        OpenFileTable::Slot* slot() const;
+        FIL* file() const;
         
     public:
-        FileHandle() : is_open_(false) {}
+        FileHandle() : table_(nullptr), slot_(OpenFileTable::INVALID_SLOT), generation_(0) {}
         ~FileHandle() { close(); }
         
         // 禁用拷贝
@@ -191,28 +548,40 @@ public:
         
         // 支持移动
         FileHandle(FileHandle&& other) noexcept;
+        FileHandle& operator=(FileHandle&& other) noexcept;
         
-        bool is_open() const { return is_open_; }
-        const std::string& get_path() const { return path_; }
-        const std::string& get_mode() const { return mode_; }
+        bool is_open() const { return file() != nullptr; }
+        std::string_view get_path() const;
+        std::string_view get_mode() const;
+        
+        /**
+         * @brief 句柄标识 (槽位 << 16 | 代数)，关闭后同一槽位的新句柄标识不同
+         */
+        uint32_t id() const { return ((uint32_t)slot_ << 16) | generation_; }
+        
+        /**
+         * @brief 快速定位状态 (片段数和映射表RAM)
+         */
+        FastSeekInfo fast_seek_info() const;
         
         // 文件操作
-        Result<void> open(const std::string& path, const std::string& mode);
         void close();
         
         // 读取操作
         Result<std::vector<uint8_t>> read(size_t size);
-        Result<size_t> read_text(std::string& text, size_t max_size);
+        Result<size_t> read_into(void* buffer, size_t size);    // 读入调用者的缓冲区，不分配堆内存
+        Result<size_t> read_text(std::string& text, size_t max_size);  // 复用text已有的容量
         
         // 写入操作
         Result<size_t> write(const std::vector<uint8_t>& data);
-        Result<size_t> write(const std::string& text);
-        Result<size_t> write_line(const std::string& line);
+        Result<size_t> write(const void* data, size_t size);
+        Result<size_t> write(std::string_view text);
+        Result<size_t> write_line(std::string_view line);
         
         // 文件定位
         Result<void> seek(size_t position);
         Result<size_t> tell() const;
-        Result<size_t> size() const;
+        Result<size_t> size() const;        // 有预分配时为实际写入的大小
         
         // 文件控制
         Result<void> flush();
@@ -221,13 +590,177 @@ public:
     
     /**
      * @brief 打开文件句柄
+     * @param mode "r"/"w"/"a"，可附加"+"
+     * 同时打开的文件数受MICRO_SD_MAX_OPEN_FILES限制，超出时失败
      */
     Result<FileHandle> open_file(const std::string& path, const std::string& mode);
     
+    /**
+     * @brief 按选项打开文件句柄 (如快速定位模式)
+     */
+    Result<FileHandle> open_file(const std::string& path, const std::string& mode,
+                                 const OpenOptions& options);
+    
+    // === 连续区段写入器 ===
+    
+    /**
+     * @brief 连续区段写入器 - 绕过FatFs直接向块设备写入整扇区
+     * 文件创建时连续预分配，起始扇区只解析一次；之后整扇区数据以多块写入直接送往
+     * 块设备 (经过扇区缓存和空闲簇索引层以保持一致)，不足一个扇区的尾部暂存在写入器中。
+     * 目录项中的文件大小只在检查点和关闭时更新，掉电时最多丢失最后一个检查点之后的数据。
+     * 与FileHandle一样占用打开文件表的一个槽位，不得比创建它的RWSD存活更久
+     */
+    class ExtentWriter {
+    private:
+        friend class RWSD;
+        
+        FileHandle handle_;
+        uint32_t first_sector_;         // 区段起始扇区 (绝对LBA)
+        size_t capacity_;               // 可写入的字节数
+        size_t written_;                // 已写入的字节数 (含暂存的尾部)
+        size_t checkpointed_;           // 上次检查点时的大小
+        size_t checkpoint_bytes_;
+        uint16_t tail_length_;          // 暂存的不足一个扇区的字节数
+        uint8_t tail_[BlockDevice::SECTOR_SIZE];
+        
+        ExtentWriter(FileHandle&& handle, uint32_t first_sector, size_t capacity, size_t checkpoint_bytes);
+        
+    public:
+        ExtentWriter();
+        ~ExtentWriter() { (void)close(); }
+        
+        ExtentWriter(const ExtentWriter&) = delete;
+        ExtentWriter& operator=(const ExtentWriter&) = delete;
+        ExtentWriter(ExtentWriter&& other) noexcept;
+        ExtentWriter& operator=(ExtentWriter&& other) noexcept;
+        
+        bool is_open() const { return handle_.is_open(); }
+        
+        /**
+         * @brief 追加数据
+         * @return 实际写入的字节数，超出预分配容量的部分不写入
+         */
+        Result<size_t> write(const void* data, size_t size);
+        
+        /**
+         * @brief 写出暂存的尾部扇区并更新目录项中的文件大小
+         */
+        Result<void> checkpoint();
+        
+        /**
+         * @brief 检查点后关闭，释放未写入部分的簇
+         */
+        Result<void> close();
+        
+        size_t bytes_written() const { return written_; }
+        size_t capacity() const { return capacity_; }
+        uint32_t first_sector() const { return first_sector_; }
+    };
+    
+    /**
+     * @brief 创建文件并打开连续区段写入器
+     * 已存在的文件被覆盖；找不到capacity字节的连续空闲空间时返回DISK_FULL
+     */
+    Result<ExtentWriter> open_extent_writer(const std::string& path, size_t capacity,
+                                            const ExtentWriterOptions& options = ExtentWriterOptions());
+    
+    /**
+     * @brief 为文件预留空间，文件大小扩展到bytes (文件不存在时创建)
+     * 预留的簇在之后的写入中无需再分配，写入不会修改FAT。预留区域的内容未定义，
+     * 适合固定大小的采集或环形文件；需要按实际写入截断的场景使用OpenOptions::preallocate_bytes
+     * @param contiguous 要求簇连续 (仅适用于空文件)，找不到连续空间时返回DISK_FULL；
+     *                   为false时优先连续分配，失败则分配普通簇链
+     */
+    Result<void> preallocate(const std::string& path, size_t bytes, bool contiguous = true);
+    
+    /**
+     * @brief 获取只读句柄缓存统计
+     */
+    ReadCacheStats get_read_cache_stats() const {
+        return read_cache_ ? read_cache_->get_stats() : ReadCacheStats();
+    }
+    
+    /**
+     * @brief 获取路径查找缓存统计
+     */
+    DentryCacheStats get_dentry_cache_stats() const {
+        return dentry_cache_ ? dentry_cache_->get_stats() : DentryCacheStats();
+    }
+    
+    /**
+     * @brief 获取目录占用缓存统计
+     */
+    UsageCacheStats get_usage_cache_stats() const {
+        return usage_cache_ ? usage_cache_->get_stats() : UsageCacheStats();
+    }
+    
+    /**
+     * @brief 设置文件变更监听器 (nullptr取消)，监听器的生命周期必须长于设置
+     */
+    void set_change_listener(FileChangeListener* listener) { listener_ = listener; }
+    FileChangeListener* get_change_listener() const { return listener_; }
+    
+    /**
+     * @brief 当前打开的文件数
+     */
+    size_t open_file_count() const { return files_ ? files_->open_count() : 0; }
+    
     // === 高级功能 ===
     
+    /**
+     * @brief 设置内部缓冲区 (扇区缓存、空闲簇索引、复制缓冲区) 的内存来源
+     * 之后新建的缓冲区从该资源分配；无堆模式 (MICRO_SD_HEAP_FREE) 下必须在初始化前调用。
+     * 资源的生命周期必须长于RWSD
+     */
+    void set_memory_resource(std::pmr::memory_resource* resource) { memory_ = resource; }
+    std::pmr::memory_resource* get_memory_resource() const { return memory_; }
+    
+    /**
+     * @brief 配置扇区缓存
+     * 可在初始化前后调用；已初始化时会先回写现有缓存再按新配置重建
+     * @param config 缓存配置，ram_budget小于512字节时禁用缓存
+     */
+    Result<void> configure_cache(const CacheConfig& config);
+    
+    /**
+     * @brief 获取扇区缓存统计
+     */
+    CacheStats get_cache_stats() const;
+    
+    /**
+     * @brief 配置空闲簇索引
+     * 已初始化时按新配置重新建立索引
+     */
+    Result<void> configure_free_space(const FreeSpaceConfig& config);
+    
+    /**
+     * @brief 启用/禁用快速挂载 (默认启用)
+     * 启用时若FAT32卷的FSINFO有效，挂载时不扫描FAT，空闲簇数取自FSINFO，
+     * 空闲簇索引推迟到scan_free_space()中建立；同步和卸载时回写FSINFO
+     */
+    void set_fast_mount(bool enabled) { fast_mount_ = enabled; }
+    bool is_fast_mount() const { return fast_mount_; }
+    
+    /**
+     * @brief 上次挂载耗时 (微秒)
+     */
+    uint64_t get_mount_time_us() const { return mount_time_us_; }
+    
+    /**
+     * @brief 分步建立空闲簇索引 (background_scan模式下在主循环中调用)
+     * @param max_sectors 本次最多扫描的FAT扇区数
+     * @return 索引是否已完整
+     */
+    Result<bool> scan_free_space(uint32_t max_sectors = 64);
+    
+    /**
+     * @brief 块设备维护 (如SD卡降频后的升频探测)，在主循环空闲时调用
+     */
+    Result<void> maintain_device();
+    
     /**
      * @brief 格式化文件系统
+     * 未初始化时会先初始化块设备，格式化完成后自动挂载
      */
     Result<void> format(const std::string& volume_label = "");
     
@@ -0,0 +1,181 @@
+/**
+ * @file sd_card_emulator.hpp
+ * @brief SPI模式SD卡模拟器 (Linux主机构建)
+ * @version 1.0.0
+ */
+
+#pragma once
+
+#include "spi_transport.hpp"
+#include "block_device.hpp"
+#include <vector>
+
+namespace MicroSD {
+
+/**
+ * @brief 模拟器时序参数
+ * 延迟和忙时间按当前SPI时钟换算为填充字节数，因此结果只取决于参数和时钟，可重复
+ */
+struct EmulatorTiming {
+    uint8_t command_latency_bytes = 1;      // 命令到R1响应之间的填充字节 (Ncr, 1-8)
+    uint32_t read_access_us = 100;          // 读命令到数据令牌的访问延迟 (Nac)
+    uint32_t write_busy_us = 800;           // 单块写入 (CMD24) 后的忙时间
+    uint32_t multi_write_busy_us = 250;     // 多块写入 (CMD25) 中每块的忙时间
+    uint32_t preerased_write_busy_us = 150; // ACMD23预擦除范围内每块的忙时间
+    uint32_t stop_busy_us = 50;             // CMD12/STOP_TRAN后的忙时间
+    uint32_t erase_busy_us = 20000;         // CMD38擦除忙时间
+    uint8_t init_polls = 3;                 // ACMD41返回空闲状态的次数
+    uint32_t max_stable_hz = 50000000;      // 超过该时钟时每个数据块注入一位错误
+    uint32_t reference_clock_hz = 125000000; // 分频基准 (RP2040 clk_peri)
+    uint32_t cpu_scale = 0;                 // 调用者在两次总线操作之间的主机CPU时间乘以该系数计入虚拟时间
+                                            // (模拟较慢的MCU，结果随主机负载波动)；0不计CPU时间
+};
+
+/**
+ * @brief 模拟器统计
+ */
+struct EmulatorStats {
+    uint32_t commands = 0;          // 收到的命令数
+    uint32_t blocks_read = 0;       // 发送的数据块
+    uint32_t blocks_written = 0;    // 写入镜像的数据块
+    uint32_t crc_rejects = 0;       // 因CRC错误拒绝的命令/数据块
+    uint32_t injected_errors = 0;   // 注入的位错误
+    uint64_t bytes = 0;             // 总线上传输的字节数
+};
+
+/**
+ * @brief SPI模式SD卡模拟器
+ * 作为SpiTransport插入SdSpiBlockDevice，在卡一侧实现SDHC的SPI协议
+ * (初始化序列、CMD/ACMD、数据令牌、CRC、忙信号)，数据存放在另一个块设备
+ * (通常为ImageBlockDevice) 中。
+ *
+ * 模拟器维护一个虚拟总线时间：每个字节按当前时钟计时，访问延迟和忙时间
+ * 以填充字节的形式出现在总线上，用于可重复地比较传输策略。
+ * 设置cpu_scale后调用者的CPU时间也计入虚拟时间；异步数据阶段中CPU时间与DMA重叠，
+ * 两者取较长者，用于衡量流水线传输的效果。
+ */
+class SdCardEmulator : public SpiTransport {
+private:
+    enum class State : uint8_t {
+        IDLE,               // 等待命令
+        READ_MULTI,         // CMD18连续发送数据块
+        WRITE_SINGLE,       // CMD24等待数据令牌
+        WRITE_MULTI,        // CMD25等待数据令牌
+        RECEIVE_BLOCK       // 接收数据块
+    };
+
+    BlockDevice& backing_;
+    EmulatorTiming timing_;
+    EmulatorStats stats_;
+    uint32_t clock_;
+    bool selected_;
+    bool async_;
+
+    // 卡状态
+    State state_;
+    State receive_return_;
+    bool idle_;
+    bool app_cmd_;
+    bool crc_on_;
+    uint8_t init_polls_left_;
+    uint32_t next_block_;
+    uint32_t preerase_left_;
+    uint32_t corrupt_left_;
+
+    // 命令帧/数据块接收
+    uint8_t frame_[6];
+    uint8_t frame_len_;
+    std::vector<uint8_t> block_;
+    size_t block_len_;
+
+    // 输出: 依次发送out_中的字节 (含延迟填充)，之后若仍在忙则发送0x00
+    std::vector<uint8_t> out_;
+    size_t out_pos_;
+    uint64_t now_ps_;
+    uint64_t busy_until_ps_;
+
+    // 异步 (DMA风格) 传输
+    uint8_t* pending_rx_;
+    const uint8_t* pending_tx_;
+    size_t pending_len_;
+
+    // 调用者CPU时间 (cpu_scale > 0)
+    uint64_t cpu_mark_ns_;          // 上一次总线操作结束时的主机时间
+    uint64_t dma_start_ps_;         // 异步传输开始时的虚拟时间
+    uint64_t dma_cpu_ps_;           // 异步传输期间调用者使用的CPU时间
+
+    struct CpuSpan;
+
+    uint32_t us_to_bytes(uint32_t us) const;
+    uint64_t us_to_ps(uint32_t us) const { return (uint64_t)us * 1000000; }
+    bool should_corrupt();
+    void respond(uint32_t delay, std::initializer_list<uint8_t> bytes);
+    void queue_data_block(const uint8_t* data, size_t length, uint32_t delay);
+    void queue_read_block();
+    void handle_command();
+    void execute(uint8_t cmd, uint32_t arg, bool app);
+    void finish_receive();
+    uint8_t next_output();
+    void consume_input(uint8_t data);
+    uint8_t exchange(uint8_t data);
+    void exchange_block(uint8_t* rx, const uint8_t* tx, size_t length);
+    void complete_transfer();
+    void charge_cpu();
+    void mark_cpu();
+
+public:
+    /**
+     * @brief 构造函数
+     * @param backing 存储数据的块设备 (不转移所有权)
+     * @param timing 时序参数
+     * @param async 是否模拟DMA风格的异步数据阶段 (start_*延迟到wait_transfer执行)
+     */
+    SdCardEmulator(BlockDevice& backing, const EmulatorTiming& timing = EmulatorTiming(), bool async = true);
+
+    SdCardEmulator(const SdCardEmulator&) = delete;
+    SdCardEmulator& operator=(const SdCardEmulator&) = delete;
+
+    Result<void> begin(uint32_t baudrate) override;
+    void end() override;
+    uint32_t set_clock(uint32_t baudrate) override;
+    uint32_t get_clock() const override { return clock_; }
+
+    void select() override;
+    void deselect() override;
+    uint8_t transfer(uint8_t data) override;
+    void write_bytes(const uint8_t* data, size_t length) override;
+    void read_bytes(uint8_t* data, size_t length) override;
+
+    void start_read(uint8_t* data, size_t length) override;
+    void start_write(const uint8_t* data, size_t length) override;
+    void wait_transfer() override;
+    bool is_async() const override { return async_; }
+
+    /**
+     * @brief 切换同步/异步数据阶段 (先完成进行中的传输)
+     */
+    void set_async(bool async);
+
+    std::string get_config_info() const override;
+
+    /**
+     * @brief 接下来的count个数据块 (读或写) 各注入一位错误
+     */
+    void inject_errors(uint32_t count) { corrupt_left_ += count; }
+
+    /**
+     * @brief 修改时序参数 (立即生效)
+     */
+    void set_timing(const EmulatorTiming& timing);
+    const EmulatorTiming& get_timing() const { return timing_; }
+
+    /**
+     * @brief 虚拟总线时间 (微秒)
+     */
+    uint64_t elapsed_us() const { return now_ps_ / 1000000; }
+
+    const EmulatorStats& get_stats() const { return stats_; }
+    void reset_stats() { stats_ = EmulatorStats(); }
+};
+
+} // namespace MicroSD
@@ -0,0 +1,210 @@
+/**
+ * @file sd_spi_block_device.hpp
+ * @brief SPI模式SD卡块设备
+ * @version 1.0.0
+ */
+
+#pragma once
+
+#include "block_device.hpp"
+#include "spi_transport.hpp"
+#include "pin_config.hpp"
+#include <functional>
+#include <memory>
+
+namespace MicroSD {
+
+/**
+ * @brief SD卡类型
+ */
+enum class CardType : uint8_t {
+    UNKNOWN = 0,
+    MMC,        // MMC v3
+    SD_V1,      // SD v1.x 标准容量
+    SD_V2,      // SD v2.0 标准容量 (字节寻址)
+    SDHC        // SD v2.0 高容量/扩展容量 (块寻址)
+};
+
+/**
+ * @brief SPI时钟协商统计
+ */
+struct ClockStats {
+    uint32_t current_hz = 0;        // 当前时钟
+    uint32_t negotiated_hz = 0;     // 初始化时协商出的最高稳定时钟
+    uint32_t crc_errors = 0;        // CRC错误次数 (数据块CRC16、命令CRC或卡报告的CRC错误)
+    uint32_t timeouts = 0;          // 超时次数
+    uint32_t token_errors = 0;      // 损坏的数据令牌/数据响应次数
+    uint32_t retries = 0;           // 重试次数
+    uint32_t downshifts = 0;        // 运行时降频次数
+    uint32_t upshifts = 0;          // 运行时恢复升频次数
+};
+
+/**
+ * @brief SPI模式SD卡块设备
+ * 实现SD卡SPI模式协议状态机，字节收发委托给SpiTransport
+ */
+class SdSpiBlockDevice : public BlockDevice {
+public:
+    /**
+     * @brief 流水线读取回调: 处理第index个已接收的数据块，返回false中止
+     */
+    using BlockVisitor = std::function<bool(uint32_t index, const uint8_t* data)>;
+
+    /**
+     * @brief 流水线写入回调: 填充第index个待发送的数据块，返回false中止
+     */
+    using BlockProducer = std::function<bool(uint32_t index, uint8_t* data)>;
+
+    /**
+     * @brief 时钟档位上限
+     */
+    static constexpr size_t MAX_CLOCK_STEPS = 16;
+
+private:
+    /**
+     * @brief 链路故障类型
+     * 仅记录总线传输问题；卡报告的命令/数据错误 (地址越界、参数错误、写保护等) 不属于链路故障
+     */
+    enum class LinkFault : uint8_t {
+        NONE = 0,
+        CRC,
+        TIMEOUT,
+        TOKEN       // 数据令牌或数据响应既非合法值也非卡报告的错误
+    };
+
+    std::unique_ptr<SpiTransport> transport_;
+    SPIConfig config_;
+    CardType card_type_;
+    BlockGeometry geometry_;
+    bool is_ready_;
+    bool multi_block_;
+    bool crc_enabled_;
+
+    // 自适应时钟
+    uint32_t clock_steps_[MAX_CLOCK_STEPS];
+    uint8_t step_count_;
+    uint8_t current_step_;
+    uint8_t negotiated_step_;
+    LinkFault last_fault_;
+    uint8_t burst_faults_;
+    uint64_t burst_start_us_;
+    uint64_t last_fault_us_;
+    uint32_t upshift_interval_ms_;
+    ClockStats clock_stats_;
+
+    // 底层SPI传输
+    uint8_t transfer(uint8_t data) { return transport_->transfer(data); }
+    void select();
+    void deselect();
+    bool wait_ready(uint32_t timeout_ms);
+
+    // SD协议
+    uint8_t send_command(uint8_t cmd, uint32_t arg);
+    bool wait_data_token();
+    uint16_t receive_crc();
+    bool check_crc(const uint8_t* buffer, size_t length, uint16_t received);
+    uint16_t block_crc(const uint8_t* buffer) const;
+    bool receive_data_block(uint8_t* buffer, size_t length);
+    bool send_data_token(uint8_t token);
+    bool finish_transmit_block(uint16_t crc);
+    bool transmit_data_block(const uint8_t* buffer, uint8_t token);
+    bool read_register(uint8_t cmd, uint8_t* buffer, size_t length);
+    bool read_geometry();
+    uint32_t card_address(uint32_t sector) const;
+    bool read_blocks(uint32_t sector, uint8_t* buffer, uint32_t count);
+    bool write_blocks(uint32_t sector, const uint8_t* buffer, const uint8_t* const* blocks, uint32_t count);
+    Result<void> write_with_retry(uint32_t sector, const uint8_t* buffer, const uint8_t* const* blocks,
+                                  uint32_t count);
+
+    // 自适应时钟
+    void build_clock_steps();
+    void apply_clock_step(uint8_t step);
+    bool probe_clock_step(uint8_t step);
+    void negotiate_clock();
+    void record_fault();
+    void maybe_upshift();
+
+public:
+#if !MICRO_SD_HOST
+    /**
+     * @brief 构造函数 - 使用RP2040硬件SPI (数据阶段使用DMA)
+     * @param config SPI配置
+     */
+    explicit SdSpiBlockDevice(const SPIConfig& config = Config::DEFAULT);
+#endif
+
+    /**
+     * @brief 构造函数 - 使用自定义传输 (如主机上的模拟传输)
+     * @param transport SPI传输，所有权转移给设备
+     * @param config SPI配置 (使用其中的时钟设置)
+     */
+    SdSpiBlockDevice(std::unique_ptr<SpiTransport> transport, const SPIConfig& config = Config::DEFAULT);
+    ~SdSpiBlockDevice() override;
+
+    SdSpiBlockDevice(const SdSpiBlockDevice&) = delete;
+    SdSpiBlockDevice& operator=(const SdSpiBlockDevice&) = delete;
+
+    Result<void> initialize() override;
+    void deinitialize() override;
+    bool is_ready() const override { return is_ready_; }
+    BlockGeometry geometry() const override { return geometry_; }
+
+    Result<void> read(uint32_t sector, uint8_t* buffer, uint32_t count) override;
+    Result<void> write(uint32_t sector, const uint8_t* buffer, uint32_t count) override;
+    Result<void> write_gather(uint32_t sector, const uint8_t* const* blocks, uint32_t count) override;
+    Result<void> sync() override;
+    Result<void> trim(uint32_t first_sector, uint32_t count) override;
+
+    /**
+     * @brief 自适应时钟维护: 降频后经过恢复间隔无链路故障时，探测升高一档
+     * 探测会读取若干次0扇区，因此不在read()/write()内执行，应在主循环空闲时调用
+     */
+    Result<void> maintain() override;
+
+    std::string get_config_info() const override;
+
+    /**
+     * @brief 双缓冲流水线读取
+     * 第N+1块经由DMA接收的同时，在CPU上对第N块调用visit (如校验、解压)
+     * @param buffers 调用者提供的2个扇区大小的缓冲区 (1024字节)
+     */
+    Result<void> read_pipelined(uint32_t sector, uint32_t count, uint8_t* buffers,
+                                const BlockVisitor& visit);
+
+    /**
+     * @brief 双缓冲流水线写入
+     * 第N块经由DMA发送的同时，在CPU上调用produce准备第N+1块 (如采样、压缩)
+     * @param buffers 调用者提供的2个扇区大小的缓冲区 (1024字节)
+     */
+    Result<void> write_pipelined(uint32_t sector, uint32_t count, uint8_t* buffers,
+                                 const BlockProducer& produce);
+
+    /**
+     * @brief 获取SPI配置
+     */
+    const SPIConfig& get_config() const { return config_; }
+
+    /**
+     * @brief 获取时钟协商统计
+     */
+    const ClockStats& get_clock_stats() const { return clock_stats_; }
+
+    /**
+     * @brief 获取SPI传输
+     */
+    SpiTransport& get_transport() { return *transport_; }
+
+    /**
+     * @brief 获取卡类型
+     */
+    CardType get_card_type() const { return card_type_; }
+
+    /**
+     * @brief 启用/禁用多块传输 (CMD18/CMD25)
+     * 禁用时连续扇区逐个使用CMD17/CMD24传输，用于性能对比
+     */
+    void set_multi_block(bool enabled) { multi_block_ = enabled; }
+    bool is_multi_block() const { return multi_block_; }
+};
+
+} // namespace MicroSD
@@ -0,0 +1,215 @@
+/**
+ * @file search_index.hpp
+ * @brief 卡上文件搜索索引 - 按文件名前缀/后缀/扩展名查找路径，随RWSD的修改增量维护
+ * @version 1.0.0
+ */
+
+#pragma once
+
+#include "rw_sd.hpp"
+#include "tree_walker.hpp"
+#include <functional>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+namespace MicroSD {
+
+/**
+ * @brief 搜索索引配置
+ */
+struct SearchIndexConfig {
+    const char* directory = "/.index";  // 索引文件所在目录 (构造时复制)，其中的文件不被索引
+    size_t max_files = 1024;            // 可索引的文件数上限，决定重建时的RAM (每个文件16字节)
+    size_t name_bytes = 16 * 1024;      // 重建时的文件名缓冲区大小
+    size_t journal_bytes = 1024;        // 未合并变更的缓冲区大小 (每条变更为路径长度加2字节)
+};
+
+/**
+ * @brief 搜索索引统计
+ */
+struct SearchIndexStats {
+    uint32_t files = 0;                 // 索引文件中的文件数
+    uint32_t pending = 0;               // 尚未合并到索引文件的变更数
+    uint32_t queries = 0;
+    uint32_t probes = 0;                // 查询读取的索引记录数
+    uint32_t rebuilds = 0;              // 完成的重建次数
+    bool stale = false;                 // 索引可能与卡上的文件不一致
+};
+
+/**
+ * @brief 持久化文件搜索索引
+ * 索引文件names.idx保存所有文件的路径，以及按文件名 (不区分大小写) 排序和按反转文件名
+ * 排序的两个定长记录数组，前缀和后缀查询在卡上二分查找，读取O(log n)条记录，不需要把
+ * 索引装入RAM。作为RWSD的变更监听器，创建/写入/删除/重命名记录在RAM中的变更日志里，
+ * 查询时日志中出现的路径以日志为准；日志满或目录被重命名后索引标记为过期。
+ *
+ * close()把变更日志连同卷的总扇区数和空闲扇区数写入journal.log，open()时两者一致才
+ * 信任索引；在PC上编辑过卡 (空闲空间改变) 或上次未正常关闭时索引为过期状态，查询
+ * 仍返回旧结果，由rebuild_step()在主循环中分步遍历整张卡重建
+ *
+ * 卷状态只是一个启发式判断: 在PC上重命名或移动文件、删除和新建占用同样簇数的文件等
+ * 不改变空闲扇区数的修改检测不到，查询会返回已不存在的路径，新出现的文件在重建之前
+ * 查不到。查询本身不逐个确认结果 (每个结果一次目录查找会抵消索引的作用)；调用者对
+ * 实际使用的结果调用confirm()，不存在时索引被标记为过期，由needs_rebuild()安排重建
+ *
+ * 索引文件格式 (小端):
+ *   头部(32): "SIDX" 版本(4) 文件数(4) 后缀数组偏移(4) 路径区偏移(4) 路径区大小(4) 保留(4) 校验(4)
+ *   名字记录(8)×n: 路径偏移(4) 路径长度(2) 名字长度(1) 保留(1)，按名字排序
+ *   后缀数组(4)×n: 名字记录的序号，按反转的名字排序
+ *   路径区: 所有路径，名字为路径的最后一级
+ */
+class SearchIndex : public FileChangeListener {
+public:
+    /**
+     * @brief 查询结果回调，返回false停止查询 (路径在回调返回前有效)
+     */
+    using Visitor = std::function<bool(std::string_view path)>;
+
+private:
+    struct BuildRecord {
+        uint32_t name_offset;           // names_中的偏移
+        uint32_t path_offset;           // 路径文件中的偏移
+        uint32_t rank;                  // 在名字顺序中的序号
+        uint16_t path_length;
+        uint8_t name_length;
+    };
+
+    class Collector : public WalkSink {
+    private:
+        SearchIndex& index_;
+
+    public:
+        explicit Collector(SearchIndex& index) : index_(index) {}
+        WalkAction enter(const WalkEntry& entry) override;
+        void depth_limit(const WalkEntry& entry) override;
+    };
+
+    RWSD& sd_;
+    SearchIndexConfig config_;
+    char directory_[MICRO_SD_MAX_PATH];
+    size_t directory_length_;
+
+    // 索引文件头
+    uint32_t count_;
+    uint32_t suffix_offset_;
+    uint32_t strings_offset_;
+
+    std::pmr::vector<uint8_t> journal_; // 日志头 + 变更记录: 操作(1) 长度(1) 路径
+    uint32_t journal_records_;
+    bool journal_saved_;                // 卡上的journal.log与RAM一致且带有效的卷状态
+    bool stale_;
+    bool open_;
+    char present_[MICRO_SD_MAX_PATH];   // 最近确认在索引文件中的路径 (重复写入同一文件时免去查找)
+
+    // 分步重建状态
+    PmrPtr<TreeWalker> walker_;
+    RWSD::FileHandle paths_file_;
+    std::pmr::vector<BuildRecord> records_;
+    std::pmr::vector<char> names_;
+    uint32_t paths_size_;
+    size_t journal_mark_;               // 重建开始时的日志长度，之前的变更已包含在遍历中
+    bool rebuilding_;
+    bool incomplete_;                   // 超出文件数、名字缓冲区或目录层数上限，或重建期间索引被标记为过期
+    ErrorCode build_error_;
+    SearchIndexStats stats_;
+
+    void file_path(const char* name, char* path, size_t size) const;
+    size_t normalize(const char* path, char* out) const;
+    bool is_own(const char* normalized, size_t length) const;
+    Result<void> read_at(uint32_t offset, void* buffer, size_t size) const;
+    Result<void> read_entry(uint32_t position, bool by_suffix, uint8_t* record, char* name);
+    Result<uint32_t> lower_bound(std::string_view key, bool by_suffix);
+    Result<bool> base_contains(const char* path, size_t length);
+    char journal_state(const char* path, size_t length, size_t from) const;
+    void append(char op, const char* path, size_t length);
+    void mark_stale();
+    void record_create(const char* path, size_t length);
+    void record_remove(const char* path, size_t length);
+    Result<size_t> query(std::string_view key, bool by_suffix, const Visitor& visit);
+    Result<void> volume_stamp(uint32_t& total, uint32_t& free) const;
+    Result<void> load_header();
+    Result<void> load_journal();
+    Result<void> save_journal();
+    void discard_journal_file();
+    Result<void> start_rebuild();
+    Result<void> finish_rebuild();
+    Result<void> write_index(const char* path);
+    void abort_rebuild();
+    bool add_file(const WalkEntry& entry);
+
+public:
+    /**
+     * @brief 构造函数
+     * @param sd 已初始化的RWSD，缓冲区从其内存资源分配
+     */
+    SearchIndex(RWSD& sd, const SearchIndexConfig& config = SearchIndexConfig());
+    ~SearchIndex() { (void)close(); }
+
+    SearchIndex(const SearchIndex&) = delete;
+    SearchIndex& operator=(const SearchIndex&) = delete;
+
+    /**
+     * @brief 打开索引: 读取索引文件头和变更日志，检查卷状态，注册为RWSD的变更监听器
+     * 索引不存在或已过期时同样成功，is_stale()为true
+     */
+    Result<void> open();
+
+    /**
+     * @brief 放弃进行中的重建，保存变更日志并取消监听
+     */
+    Result<void> close();
+
+    /**
+     * @brief 保存变更日志和当前卷状态 (之后到下一次修改前掉电，索引仍然有效)
+     */
+    Result<void> flush();
+
+    /**
+     * @brief 文件名以prefix开头的文件 (不区分大小写)
+     * @return 回调的次数
+     */
+    Result<size_t> find_prefix(std::string_view prefix, const Visitor& visit);
+
+    /**
+     * @brief 文件名以suffix结尾的文件 (不区分大小写)
+     */
+    Result<size_t> find_suffix(std::string_view suffix, const Visitor& visit);
+
+    /**
+     * @brief 指定扩展名 (不含'.') 的文件
+     */
+    Result<size_t> find_extension(std::string_view extension, const Visitor& visit);
+
+    /**
+     * @brief 确认查询结果仍然存在 (一次file_exists)，不存在时把索引标记为过期
+     * 只需对实际打开或显示的结果调用
+     */
+    bool confirm(std::string_view path);
+
+    /**
+     * @brief 是否应该重建 (已过期，或变更日志已用去3/4)
+     */
+    bool needs_rebuild() const;
+    bool is_stale() const { return stale_; }
+    bool is_rebuilding() const { return rebuilding_; }
+
+    /**
+     * @brief 分步重建，每次最多遍历max_entries个目录项；两次调用之间可以正常读写文件
+     * @return 重建是否已完成；当前没有进行中的重建时先开始一次新的重建
+     * 文件数或名字总长超出配置时只索引遍历到的部分，索引保持过期状态
+     */
+    Result<bool> rebuild_step(size_t max_entries);
+
+    /**
+     * @brief 完整重建
+     */
+    Result<void> rebuild();
+
+    void on_file_change(FileChange change, const char* path, const char* new_path) override;
+
+    bool is_open() const { return open_; }
+    SearchIndexStats get_stats() const;
+};
+
+} // namespace MicroSD
@@ -0,0 +1,164 @@
+/**
+ * @file sector_cache.hpp
+ * @brief 写回式LRU扇区缓存 - 位于FatFs与块设备之间
+ * @version 1.0.0
+ */
+
+#pragma once
+
+#include "block_device.hpp"
+#include "memory_config.hpp"
+#include <vector>
+
+namespace MicroSD {
+
+/**
+ * @brief 扇区缓存配置
+ */
+struct CacheConfig {
+    size_t ram_budget = 8 * 1024;       // 缓存RAM预算 (字节)，小于一个扇区时禁用缓存
+    bool write_back = true;             // 写回模式 (false为写穿透)
+    bool honor_device_sync = true;      // FatFs的CTRL_SYNC是否立即回写 (false时仅由RWSD::sync()回写)
+    uint32_t bypass_threshold = 2;      // 不少于该扇区数的传输绕过缓存，直接以多块命令访问设备
+    uint8_t max_pinned_percent = 75;    // 固定扇区 (FAT/目录) 最多占用的缓存比例
+};
+
+/**
+ * @brief 扇区缓存统计
+ */
+struct CacheStats {
+    uint32_t hits = 0;                  // 命中扇区数
+    uint32_t misses = 0;                // 未命中扇区数
+    uint32_t evictions = 0;             // 淘汰次数
+    uint32_t writebacks = 0;            // 回写扇区数
+    uint32_t bypass_sectors = 0;        // 绕过缓存的扇区数
+
+    float hit_rate() const {
+        uint32_t total = hits + misses;
+        return total > 0 ? (float)hits / total : 0.0f;
+    }
+};
+
+/**
+ * @brief LRU扇区缓存
+ * 包装另一个块设备。FAT区和经由FatFs窗口缓冲区访问的目录扇区被固定，
+ * 优先于普通数据扇区保留在缓存中。
+ */
+class SectorCache : public BlockDevice {
+private:
+    static constexpr uint16_t NIL = 0xFFFF;
+
+    struct Entry {
+        uint32_t sector;
+        uint16_t prev;
+        uint16_t next;
+        bool valid;
+        bool dirty;
+        bool pinned;
+    };
+
+    struct LruList {
+        uint16_t head = NIL;    // 最近使用
+        uint16_t tail = NIL;    // 最久未使用
+        uint16_t size = 0;
+    };
+
+    BlockDevice& device_;
+    CacheConfig config_;
+    std::pmr::vector<Entry> entries_;
+    std::pmr::vector<uint8_t> data_;
+    std::pmr::vector<uint16_t> index_;  // 开放寻址哈希: 扇区号 -> 条目
+    std::pmr::vector<uint16_t> flush_order_;  // flush()的回写顺序 (预先分配)
+    std::pmr::vector<const uint8_t*> flush_blocks_;  // flush()中一段连续扇区的数据指针 (预先分配)
+    LruList normal_;
+    LruList pinned_;
+    uint16_t free_head_;
+    uint16_t max_pinned_;
+    uint32_t pin_first_;
+    uint32_t pin_count_;
+    const uint8_t* metadata_window_;
+    CacheStats stats_;
+
+    uint8_t* entry_data(uint16_t idx) { return &data_[(size_t)idx * SECTOR_SIZE]; }
+    bool should_pin(uint32_t sector, const uint8_t* buffer) const;
+
+    // 哈希索引
+    size_t slot_of(uint32_t sector) const;
+    uint16_t lookup(uint32_t sector) const;
+    void index_insert(uint16_t idx);
+    void index_erase(uint16_t idx);
+
+    // LRU链表
+    LruList& list_of(const Entry& entry) { return entry.pinned ? pinned_ : normal_; }
+    void list_unlink(uint16_t idx);
+    void list_push_front(uint16_t idx);
+    void touch(uint16_t idx, bool pin);
+
+    // 条目管理
+    Result<uint16_t> allocate(uint32_t sector, bool pin);
+    Result<void> write_back_entry(uint16_t idx);
+    void drop(uint16_t idx);
+
+public:
+    /**
+     * @brief 构造函数
+     * @param device 被缓存的块设备 (不转移所有权)
+     * @param config 缓存配置
+     * @param memory 缓存缓冲区的内存来源
+     */
+    SectorCache(BlockDevice& device, const CacheConfig& config = CacheConfig(),
+                std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+    ~SectorCache() override;
+
+    SectorCache(const SectorCache&) = delete;
+    SectorCache& operator=(const SectorCache&) = delete;
+
+    Result<void> initialize() override { return device_.initialize(); }
+    void deinitialize() override;
+    bool is_ready() const override { return device_.is_ready(); }
+    BlockGeometry geometry() const override { return device_.geometry(); }
+
+    Result<void> read(uint32_t sector, uint8_t* buffer, uint32_t count) override;
+    Result<void> write(uint32_t sector, const uint8_t* buffer, uint32_t count) override;
+    Result<void> sync() override;
+    Result<void> trim(uint32_t first_sector, uint32_t count) override;
+    Result<void> maintain() override { return device_.maintain(); }
+
+    std::string get_config_info() const override;
+
+    /**
+     * @brief 回写所有脏扇区并同步底层设备
+     */
+    Result<void> flush();
+
+    /**
+     * @brief 丢弃所有缓存内容 (不回写)
+     */
+    void invalidate();
+
+    /**
+     * @brief 设置固定扇区范围 (通常为FAT区)
+     */
+    void set_pinned_range(uint32_t first_sector, uint32_t count);
+
+    /**
+     * @brief 设置FatFs窗口缓冲区地址，经由该缓冲区传输的扇区视为元数据并固定
+     */
+    void set_metadata_window(const uint8_t* window) { metadata_window_ = window; }
+
+    /**
+     * @brief 缓存容量 (扇区数)
+     */
+    size_t capacity() const { return entries_.size(); }
+
+    /**
+     * @brief 当前脏扇区数
+     */
+    size_t dirty_count() const;
+
+    const CacheConfig& get_cache_config() const { return config_; }
+    const CacheStats& get_stats() const { return stats_; }
+    void reset_stats() { stats_ = CacheStats(); }
+};
+
+} // namespace MicroSD
@@ -0,0 +1,106 @@
+/**
+ * @file spi_transport.hpp
+ * @brief SPI传输抽象 - SD卡协议层与物理SPI/DMA之间的接口
+ * @version 1.0.0
+ */
+
+#pragma once
+
+#include "storage_device.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace MicroSD {
+
+/**
+ * @brief SPI传输抽象基类
+ * 协议状态机 (SdSpiBlockDevice) 只通过该接口收发字节，
+ * 因此可以在主机上用模拟传输进行测试。
+ */
+class SpiTransport {
+public:
+    virtual ~SpiTransport() = default;
+
+    /**
+     * @brief 初始化引脚和SPI外设
+     * @param baudrate 初始时钟频率 (Hz)
+     */
+    virtual Result<void> begin(uint32_t baudrate) = 0;
+
+    /**
+     * @brief 释放SPI外设
+     */
+    virtual void end() = 0;
+
+    /**
+     * @brief 设置时钟频率
+     * @return 实际生效的频率 (Hz)
+     */
+    virtual uint32_t set_clock(uint32_t baudrate) = 0;
+
+    /**
+     * @brief 获取当前时钟频率 (Hz)
+     */
+    virtual uint32_t get_clock() const = 0;
+
+    /**
+     * @brief 片选控制
+     */
+    virtual void select() = 0;
+    virtual void deselect() = 0;
+
+    /**
+     * @brief 全双工交换一个字节
+     */
+    virtual uint8_t transfer(uint8_t data) = 0;
+
+    /**
+     * @brief 发送数据块 (丢弃接收数据)
+     */
+    virtual void write_bytes(const uint8_t* data, size_t length) {
+        for (size_t i = 0; i < length; ++i) {
+            transfer(data[i]);
+        }
+    }
+
+    /**
+     * @brief 接收数据块 (发送0xFF)
+     */
+    virtual void read_bytes(uint8_t* data, size_t length) {
+        for (size_t i = 0; i < length; ++i) {
+            data[i] = transfer(0xFF);
+        }
+    }
+
+    // === 异步数据阶段 ===
+    // 默认实现同步完成传输；支持DMA的传输在start_*后立即返回，
+    // 调用者可在wait_transfer()之前处理其他数据块。
+
+    /**
+     * @brief 启动数据块接收
+     */
+    virtual void start_read(uint8_t* data, size_t length) { read_bytes(data, length); }
+
+    /**
+     * @brief 启动数据块发送
+     */
+    virtual void start_write(const uint8_t* data, size_t length) { write_bytes(data, length); }
+
+    /**
+     * @brief 等待异步传输完成
+     */
+    virtual void wait_transfer() {}
+
+    /**
+     * @brief 是否支持真正的异步 (DMA) 传输
+     */
+    virtual bool is_async() const { return false; }
+
+    /**
+     * @brief 获取传输配置描述
+     */
+    virtual std::string get_config_info() const = 0;
+};
+
+} // namespace MicroSD
@@ -10,6 +10,8 @@
 #include <string>
 #include <vector>
 #include <optional>
+#include <type_traits>
+#include <utility>
 
 namespace MicroSD {
 
@@ -26,6 +28,7 @@ enum class ErrorCode {
     IO_ERROR,
     INVALID_PARAMETER,
     FATFS_ERROR,
+    CANCELLED,
     UNKNOWN_ERROR
 };
 
@@ -45,46 +48,111 @@ struct FileInfo {
 
 /**
  * @brief 结果模板类 - 现代C++错误处理方式
+ * 只包含错误码、静态上下文指针和值，不分配堆内存；热路径上按值返回的开销
+ * 与返回一对(错误码, 值)相当。上下文必须指向静态存储 (如字符串字面量)。
  */
 template<typename T>
-class Result {
+class [[nodiscard]] Result {
 private:
     std::optional<T> value_;
     ErrorCode error_code_;
-    std::string error_message_;
+    const char* context_;
 
 public:
-    Result(T&& value) : value_(std::move(value)), error_code_(ErrorCode::SUCCESS) {}
-    Result(const T& value) : value_(value), error_code_(ErrorCode::SUCCESS) {}
-    Result(ErrorCode error, std::string message = "")
-        : error_code_(error), error_message_(std::move(message)) {}
+    using value_type = T;
+
+    Result(T&& value) : value_(std::move(value)), error_code_(ErrorCode::SUCCESS), context_(nullptr) {}
+    Result(const T& value) : value_(value), error_code_(ErrorCode::SUCCESS), context_(nullptr) {}
+    Result(ErrorCode error, const char* context = nullptr)
+        : error_code_(error), context_(context) {}
 
     bool is_ok() const { return error_code_ == ErrorCode::SUCCESS; }
     bool is_error() const { return !is_ok(); }
+    explicit operator bool() const { return is_ok(); }
     ErrorCode error_code() const { return error_code_; }
-    const std::string& error_message() const { return error_message_; }
+    const char* error_message() const { return context_ ? context_ : ""; }
     const T& operator*() const { return value_.value(); }
     T& operator*() { return value_.value(); }
     const T* operator->() const { return &value_.value(); }
     T* operator->() { return &value_.value(); }
+
+    /**
+     * @brief 成功时返回值，否则返回fallback
+     */
+    T value_or(T fallback) const& { return is_ok() ? *value_ : std::move(fallback); }
+    T value_or(T fallback) && { return is_ok() ? std::move(*value_) : std::move(fallback); }
+
+    /**
+     * @brief 成功时以值调用f (返回Result<U>)，否则传播错误
+     */
+    template<typename F>
+    auto and_then(F&& f) const& -> decltype(f(std::declval<const T&>())) {
+        using R = decltype(f(std::declval<const T&>()));
+        return is_ok() ? f(*value_) : R(error_code_, context_);
+    }
+
+    /**
+     * @brief 成功时以值调用f并包装为Result<U>，否则传播错误
+     */
+    template<typename F>
+    auto map(F&& f) const& -> Result<decltype(f(std::declval<const T&>()))> {
+        using R = Result<decltype(f(std::declval<const T&>()))>;
+        if (!is_ok()) {
+            return R(error_code_, context_);
+        }
+        if constexpr (std::is_void_v<typename R::value_type>) {
+            f(*value_);
+            return R();
+        } else {
+            return R(f(*value_));
+        }
+    }
+
+    /**
+     * @brief 失败时以错误码调用f (返回Result<T>)，用于回退处理
+     */
+    template<typename F>
+    Result or_else(F&& f) const& {
+        return is_ok() ? *this : f(error_code_);
+    }
 };
 
 // void类型的完全特化
 template<>
-class Result<void> {
+class [[nodiscard]] Result<void> {
 private:
     ErrorCode error_code_;
-    std::string error_message_;
+    const char* context_;
 
 public:
-    Result() : error_code_(ErrorCode::SUCCESS) {}
-    Result(ErrorCode error, std::string message = "")
-        : error_code_(error), error_message_(std::move(message)) {}
+    using value_type = void;
+
+    Result() : error_code_(ErrorCode::SUCCESS), context_(nullptr) {}
+    Result(ErrorCode error, const char* context = nullptr)
+        : error_code_(error), context_(context) {}
 
     bool is_ok() const { return error_code_ == ErrorCode::SUCCESS; }
     bool is_error() const { return !is_ok(); }
+    explicit operator bool() const { return is_ok(); }
     ErrorCode error_code() const { return error_code_; }
-    const std::string& error_message() const { return error_message_; }
+    const char* error_message() const { return context_ ? context_ : ""; }
+
+    /**
+     * @brief 成功时调用f (返回Result<U>)，否则传播错误
+     */
+    template<typename F>
+    auto and_then(F&& f) const -> decltype(f()) {
+        using R = decltype(f());
+        return is_ok() ? f() : R(error_code_, context_);
+    }
+
+    /**
+     * @brief 失败时以错误码调用f (返回Result<void>)，用于回退处理
+     */
+    template<typename F>
+    Result or_else(F&& f) const {
+        return is_ok() ? *this : f(error_code_);
+    }
 };
 
 /**
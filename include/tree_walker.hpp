@@ -0,0 +1,217 @@
+/**
+ * @file tree_walker.hpp
+ * @brief 目录树遍历 - 显式栈、固定内存，结果逐项交给接收器
+ * @version 1.0.0
+ */
+
+#pragma once
+
+#include "rw_sd.hpp"
+#include <stdio.h>
+#include <string>
+
+#ifndef MICRO_SD_WALK_MAX_DEPTH
+#define MICRO_SD_WALK_MAX_DEPTH 10      // 遍历的最大目录层数 (每层一个DIR)
+#endif
+
+#ifndef MICRO_SD_WALK_SORT_BATCH
+#define MICRO_SD_WALK_SORT_BATCH 8      // 排序模式每次扫描目录取出的项数 (每项约270字节)
+#endif
+
+namespace MicroSD {
+
+/**
+ * @brief 遍历中的目录项 (指针在回调返回前有效)
+ */
+struct WalkEntry {
+    const char* path;                   // 完整路径
+    const char* name;                   // 路径的最后一级
+    FSIZE_t size;
+    WORD date;
+    WORD time;
+    BYTE attributes;
+    uint8_t depth;                      // 0为起始目录的直接子项
+    bool is_last;                       // 是否为所在目录中按遍历顺序的最后一项
+
+    bool is_directory() const { return (attributes & AM_DIR) != 0; }
+};
+
+/**
+ * @brief 接收器对目录项的处理结果
+ */
+enum class WalkAction : uint8_t {
+    CONTINUE,                           // 继续 (目录则进入)
+    SKIP,                               // 不进入该目录
+    STOP                                // 结束遍历
+};
+
+/**
+ * @brief 遍历结果接收器
+ */
+class WalkSink {
+public:
+    virtual ~WalkSink() = default;
+
+    /**
+     * @brief 先序: 每个目录项在其子项之前
+     */
+    virtual WalkAction enter(const WalkEntry& entry) = 0;
+
+    /**
+     * @brief 后序: 目录的子项全部处理之后
+     */
+    virtual void leave(const WalkEntry& entry) { (void)entry; }
+
+    /**
+     * @brief 目录因超过最大层数而未进入
+     */
+    virtual void depth_limit(const WalkEntry& entry) { (void)entry; }
+};
+
+/**
+ * @brief 遍历选项
+ */
+struct WalkOptions {
+    bool sorted = false;                // 目录在前、按名字排序；代价随目录项数平方增长，见TreeWalker
+    uint8_t max_depth = MICRO_SD_WALK_MAX_DEPTH;    // 最大层数，超过MICRO_SD_WALK_MAX_DEPTH时按后者
+    DirectoryFilter filter;             // 属性条件作用于所有目录项，名字和扩展名条件只作用于文件
+};
+
+/**
+ * @brief 遍历统计
+ */
+struct WalkStats {
+    uint32_t directories = 0;           // 报告的目录数
+    uint32_t files = 0;                 // 报告的文件数
+    uint64_t bytes = 0;                 // 报告的文件总大小
+    uint32_t depth_limited = 0;         // 因层数限制未进入的目录数
+    uint32_t entries_read = 0;          // f_readdir读取的目录项数 (含预读和排序扫描)
+};
+
+/**
+ * @brief 目录树遍历器
+ * 用显式栈代替递归: 每层只保存一个DIR，所有层共用一个FILINFO和一个路径缓冲区，
+ * 内存占用固定 (约 MICRO_SD_WALK_MAX_DEPTH * sizeof(DIR) + 800字节，另加排序用的
+ * MICRO_SD_WALK_SORT_BATCH个候选项)，与目录大小无关。
+ * 对象可以静态分配或从内存资源分配，不占用调用者的栈。
+ * 未排序模式按目录中的顺序输出，通过预读下一项确定is_last，每个目录项约读取两次。
+ * 排序模式用路径缓冲区中的上一项作为下界扫描目录，一次取出之后最小的SORT_BATCH项：
+ * n项的目录约需 n / SORT_BATCH 次完整扫描，即约 n² / SORT_BATCH 次目录项读取，
+ * 另外每从一个子目录返回重新扫描一次 (子目录占用了批缓冲区)。上千项的目录读取次数
+ * 以十万计，RWSD的目录树打印默认不排序，只在调用者要求时使用排序模式
+ */
+class TreeWalker {
+public:
+    static constexpr uint8_t MAX_DEPTH = MICRO_SD_WALK_MAX_DEPTH > 0 ? MICRO_SD_WALK_MAX_DEPTH : 1;
+    static constexpr uint8_t SORT_BATCH = MICRO_SD_WALK_SORT_BATCH > 0 ? MICRO_SD_WALK_SORT_BATCH : 1;
+
+private:
+    static constexpr uint8_t NO_BATCH = 0xFF;
+
+    struct Level {
+        DIR dir;
+        uint16_t path_length;           // 本层目录路径的长度
+        bool has_last;                  // 已输出过子项 (其名字在路径缓冲区中)
+        bool last_is_directory;
+        // 本层目录自身的信息 (后序回调用)
+        WORD date;
+        WORD time;
+        BYTE attributes;
+        bool is_last;
+    };
+
+    struct Candidate {
+        FSIZE_t size;
+        WORD date;
+        WORD time;
+        BYTE attributes;
+        bool is_last;
+        char name[sizeof(FILINFO::fname)];
+    };
+
+    const RWSD& sd_;
+    Level levels_[MAX_DEPTH];
+    FILINFO entry_;
+    Candidate current_;
+    Candidate batch_[SORT_BATCH];       // 排序模式: 当前层下界之后最小的若干项，按顺序排列
+    uint8_t batch_count_;
+    uint8_t batch_next_;                // 下一个输出的候选项
+    uint8_t batch_depth_;               // 批缓冲区所属的层 (NO_BATCH为无效)
+    bool batch_complete_;               // 批缓冲区包含该层剩余的全部目录项
+    char path_[MICRO_SD_MAX_PATH];
+    uint8_t open_levels_;
+    uint8_t max_depth_;
+    WalkOptions options_;
+    WalkStats stats_;
+
+    bool accept(const FILINFO& entry) const;
+    FRESULT read_entry(DIR& dir, bool& end);
+    FRESULT next_unsorted(Level& level, bool& found);
+    FRESULT next_sorted(Level& level, uint8_t depth, bool& found);
+    FRESULT fill_batch(Level& level);
+    void close_levels();
+
+public:
+    explicit TreeWalker(const RWSD& sd);
+    ~TreeWalker() { close_levels(); }
+
+    TreeWalker(const TreeWalker&) = delete;
+    TreeWalker& operator=(const TreeWalker&) = delete;
+
+    /**
+     * @brief 遍历root下的所有目录项 (不含root本身)
+     * @return 统计；目录项的完整路径超过MICRO_SD_MAX_PATH时返回INVALID_PARAMETER
+     */
+    Result<WalkStats> walk(const std::string& root, WalkSink& sink, const WalkOptions& options = WalkOptions());
+
+    /**
+     * @brief 分步遍历: 打开root，之后用resume()逐步推进
+     */
+    Result<void> start(const std::string& root, const WalkOptions& options = WalkOptions());
+
+    /**
+     * @brief 继续遍历，最多报告max_entries个目录项 (0表示不限)
+     * 两次调用之间各层的DIR保持打开，可以穿插其他文件操作
+     * @return 遍历是否已结束 (包括接收器返回STOP)
+     */
+    Result<bool> resume(WalkSink& sink, size_t max_entries);
+
+    bool is_walking() const { return open_levels_ > 0; }
+    const WalkStats& get_stats() const { return stats_; }
+
+    /**
+     * @brief 放弃进行中的遍历
+     */
+    void cancel() { close_levels(); }
+};
+
+/**
+ * @brief 树形打印接收器 - 每个目录项格式化为一行，直接写到stdio、卡上的文件或字符串
+ */
+class TreePrinter : public WalkSink {
+private:
+    FILE* stream_;
+    RWSD::FileHandle* file_;
+    std::string* text_;
+    uint32_t last_mask_;                // 第n位: 第n层的当前项是所在目录的最后一项
+    ErrorCode error_;
+    char line_[MICRO_SD_MAX_PATH + 128];
+
+    void write_line(size_t length);
+    size_t format_prefix(uint8_t depth, bool is_last);
+
+public:
+    explicit TreePrinter(FILE* stream);
+    explicit TreePrinter(RWSD::FileHandle& file);
+    explicit TreePrinter(std::string& text);
+
+    WalkAction enter(const WalkEntry& entry) override;
+    void depth_limit(const WalkEntry& entry) override;
+
+    /**
+     * @brief 写入卡上文件时的第一个错误 (出错后遍历停止)
+     */
+    ErrorCode error() const { return error_; }
+};
+
+} // namespace MicroSD
@@ -0,0 +1,147 @@
+/**
+ * @file usage_cache.hpp
+ * @brief 目录占用缓存 - 保存目录的递归占用汇总，随写入和删除增量更新
+ * @version 1.0.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef MICRO_SD_USAGE_CACHE_ENTRIES
+#define MICRO_SD_USAGE_CACHE_ENTRIES 8      // 缓存的目录汇总数 (0禁用)
+#endif
+
+#ifndef MICRO_SD_USAGE_CACHE_PATH
+#define MICRO_SD_USAGE_CACHE_PATH 64        // 可缓存的规范化目录路径最大长度 (含结尾0)
+#endif
+
+namespace MicroSD {
+
+/**
+ * @brief 目录的递归占用 (不含目录表自身占用的簇)
+ */
+struct DirectoryUsage {
+    uint64_t bytes = 0;                 // 文件逻辑大小之和
+    uint64_t allocated_bytes = 0;       // 文件占用的簇的大小之和
+    uint32_t clusters = 0;              // 文件占用的簇数
+    uint32_t files = 0;
+    uint32_t directories = 0;           // 子目录数 (递归，不含自身)
+
+    /**
+     * @brief 簇内浪费: 已分配但未被文件内容使用的字节
+     */
+    uint64_t slack_bytes() const { return allocated_bytes - bytes; }
+
+    DirectoryUsage& operator+=(const DirectoryUsage& other) {
+        bytes += other.bytes;
+        allocated_bytes += other.allocated_bytes;
+        clusters += other.clusters;
+        files += other.files;
+        directories += other.directories;
+        return *this;
+    }
+
+    DirectoryUsage& operator-=(const DirectoryUsage& other) {
+        bytes -= other.bytes;
+        allocated_bytes -= other.allocated_bytes;
+        clusters -= other.clusters;
+        files -= other.files;
+        directories -= other.directories;
+        return *this;
+    }
+};
+
+/**
+ * @brief 目录占用缓存统计
+ */
+struct UsageCacheStats {
+    uint32_t hits = 0;                  // 直接使用缓存的汇总 (含遍历中跳过的子目录)
+    uint32_t misses = 0;
+    uint32_t updates = 0;               // 因写入/删除按变化量更新的汇总
+    uint32_t invalidations = 0;         // 因无法计算变化量而失效的汇总
+
+    float hit_rate() const {
+        uint32_t total = hits + misses;
+        return total > 0 ? (float)hits / total : 0.0f;
+    }
+};
+
+/**
+ * @brief 目录递归占用的LRU缓存
+ * 按规范化路径 (去掉开头、重复和结尾的'/'，比较时不区分大小写，根目录为空串) 保存
+ * 遍历得到的汇总。RWSD修改文件或空目录时，把修改前后的差值加到所有包含它的汇总上；
+ * 重命名目录、以写入方式打开文件等无法得到差值的修改使包含它的汇总失效
+ */
+class UsageCache {
+public:
+    static constexpr uint8_t CAPACITY = MICRO_SD_USAGE_CACHE_ENTRIES > 0 ? MICRO_SD_USAGE_CACHE_ENTRIES : 1;
+    static constexpr size_t MAX_PATH = MICRO_SD_USAGE_CACHE_PATH;
+
+private:
+    struct Entry {
+        DirectoryUsage usage;
+        uint32_t last_use;
+        bool valid;
+        uint16_t length;
+        char path[MAX_PATH];            // 规范化路径
+    };
+
+    Entry entries_[CAPACITY];
+    uint32_t clock_;
+    UsageCacheStats stats_;
+
+    /**
+     * @brief 规范化路径
+     * @return 规范化后的长度；根目录返回0，放不下时返回MAX_PATH
+     */
+    static size_t normalize(const char* path, char* out);
+
+    /**
+     * @brief entry是否为path本身或其上级目录
+     */
+    static bool contains(const Entry& entry, const char* normalized, size_t length);
+
+public:
+    UsageCache();
+
+    UsageCache(const UsageCache&) = delete;
+    UsageCache& operator=(const UsageCache&) = delete;
+
+    /**
+     * @brief 查找目录的汇总
+     * @return 是否命中
+     */
+    bool lookup(const char* path, DirectoryUsage& usage);
+
+    /**
+     * @brief 保存遍历得到的汇总
+     */
+    void insert(const char* path, const DirectoryUsage& usage);
+
+    /**
+     * @brief 是否有汇总包含path (修改path之前据此决定是否需要记录原来的占用)
+     */
+    bool covers(const char* path) const;
+
+    /**
+     * @brief path (文件或空目录) 的占用从before变为after，更新包含它的汇总
+     */
+    void adjust(const char* path, const DirectoryUsage& before, const DirectoryUsage& after);
+
+    /**
+     * @brief 使包含path的汇总以及path之下的汇总失效
+     */
+    void invalidate(const char* path);
+
+    /**
+     * @brief 使所有汇总失效 (格式化、卸载时)
+     */
+    void invalidate_all();
+
+    const UsageCacheStats& get_stats() const { return stats_; }
+    void reset_stats() { stats_ = UsageCacheStats(); }
+};
+
+} // namespace MicroSD
@@ -0,0 +1,178 @@
+/**
+ * @file dentry_cache.cpp
+ * @brief 目录项查找缓存实现
+ * @version 1.0.0
+ */
+
+#include "dentry_cache.hpp"
+#include <string.h>
+
+namespace MicroSD {
+
+namespace {
+
+inline char upper(char c) {
+    return (c >= 'a' && c <= 'z') ? c - 'a' + 'A' : c;
+}
+
+bool same_name(const char* a, const char* b, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        if (upper(a[i]) != upper(b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+DentryCache::DentryCache() : clock_(0) {
+    for (Entry& entry : entries_) {
+        entry.hash = 0;
+        entry.last_use = 0;
+        entry.valid = false;
+        entry.exists = false;
+        entry.length = 0;
+        entry.path[0] = '\0';
+    }
+}
+
+size_t DentryCache::normalize(const char* path, char* out, uint32_t& hash) {
+    hash = 2166136261u;
+    size_t length = 0;
+    for (const char* p = path; *p; ++p) {
+        if (*p == '/' && (length == 0 || out[length - 1] == '/')) {
+            continue;
+        }
+        if (length + 1 >= MAX_PATH) {
+            return MAX_PATH;
+        }
+        out[length++] = *p;
+    }
+    if (length > 0 && out[length - 1] == '/') {
+        --length;
+    }
+    out[length] = '\0';
+    for (size_t i = 0; i < length; ++i) {
+        hash = (hash ^ (uint8_t)upper(out[i])) * 16777619u;
+    }
+    return length;
+}
+
+DentryCache::Entry* DentryCache::find(const char* normalized, size_t length, uint32_t hash) {
+    for (Entry& entry : entries_) {
+        if (entry.valid && entry.hash == hash && entry.length == length &&
+            same_name(entry.path, normalized, length)) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+bool DentryCache::lookup(const char* path, bool& exists, DentryInfo* info, const char** name) {
+    char normalized[MAX_PATH];
+    uint32_t hash;
+    size_t length = normalize(path, normalized, hash);
+    Entry* entry = (length > 0 && length < MAX_PATH) ? find(normalized, length, hash) : nullptr;
+    if (entry == nullptr) {
+        ++stats_.misses;
+        return false;
+    }
+
+    entry->last_use = ++clock_;
+    ++stats_.hits;
+    exists = entry->exists;
+    if (!exists) {
+        ++stats_.negative_hits;
+        return true;
+    }
+    if (info) {
+        *info = entry->info;
+    }
+    if (name) {
+        const char* slash = strrchr(entry->path, '/');
+        *name = slash ? slash + 1 : entry->path;
+    }
+    return true;
+}
+
+void DentryCache::insert(const char* path, const FILINFO* fno) {
+    char normalized[MAX_PATH];
+    uint32_t hash;
+    size_t length = normalize(path, normalized, hash);
+    if (length == 0 || length >= MAX_PATH) {
+        return;
+    }
+
+    if (fno) {
+        // 最后一级换成卡上的名字 (大小写可能不同)；名字不一致时不缓存
+        size_t start = length;
+        while (start > 0 && normalized[start - 1] != '/') {
+            --start;
+        }
+        size_t name_length = strlen(fno->fname);
+        if (name_length != length - start || !same_name(fno->fname, normalized + start, name_length)) {
+            return;
+        }
+        memcpy(normalized + start, fno->fname, name_length);
+    }
+
+    Entry* entry = find(normalized, length, hash);
+    if (entry == nullptr) {
+        entry = &entries_[0];
+        for (Entry& candidate : entries_) {
+            if (!candidate.valid) {
+                entry = &candidate;
+                break;
+            }
+            if (candidate.last_use < entry->last_use) {
+                entry = &candidate;
+            }
+        }
+    }
+
+    entry->hash = hash;
+    entry->last_use = ++clock_;
+    entry->valid = true;
+    entry->exists = fno != nullptr;
+    entry->length = (uint16_t)length;
+    memcpy(entry->path, normalized, length + 1);
+    if (fno) {
+        entry->info.size = fno->fsize;
+        entry->info.date = fno->fdate;
+        entry->info.time = fno->ftime;
+        entry->info.attributes = fno->fattrib;
+    }
+}
+
+void DentryCache::invalidate(const char* path) {
+    char normalized[MAX_PATH];
+    uint32_t hash;
+    size_t length = normalize(path, normalized, hash);
+    if (length == 0) {
+        invalidate_all();
+        return;
+    }
+    if (length >= MAX_PATH) {
+        return;  // 缓存的路径都比它短，不可能是它本身或其下的路径
+    }
+
+    for (Entry& entry : entries_) {
+        if (entry.valid && entry.length >= length && same_name(entry.path, normalized, length) &&
+            (entry.path[length] == '\0' || entry.path[length] == '/')) {
+            entry.valid = false;
+            ++stats_.invalidations;
+        }
+    }
+}
+
+void DentryCache::invalidate_all() {
+    for (Entry& entry : entries_) {
+        if (entry.valid) {
+            entry.valid = false;
+            ++stats_.invalidations;
+        }
+    }
+}
+
+} // namespace MicroSD
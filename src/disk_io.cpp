@@ -0,0 +1,132 @@
+/**
+ * @file disk_io.cpp
+ * @brief FatFs磁盘I/O接口实现 - 将disk_*调用转发到已挂接的BlockDevice
+ * @version 1.0.0
+ */
+
+#include "block_device.hpp"
+#include "ff.h"
+#include "diskio.h"
+
+#if MICRO_SD_HOST
+#include <time.h>
+#endif
+
+namespace MicroSD {
+
+namespace {
+
+BlockDevice* g_block_devices[FF_VOLUMES] = {};
+
+BlockDevice* device_for(BYTE pdrv) {
+    return pdrv < FF_VOLUMES ? g_block_devices[pdrv] : nullptr;
+}
+
+} // namespace
+
+void attach_block_device(uint8_t pdrv, BlockDevice* device) {
+    if (pdrv < FF_VOLUMES) {
+        g_block_devices[pdrv] = device;
+    }
+}
+
+BlockDevice* attached_block_device(uint8_t pdrv) {
+    return device_for(pdrv);
+}
+
+} // namespace MicroSD
+
+using MicroSD::BlockDevice;
+using MicroSD::device_for;
+
+extern "C" {
+
+DSTATUS disk_initialize(BYTE pdrv) {
+    BlockDevice* device = device_for(pdrv);
+    if (device == nullptr) {
+        return STA_NOINIT | STA_NODISK;
+    }
+    if (!device->is_ready() && !device->initialize().is_ok()) {
+        return STA_NOINIT;
+    }
+    return 0;
+}
+
+DSTATUS disk_status(BYTE pdrv) {
+    BlockDevice* device = device_for(pdrv);
+    if (device == nullptr) {
+        return STA_NOINIT | STA_NODISK;
+    }
+    return device->is_ready() ? 0 : STA_NOINIT;
+}
+
+DRESULT disk_read(BYTE pdrv, BYTE* buff, LBA_t sector, UINT count) {
+    BlockDevice* device = device_for(pdrv);
+    if (device == nullptr || !device->is_ready()) {
+        return RES_NOTRDY;
+    }
+    if (count == 0) {
+        return RES_PARERR;
+    }
+    return device->read(sector, buff, count).is_ok() ? RES_OK : RES_ERROR;
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE* buff, LBA_t sector, UINT count) {
+    BlockDevice* device = device_for(pdrv);
+    if (device == nullptr || !device->is_ready()) {
+        return RES_NOTRDY;
+    }
+    if (count == 0) {
+        return RES_PARERR;
+    }
+    return device->write(sector, buff, count).is_ok() ? RES_OK : RES_ERROR;
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void* buff) {
+    BlockDevice* device = device_for(pdrv);
+    if (device == nullptr || !device->is_ready()) {
+        return RES_NOTRDY;
+    }
+
+    switch (cmd) {
+        case CTRL_SYNC:
+            return device->sync().is_ok() ? RES_OK : RES_ERROR;
+        case GET_SECTOR_COUNT:
+            *static_cast<LBA_t*>(buff) = device->geometry().sector_count;
+            return RES_OK;
+        case GET_SECTOR_SIZE:
+            *static_cast<WORD*>(buff) = device->geometry().sector_size;
+            return RES_OK;
+        case GET_BLOCK_SIZE:
+            *static_cast<DWORD*>(buff) = device->geometry().erase_block_sectors;
+            return RES_OK;
+        case CTRL_TRIM: {
+            const LBA_t* range = static_cast<const LBA_t*>(buff);
+            if (range[1] < range[0]) {
+                return RES_PARERR;
+            }
+            return device->trim(range[0], range[1] - range[0] + 1).is_ok() ? RES_OK : RES_ERROR;
+        }
+        default:
+            return RES_PARERR;
+    }
+}
+
+DWORD get_fattime(void) {
+#if MICRO_SD_HOST
+    time_t now = time(nullptr);
+    struct tm local;
+    localtime_r(&now, &local);
+    return ((DWORD)(local.tm_year - 80) << 25) |
+           ((DWORD)(local.tm_mon + 1) << 21) |
+           ((DWORD)local.tm_mday << 16) |
+           ((DWORD)local.tm_hour << 11) |
+           ((DWORD)local.tm_min << 5) |
+           ((DWORD)local.tm_sec >> 1);
+#else
+    // 无RTC时使用固定时间戳: 2024-01-01 00:00:00
+    return ((DWORD)(2024 - 1980) << 25) | ((DWORD)1 << 21) | ((DWORD)1 << 16);
+#endif
+}
+
+} // extern "C"
@@ -0,0 +1,235 @@
+/**
+ * @file free_cluster_map.cpp
+ * @brief 空闲簇索引实现
+ * @version 1.0.0
+ */
+
+#include "free_cluster_map.hpp"
+#include "ff.h"
+#include <string.h>
+#include <algorithm>
+
+namespace MicroSD {
+
+namespace {
+
+constexpr uint32_t SCAN_BATCH_SECTORS = 4;  // 扫描时每次读取的扇区数 (多块读取)
+
+} // namespace
+
+FreeClusterMap::FreeClusterMap(BlockDevice& device, size_t ram_budget, std::pmr::memory_resource* memory)
+    : device_(&device), ram_budget_(ram_budget), group_free_(memory), scan_buffer_(memory), fat_first_(0), fat_sectors_(0),
+      cluster_count_(0), entries_per_sector_(0), sectors_per_group_(1), scanned_sectors_(0),
+      free_clusters_(0), entry_size_(0), tracking_(false) {}
+
+void FreeClusterMap::deinitialize() {
+    detach();
+    device_->deinitialize();
+}
+
+// === 卷跟踪 ===
+
+bool FreeClusterMap::attach(uint8_t fs_type, uint32_t fat_first, uint32_t fat_sectors, uint32_t cluster_count) {
+    detach();
+    if (fs_type == FS_FAT16) {
+        entry_size_ = 2;
+    } else if (fs_type == FS_FAT32) {
+        entry_size_ = 4;
+    } else {
+        return false;
+    }
+
+    fat_first_ = fat_first;
+    fat_sectors_ = fat_sectors;
+    cluster_count_ = cluster_count;
+    entries_per_sector_ = SECTOR_SIZE / entry_size_;
+
+    // 按RAM预算确定分组粒度
+    uint32_t max_groups = std::max<size_t>(ram_budget_ / sizeof(uint32_t), 1);
+    sectors_per_group_ = (fat_sectors_ + max_groups - 1) / max_groups;
+    if (sectors_per_group_ == 0) {
+        sectors_per_group_ = 1;
+    }
+    group_free_.assign((fat_sectors_ + sectors_per_group_ - 1) / sectors_per_group_, 0);
+    group_free_.shrink_to_fit();
+
+    scanned_sectors_ = 0;
+    free_clusters_ = 0;
+    tracking_ = true;
+    return true;
+}
+
+void FreeClusterMap::detach() {
+    tracking_ = false;
+    group_free_.clear();
+    group_free_.shrink_to_fit();
+    scan_buffer_.clear();
+    scan_buffer_.shrink_to_fit();
+    scanned_sectors_ = 0;
+    free_clusters_ = 0;
+}
+
+Result<bool> FreeClusterMap::scan(uint32_t max_sectors) {
+    if (!tracking_) {
+        return Result<bool>(ErrorCode::INIT_FAILED);
+    }
+
+    std::pmr::vector<uint8_t>& buffer = scan_buffer_;
+    buffer.resize(SCAN_BATCH_SECTORS * SECTOR_SIZE);
+    uint64_t processed = 0;
+    while (scanned_sectors_ < fat_sectors_) {
+        // 以组为单位推进，写入增量只作用于已完整扫描的组
+        uint32_t group = scanned_sectors_ / sectors_per_group_;
+        uint32_t group_end = std::min(scanned_sectors_ + sectors_per_group_, fat_sectors_);
+        uint32_t group_sectors = group_end - scanned_sectors_;
+        if (processed > 0 && processed + group_sectors > max_sectors) {
+            break;
+        }
+
+        uint32_t free_count = 0;
+        for (uint32_t index = scanned_sectors_; index < group_end; index += SCAN_BATCH_SECTORS) {
+            uint32_t batch = std::min(SCAN_BATCH_SECTORS, group_end - index);
+            auto result = device_->read(fat_first_ + index, buffer.data(), batch);
+            if (!result.is_ok()) {
+                return Result<bool>(result.error_code());
+            }
+            for (uint32_t i = 0; i < batch; ++i) {
+                free_count += count_free(index + i, &buffer[(size_t)i * SECTOR_SIZE]);
+            }
+        }
+
+        group_free_[group] = free_count;
+        free_clusters_ += free_count;
+        scanned_sectors_ = group_end;
+        processed += group_sectors;
+    }
+    return Result<bool>(is_complete());
+}
+
+// === 计数 ===
+
+uint32_t FreeClusterMap::count_free(uint32_t fat_index, const uint8_t* data) const {
+    uint32_t first = fat_index * entries_per_sector_;
+    uint32_t begin = first < 2 ? 2 - first : 0;
+    uint32_t end = entries_per_sector_;
+    if (first + end > cluster_count_) {
+        end = cluster_count_ > first ? cluster_count_ - first : 0;
+    }
+
+    uint32_t count = 0;
+    if (entry_size_ == 4) {
+        for (uint32_t i = begin; i < end; ++i) {
+            const uint8_t* p = data + i * 4;
+            if (p[0] == 0 && p[1] == 0 && p[2] == 0 && (p[3] & 0x0F) == 0) {
+                ++count;
+            }
+        }
+    } else {
+        for (uint32_t i = begin; i < end; ++i) {
+            if (data[i * 2] == 0 && data[i * 2 + 1] == 0) {
+                ++count;
+            }
+        }
+    }
+    return count;
+}
+
+uint32_t FreeClusterMap::group_first_cluster(uint32_t group) const {
+    return std::max<uint32_t>(group * sectors_per_group_ * entries_per_sector_, 2);
+}
+
+uint32_t FreeClusterMap::group_capacity(uint32_t group) const {
+    uint32_t first = group_first_cluster(group);
+    uint32_t end = std::min<uint32_t>((group + 1) * sectors_per_group_ * entries_per_sector_, cluster_count_);
+    return end > first ? end - first : 0;
+}
+
+// === 块设备接口 ===
+
+Result<void> FreeClusterMap::read(uint32_t sector, uint8_t* buffer, uint32_t count) {
+    return device_->read(sector, buffer, count);
+}
+
+Result<void> FreeClusterMap::write(uint32_t sector, const uint8_t* buffer, uint32_t count) {
+    if (tracking_ && sector < fat_first_ + fat_sectors_ && sector + count > fat_first_) {
+        auto result = update_from_write(sector, buffer, count);
+        if (!result.is_ok()) {
+            // 无法读取旧内容时放弃索引，回退到FatFs自身的统计
+            detach();
+        }
+    }
+    return device_->write(sector, buffer, count);
+}
+
+Result<void> FreeClusterMap::update_from_write(uint32_t sector, const uint8_t* buffer, uint32_t count) {
+    uint8_t old_data[SECTOR_SIZE];
+    uint32_t first = std::max(sector, fat_first_);
+    uint32_t last = std::min(sector + count, fat_first_ + fat_sectors_);
+
+    for (uint32_t s = first; s < last; ++s) {
+        uint32_t index = s - fat_first_;
+        if (index >= scanned_sectors_) {
+            break;  // 尚未扫描的组在扫描时按最新内容计数
+        }
+
+        const uint8_t* new_data = buffer + (size_t)(s - sector) * SECTOR_SIZE;
+        auto result = device_->read(s, old_data, 1);
+        if (!result.is_ok()) {
+            return result;
+        }
+
+        uint32_t before = count_free(index, old_data);
+        uint32_t after = count_free(index, new_data);
+        group_free_[index / sectors_per_group_] += after - before;
+        free_clusters_ += after - before;
+    }
+    return Result<void>();
+}
+
+// === 空闲区定位 ===
+
+uint32_t FreeClusterMap::find_free(uint32_t from) const {
+    if (!tracking_ || entries_per_sector_ == 0) {
+        return 0;
+    }
+    from = std::max<uint32_t>(from, 2);
+    uint32_t scanned_groups = (scanned_sectors_ + sectors_per_group_ - 1) / sectors_per_group_;
+    uint32_t group = from / (sectors_per_group_ * entries_per_sector_);
+
+    for (; group < group_free_.size(); ++group) {
+        if (group >= scanned_groups) {
+            // 未扫描的区域状态未知，交给FatFs自行查找
+            return std::max(from, group_first_cluster(group));
+        }
+        if (group_free_[group] > 0) {
+            return std::max(from, group_first_cluster(group));
+        }
+    }
+    return 0;
+}
+
+uint32_t FreeClusterMap::find_free_run(uint32_t clusters) const {
+    if (!is_complete() || clusters == 0) {
+        return 0;
+    }
+
+    uint32_t run_start = 0;
+    uint32_t run_length = 0;
+    for (uint32_t group = 0; group < group_free_.size(); ++group) {
+        uint32_t capacity = group_capacity(group);
+        if (capacity > 0 && group_free_[group] == capacity) {
+            if (run_length == 0) {
+                run_start = group_first_cluster(group);
+            }
+            run_length += capacity;
+            if (run_length >= clusters) {
+                return run_start;
+            }
+        } else {
+            run_length = 0;
+        }
+    }
+    return 0;
+}
+
+} // namespace MicroSD
@@ -0,0 +1,110 @@
+/**
+ * @file image_block_device.cpp
+ * @brief 磁盘镜像文件块设备实现
+ * @version 1.0.0
+ */
+
+#include "image_block_device.hpp"
+#include <sys/types.h>
+#include <sstream>
+
+namespace MicroSD {
+
+ImageBlockDevice::ImageBlockDevice(std::string path, uint32_t create_sectors)
+    : path_(std::move(path)), create_sectors_(create_sectors), file_(nullptr) {}
+
+ImageBlockDevice::~ImageBlockDevice() {
+    deinitialize();
+}
+
+Result<void> ImageBlockDevice::initialize() {
+    if (file_ != nullptr) {
+        return Result<void>();
+    }
+
+    file_ = fopen(path_.c_str(), "r+b");
+    if (file_ == nullptr && create_sectors_ > 0) {
+        file_ = fopen(path_.c_str(), "w+b");
+        if (file_ != nullptr) {
+            // 扩展到目标大小 (稀疏文件)
+            off_t last_byte = (off_t)create_sectors_ * SECTOR_SIZE - 1;
+            if (fseeko(file_, last_byte, SEEK_SET) != 0 || fputc(0, file_) == EOF) {
+                deinitialize();
+                return Result<void>(ErrorCode::IO_ERROR);
+            }
+        }
+    }
+    if (file_ == nullptr) {
+        return Result<void>(ErrorCode::INIT_FAILED);
+    }
+
+    if (fseeko(file_, 0, SEEK_END) != 0) {
+        deinitialize();
+        return Result<void>(ErrorCode::IO_ERROR);
+    }
+    off_t size = ftello(file_);
+    geometry_.sector_count = static_cast<uint32_t>(size / SECTOR_SIZE);
+    geometry_.sector_size = SECTOR_SIZE;
+    geometry_.erase_block_sectors = 1;
+
+    if (geometry_.sector_count == 0) {
+        deinitialize();
+        return Result<void>(ErrorCode::INIT_FAILED);
+    }
+    return Result<void>();
+}
+
+void ImageBlockDevice::deinitialize() {
+    if (file_ != nullptr) {
+        fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+Result<void> ImageBlockDevice::read(uint32_t sector, uint8_t* buffer, uint32_t count) {
+    if (file_ == nullptr) {
+        return Result<void>(ErrorCode::INIT_FAILED);
+    }
+    if ((uint64_t)sector + count > geometry_.sector_count) {
+        return Result<void>(ErrorCode::INVALID_PARAMETER);
+    }
+
+    if (fseeko(file_, (off_t)sector * SECTOR_SIZE, SEEK_SET) != 0 ||
+        fread(buffer, SECTOR_SIZE, count, file_) != count) {
+        return Result<void>(ErrorCode::IO_ERROR);
+    }
+    return Result<void>();
+}
+
+Result<void> ImageBlockDevice::write(uint32_t sector, const uint8_t* buffer, uint32_t count) {
+    if (file_ == nullptr) {
+        return Result<void>(ErrorCode::INIT_FAILED);
+    }
+    if ((uint64_t)sector + count > geometry_.sector_count) {
+        return Result<void>(ErrorCode::INVALID_PARAMETER);
+    }
+
+    if (fseeko(file_, (off_t)sector * SECTOR_SIZE, SEEK_SET) != 0 ||
+        fwrite(buffer, SECTOR_SIZE, count, file_) != count) {
+        return Result<void>(ErrorCode::IO_ERROR);
+    }
+    return Result<void>();
+}
+
+Result<void> ImageBlockDevice::sync() {
+    if (file_ == nullptr) {
+        return Result<void>(ErrorCode::INIT_FAILED);
+    }
+    return fflush(file_) == 0 ? Result<void>() : Result<void>(ErrorCode::IO_ERROR);
+}
+
+std::string ImageBlockDevice::get_config_info() const {
+    std::ostringstream oss;
+    oss << "=== 镜像设备配置信息 ===\n";
+    oss << "镜像文件: " << path_ << "\n";
+    oss << "扇区数: " << geometry_.sector_count << "\n";
+    oss << "容量: " << ((uint64_t)geometry_.sector_count * SECTOR_SIZE / 1024 / 1024) << " MB\n";
+    return oss.str();
+}
+
+} // namespace MicroSD
@@ -0,0 +1,692 @@
+/**
+ * @file kv_store.cpp
+ * @brief 日志结构键值存储实现
+ * @version 1.0.0
+ */
+
+#include "kv_store.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <algorithm>
+
+namespace MicroSD {
+
+namespace {
+
+constexpr size_t HEADER_SIZE = 12;
+constexpr uint8_t MAGIC_0 = 'K';
+constexpr uint8_t MAGIC_1 = 'V';
+constexpr uint8_t FLAG_TOMBSTONE = 0x01;
+
+constexpr uint8_t EMPTY = 0;
+constexpr uint8_t USED = 1;
+constexpr uint8_t DELETED = 2;
+
+constexpr uint8_t NO_SLOT = 0xFF;
+constexpr size_t NOT_FOUND = static_cast<size_t>(-1);
+
+uint32_t fnv1a(const void* data, size_t size, uint32_t hash = 2166136261u) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+uint32_t load_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void store_u32(uint8_t* p, uint32_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+// 校验覆盖标志、长度、键和值
+uint32_t record_checksum(const uint8_t* header, const void* key, size_t key_size, const void* value, size_t value_size) {
+    return fnv1a(value, value_size, fnv1a(key, key_size, fnv1a(header + 2, 6)));
+}
+
+void encode_header(uint8_t* header, uint8_t flags, std::string_view key, const void* value, size_t value_size) {
+    header[0] = MAGIC_0;
+    header[1] = MAGIC_1;
+    header[2] = flags;
+    header[3] = static_cast<uint8_t>(key.size());
+    store_u32(header + 4, static_cast<uint32_t>(value_size));
+    store_u32(header + 8, record_checksum(header, key.data(), key.size(), value, value_size));
+}
+
+} // namespace
+
+KvStore::KvStore(RWSD& sd, const KvConfig& config)
+    : sd_(sd), config_(config),
+      index_(sd.get_memory_resource() ? sd.get_memory_resource() : std::pmr::null_memory_resource()),
+      record_(sd.get_memory_resource() ? sd.get_memory_resource() : std::pmr::null_memory_resource()),
+      active_slot_(NO_SLOT), next_id_(1), used_(0), deleted_(0), open_(false),
+      compacting_(false), compact_slot_(NO_SLOT), compact_id_(0), compact_cursor_(0) {
+    size_t length = config.directory ? strlen(config.directory) : MICRO_SD_MAX_PATH;
+    // 目录名之后还要追加"/xxxxxxxx.kvs"
+    if (length + 14 < MICRO_SD_MAX_PATH) {
+        memcpy(directory_, config.directory, length + 1);
+    } else {
+        directory_[0] = '\0';
+    }
+    config_.directory = directory_;
+    memset(segments_, 0, sizeof(segments_));
+}
+
+void KvStore::segment_path(uint8_t slot, char* path, size_t size) const {
+    snprintf(path, size, "%s/%08lu.kvs", directory_, (unsigned long)segments_[slot].id);
+}
+
+uint8_t KvStore::free_slots() const {
+    uint8_t count = 0;
+    for (const Segment& segment : segments_) {
+        count += segment.id == 0;
+    }
+    return count;
+}
+
+Result<uint8_t> KvStore::create_segment(RWSD::FileHandle& handle) {
+    for (uint8_t slot = 0; slot < MAX_SEGMENTS; ++slot) {
+        if (segments_[slot].id != 0) {
+            continue;
+        }
+        segments_[slot] = Segment{next_id_++, 0, 0};
+        char path[MICRO_SD_MAX_PATH];
+        segment_path(slot, path, sizeof(path));
+        auto opened = sd_.open_file(path, "w+");
+        if (!opened.is_ok()) {
+            segments_[slot].id = 0;
+            return Result<uint8_t>(opened.error_code());
+        }
+        handle = std::move(*opened);
+        return Result<uint8_t>(slot);
+    }
+    return Result<uint8_t>(ErrorCode::DISK_FULL, "段文件数已达上限");
+}
+
+RWSD::FileHandle* KvStore::handle_for(uint8_t slot) {
+    if (slot == active_slot_) {
+        return &active_;
+    }
+    if (compacting_ && slot == compact_slot_) {
+        return &compact_file_;
+    }
+    return nullptr;
+}
+
+Result<void> KvStore::read_at(uint8_t slot, uint32_t offset, void* buffer, size_t size) {
+    // 正在写入的段经过其句柄读取 (FIL缓冲区中可能有未写出的数据)，封存段经过只读句柄缓存
+    Result<size_t> result(ErrorCode::IO_ERROR);
+    RWSD::FileHandle* handle = handle_for(slot);
+    if (handle != nullptr) {
+        auto seek = handle->seek(offset);
+        if (!seek.is_ok()) {
+            return seek;
+        }
+        result = handle->read_into(buffer, size);
+    } else {
+        char path[MICRO_SD_MAX_PATH];
+        segment_path(slot, path, sizeof(path));
+        result = sd_.read_file_into(path, buffer, size, offset);
+    }
+    if (!result.is_ok()) {
+        return Result<void>(result.error_code());
+    }
+    return *result == size ? Result<void>() : Result<void>(ErrorCode::IO_ERROR, "记录不完整");
+}
+
+Result<void> KvStore::open() {
+    if (open_) {
+        return Result<void>();
+    }
+    if (directory_[0] == '\0' || config_.max_keys == 0 ||
+        HEADER_SIZE + MAX_KEY_SIZE + config_.max_value_size > UINT16_MAX) {
+        return Result<void>(ErrorCode::INVALID_PARAMETER);
+    }
+    if (sd_.get_memory_resource() == nullptr) {
+        return Result<void>(ErrorCode::INVALID_PARAMETER, "未设置内存资源");
+    }
+
+    // 装载率不超过1/2
+    size_t capacity = 16;
+    while (capacity < config_.max_keys * 2) {
+        capacity <<= 1;
+    }
+    index_.assign(capacity, Entry{0, 0, 0, 0, EMPTY});
+    record_.resize(HEADER_SIZE + MAX_KEY_SIZE + config_.max_value_size);
+    memset(segments_, 0, sizeof(segments_));
+    used_ = 0;
+    deleted_ = 0;
+    next_id_ = 1;
+    stats_ = KvStats();
+
+    if (!sd_.file_exists(directory_)) {
+        auto created = sd_.create_directory(directory_);
+        if (!created.is_ok()) {
+            return created;
+        }
+    }
+
+    // 收集段文件 (xxxxxxxx.kvs)
+    auto listing = sd_.list_directory(directory_);
+    if (!listing.is_ok()) {
+        return Result<void>(listing.error_code());
+    }
+    uint32_t sizes[MAX_SEGMENTS] = {};
+    uint8_t count = 0;
+    for (const FileInfo& info : *listing) {
+        char* end = nullptr;
+        unsigned long id = strtoul(info.name.c_str(), &end, 10);
+        if (info.is_directory || id == 0 || end == info.name.c_str() || strcasecmp(end, ".kvs") != 0) {
+            continue;
+        }
+        if (count == MAX_SEGMENTS) {
+            return Result<void>(ErrorCode::INVALID_PARAMETER, "段文件数超过上限");
+        }
+        segments_[count] = Segment{static_cast<uint32_t>(id), 0, 0};
+        sizes[count] = static_cast<uint32_t>(info.size);
+        next_id_ = std::max<uint32_t>(next_id_, id + 1);
+        ++count;
+    }
+
+    // 按编号从旧到新重放，最新的段继续作为活动段
+    uint8_t order[MAX_SEGMENTS];
+    for (uint8_t i = 0; i < count; ++i) {
+        order[i] = i;
+    }
+    std::sort(order, order + count, [this](uint8_t a, uint8_t b) { return segments_[a].id < segments_[b].id; });
+    for (uint8_t i = 0; i < count; ++i) {
+        auto scanned = scan_segment(order[i], sizes[order[i]], i + 1 == count);
+        if (!scanned.is_ok()) {
+            active_.close();
+            active_slot_ = NO_SLOT;
+            return scanned;
+        }
+    }
+    if (count == 0) {
+        auto created = create_segment(active_);
+        if (!created.is_ok()) {
+            return Result<void>(created.error_code());
+        }
+        active_slot_ = *created;
+    }
+
+    open_ = true;
+    return Result<void>();
+}
+
+Result<void> KvStore::scan_segment(uint8_t slot, uint32_t size, bool active) {
+    if (active) {
+        char path[MICRO_SD_MAX_PATH];
+        segment_path(slot, path, sizeof(path));
+        auto opened = sd_.open_file(path, "r+");
+        if (!opened.is_ok()) {
+            return Result<void>(opened.error_code());
+        }
+        active_ = std::move(*opened);
+        active_slot_ = slot;
+    }
+
+    uint8_t* header = record_.data();
+    uint32_t offset = 0;
+    while (offset + HEADER_SIZE <= size) {
+        auto result = read_at(slot, offset, header, HEADER_SIZE);
+        if (!result.is_ok()) {
+            return result;
+        }
+        uint8_t key_size = header[3];
+        uint32_t value_size = load_u32(header + 4);
+        uint32_t record_size = HEADER_SIZE + key_size + value_size;
+        if (header[0] != MAGIC_0 || header[1] != MAGIC_1 || key_size == 0 ||
+            (uint64_t)offset + HEADER_SIZE + key_size + value_size > size) {
+            break;
+        }
+        if (value_size > config_.max_value_size) {
+            // 完整的记录超出本配置的上限 (由更大的max_value_size写入): 不是掉电残留，不能截断
+            return Result<void>(ErrorCode::INVALID_PARAMETER, "记录超过max_value_size");
+        }
+        uint8_t* key = header + HEADER_SIZE;
+        result = read_at(slot, offset + HEADER_SIZE, key, key_size + value_size);
+        if (!result.is_ok()) {
+            return result;
+        }
+        if (load_u32(header + 8) != record_checksum(header, key, key_size, key + key_size, value_size)) {
+            break;
+        }
+
+        std::string_view key_view(reinterpret_cast<const char*>(key), key_size);
+        uint32_t hash = fnv1a(key_view.data(), key_view.size());
+        auto position = find(key_view, hash);
+        if (!position.is_ok()) {
+            return Result<void>(position.error_code());
+        }
+        result = update(*position, hash, header[2], slot, offset, record_size);
+        if (!result.is_ok()) {
+            return result;
+        }
+        offset += record_size;
+        ++stats_.recovered_records;
+    }
+
+    // 校验失败处之后是掉电时未写完的记录: 活动段截断，封存段的尾部留给压缩回收
+    segments_[slot].size = active ? offset : size;
+    if (active && offset < size) {
+        stats_.truncated_bytes += size - offset;
+        return active_.truncate(offset);
+    }
+    return Result<void>();
+}
+
+Result<size_t> KvStore::find(std::string_view key, uint32_t hash) {
+    size_t mask = index_.size() - 1;
+    uint8_t header[HEADER_SIZE];
+    char stored_key[MAX_KEY_SIZE];
+    for (size_t i = hash & mask, probes = 0; probes < index_.size(); i = (i + 1) & mask, ++probes) {
+        const Entry& entry = index_[i];
+        if (entry.state == EMPTY) {
+            break;
+        }
+        if (entry.state != USED || entry.hash != hash) {
+            continue;
+        }
+        // 哈希相同: 读取卡上的键确认
+        auto result = read_at(entry.segment, entry.offset, header, HEADER_SIZE);
+        if (result.is_ok() && header[3] == key.size()) {
+            result = read_at(entry.segment, entry.offset + HEADER_SIZE, stored_key, key.size());
+            if (result.is_ok() && memcmp(stored_key, key.data(), key.size()) == 0) {
+                return Result<size_t>(i);
+            }
+        }
+        if (!result.is_ok()) {
+            return Result<size_t>(result.error_code());
+        }
+    }
+    return Result<size_t>(NOT_FOUND);
+}
+
+Result<void> KvStore::update(size_t position, uint32_t hash, uint8_t flags, uint8_t slot,
+                             uint32_t offset, uint16_t size) {
+    bool tombstone = (flags & FLAG_TOMBSTONE) != 0;
+    if (position != NOT_FOUND) {
+        Entry& entry = index_[position];
+        segments_[entry.segment].live -= entry.size;
+        if (tombstone) {
+            entry.state = DELETED;
+            --used_;
+            ++deleted_;
+        } else {
+            entry.segment = slot;
+            entry.offset = offset;
+            entry.size = size;
+            segments_[slot].live += size;
+        }
+        return Result<void>();
+    }
+    if (tombstone) {
+        return Result<void>();
+    }
+    if (used_ >= config_.max_keys) {
+        return Result<void>(ErrorCode::DISK_FULL, "键数已达上限");
+    }
+
+    // 删除标记过多时重建索引，保证探测总能遇到空位
+    if ((used_ + deleted_ + 1) * 4 > index_.size() * 3) {
+        if (compacting_) {
+            auto result = compact();   // 压缩完成时重建索引
+            if (!result.is_ok()) {
+                return result;
+            }
+        } else {
+            rebuild_index();
+        }
+    }
+
+    size_t mask = index_.size() - 1;
+    size_t i = hash & mask;
+    while (index_[i].state == USED) {
+        i = (i + 1) & mask;
+    }
+    if (index_[i].state == DELETED) {
+        --deleted_;
+    }
+    index_[i] = Entry{hash, offset, size, slot, USED};
+    ++used_;
+    segments_[slot].live += size;
+    return Result<void>();
+}
+
+void KvStore::rebuild_index() {
+    std::pmr::vector<Entry> old(std::move(index_));
+    index_.assign(old.size(), Entry{0, 0, 0, 0, EMPTY});
+    size_t mask = index_.size() - 1;
+    for (const Entry& entry : old) {
+        if (entry.state != USED) {
+            continue;
+        }
+        size_t i = entry.hash & mask;
+        while (index_[i].state != EMPTY) {
+            i = (i + 1) & mask;
+        }
+        index_[i] = entry;
+    }
+    deleted_ = 0;
+}
+
+Result<void> KvStore::roll_segment() {
+    // 段表将满时改为压缩: 压缩会切换到新的活动段，且需要两个空闲槽位
+    if (!compacting_ && free_slots() < 3) {
+        return compact();
+    }
+    if (compacting_ && free_slots() < 1) {
+        auto result = compact();
+        if (!result.is_ok()) {
+            return result;
+        }
+    }
+
+    auto flushed = active_.flush();
+    if (!flushed.is_ok()) {
+        return flushed;
+    }
+    active_.close();
+    active_slot_ = NO_SLOT;
+    auto created = create_segment(active_);
+    if (!created.is_ok()) {
+        return Result<void>(created.error_code());
+    }
+    active_slot_ = *created;
+    return Result<void>();
+}
+
+Result<void> KvStore::write_record(uint8_t flags, std::string_view key, const void* value, size_t size) {
+    if (!open_ || active_slot_ == NO_SLOT) {
+        return Result<void>(ErrorCode::INIT_FAILED);
+    }
+    if (key.empty() || key.size() > MAX_KEY_SIZE || size > config_.max_value_size || (value == nullptr && size > 0)) {
+        return Result<void>(ErrorCode::INVALID_PARAMETER);
+    }
+
+    uint16_t record_size = static_cast<uint16_t>(HEADER_SIZE + key.size() + size);
+    Segment& current = segments_[active_slot_];
+    if (current.size > 0 && current.size + record_size > config_.segment_bytes) {
+        auto rolled = roll_segment();
+        if (!rolled.is_ok()) {
+            return rolled;
+        }
+    }
+
+    uint32_t hash = fnv1a(key.data(), key.size());
+    auto position = find(key, hash);
+    if (!position.is_ok()) {
+        return Result<void>(position.error_code());
+    }
+    bool tombstone = (flags & FLAG_TOMBSTONE) != 0;
+    if (*position == NOT_FOUND) {
+        if (tombstone) {
+            return Result<void>(ErrorCode::FILE_NOT_FOUND);
+        }
+        if (used_ >= config_.max_keys) {
+            return Result<void>(ErrorCode::DISK_FULL, "键数已达上限");
+        }
+    }
+
+    // 追加到活动段末尾 (读取可能移动了读写位置)
+    uint8_t header[HEADER_SIZE];
+    encode_header(header, flags, key, value, size);
+    uint32_t offset = segments_[active_slot_].size;
+    auto result = active_.seek(offset);
+    if (!result.is_ok()) {
+        return result;
+    }
+    for (auto [data, length] : {std::pair<const void*, size_t>(header, HEADER_SIZE),
+                                std::pair<const void*, size_t>(key.data(), key.size()),
+                                std::pair<const void*, size_t>(value, size)}) {
+        auto written = active_.write(data, length);
+        if (!written.is_ok()) {
+            return Result<void>(written.error_code());
+        }
+        if (*written < length) {
+            return Result<void>(ErrorCode::DISK_FULL);
+        }
+    }
+    segments_[active_slot_].size += record_size;
+
+    result = update(*position, hash, flags, active_slot_, offset, record_size);
+    if (!result.is_ok()) {
+        return result;
+    }
+    return config_.sync_on_write ? active_.flush() : Result<void>();
+}
+
+Result<void> KvStore::put(std::string_view key, const void* value, size_t size) {
+    return write_record(0, key, value, size);
+}
+
+Result<void> KvStore::put(std::string_view key, std::string_view value) {
+    return write_record(0, key, value.data(), value.size());
+}
+
+Result<void> KvStore::remove(std::string_view key) {
+    return write_record(FLAG_TOMBSTONE, key, nullptr, 0);
+}
+
+Result<size_t> KvStore::get(std::string_view key, void* buffer, size_t capacity) {
+    if (!open_) {
+        return Result<size_t>(ErrorCode::INIT_FAILED);
+    }
+    auto position = find(key, fnv1a(key.data(), key.size()));
+    if (!position.is_ok()) {
+        return position;
+    }
+    if (*position == NOT_FOUND) {
+        return Result<size_t>(ErrorCode::FILE_NOT_FOUND);
+    }
+
+    const Entry& entry = index_[*position];
+    size_t value_size = entry.size - HEADER_SIZE - key.size();
+    if (value_size > capacity || (buffer == nullptr && value_size > 0)) {
+        return Result<size_t>(ErrorCode::INVALID_PARAMETER, "缓冲区不足");
+    }
+    auto result = read_at(entry.segment, entry.offset + HEADER_SIZE + key.size(), buffer, value_size);
+    if (!result.is_ok()) {
+        return Result<size_t>(result.error_code());
+    }
+    return Result<size_t>(value_size);
+}
+
+bool KvStore::contains(std::string_view key) {
+    if (!open_) {
+        return false;
+    }
+    auto position = find(key, fnv1a(key.data(), key.size()));
+    return position.is_ok() && *position != NOT_FOUND;
+}
+
+Result<void> KvStore::sync() {
+    if (!open_) {
+        return Result<void>();
+    }
+    if (compacting_) {
+        auto result = compact_file_.flush();
+        if (!result.is_ok()) {
+            return result;
+        }
+    }
+    return active_.flush();
+}
+
+bool KvStore::needs_compaction() const {
+    if (!open_ || compacting_) {
+        return false;
+    }
+    uint64_t live = 0;
+    uint64_t total = 0;
+    for (const Segment& segment : segments_) {
+        if (segment.id != 0) {
+            live += segment.live;
+            total += segment.size;
+        }
+    }
+    uint64_t dead = total - live;
+    return (dead > live && dead >= config_.segment_bytes) || free_slots() < 4;
+}
+
+Result<bool> KvStore::compact_step(size_t max_records) {
+    if (!open_) {
+        return Result<bool>(ErrorCode::INIT_FAILED);
+    }
+
+    if (!compacting_) {
+        if (free_slots() < 2) {
+            return Result<bool>(ErrorCode::DISK_FULL, "段文件数已达上限");
+        }
+        // 封存活动段；输出段编号小于新的活动段，重放时压缩结果不会覆盖之后的写入
+        auto flushed = active_.flush();
+        if (!flushed.is_ok()) {
+            return Result<bool>(flushed.error_code());
+        }
+        active_.close();
+        active_slot_ = NO_SLOT;
+        auto output = create_segment(compact_file_);
+        if (!output.is_ok()) {
+            return Result<bool>(output.error_code());
+        }
+        compact_slot_ = *output;
+        compact_id_ = segments_[compact_slot_].id;
+        compacting_ = true;
+        compact_cursor_ = 0;
+        auto active = create_segment(active_);
+        if (!active.is_ok()) {
+            return Result<bool>(active.error_code());
+        }
+        active_slot_ = *active;
+    }
+
+    // 复制仍指向旧段的记录；压缩期间的写入进入活动段 (编号更大)，不需要复制
+    size_t copied = 0;
+    while (compact_cursor_ < index_.size() && copied < max_records) {
+        Entry& entry = index_[compact_cursor_];
+        if (entry.state != USED || segments_[entry.segment].id >= compact_id_) {
+            ++compact_cursor_;
+            continue;
+        }
+        auto result = read_at(entry.segment, entry.offset, record_.data(), entry.size);
+        Segment& output = segments_[compact_slot_];
+        if (result.is_ok()) {
+            result = compact_file_.seek(output.size);
+        }
+        if (!result.is_ok()) {
+            return Result<bool>(result.error_code());
+        }
+        auto written = compact_file_.write(record_.data(), entry.size);
+        if (!written.is_ok()) {
+            return Result<bool>(written.error_code());
+        }
+        if (*written < entry.size) {
+            return Result<bool>(ErrorCode::DISK_FULL);
+        }
+
+        segments_[entry.segment].live -= entry.size;
+        entry.segment = compact_slot_;
+        entry.offset = output.size;
+        output.size += entry.size;
+        output.live += entry.size;
+        ++compact_cursor_;
+        ++copied;
+    }
+
+    if (compact_cursor_ < index_.size()) {
+        return Result<bool>(false);
+    }
+    auto finished = finish_compaction();
+    if (!finished.is_ok()) {
+        return Result<bool>(finished.error_code());
+    }
+    return Result<bool>(true);
+}
+
+Result<void> KvStore::finish_compaction() {
+    auto result = compact_file_.flush();
+    if (!result.is_ok()) {
+        return result;
+    }
+    compact_file_.close();
+    compacting_ = false;
+    compact_slot_ = NO_SLOT;
+
+    // 旧段按编号从小到大删除: 删除记录总在被删除键的旧记录之后删除，中途掉电不会使键复活
+    while (true) {
+        uint8_t oldest = NO_SLOT;
+        for (uint8_t slot = 0; slot < MAX_SEGMENTS; ++slot) {
+            uint32_t id = segments_[slot].id;
+            if (id != 0 && id < compact_id_ && (oldest == NO_SLOT || id < segments_[oldest].id)) {
+                oldest = slot;
+            }
+        }
+        if (oldest == NO_SLOT) {
+            break;
+        }
+        char path[MICRO_SD_MAX_PATH];
+        segment_path(oldest, path, sizeof(path));
+        result = sd_.delete_file(path);
+        if (!result.is_ok() && result.error_code() != ErrorCode::FILE_NOT_FOUND) {
+            return result;
+        }
+        segments_[oldest].id = 0;
+    }
+
+    ++stats_.compactions;
+    rebuild_index();
+    return Result<void>();
+}
+
+Result<void> KvStore::compact() {
+    while (true) {
+        auto step = compact_step(SIZE_MAX);
+        if (!step.is_ok()) {
+            return Result<void>(step.error_code());
+        }
+        if (*step) {
+            return Result<void>();
+        }
+    }
+}
+
+Result<void> KvStore::close() {
+    if (!open_) {
+        return Result<void>();
+    }
+    Result<void> result;
+    if (compacting_) {
+        result = compact();
+    }
+    auto flushed = active_.flush();
+    if (result.is_ok()) {
+        result = flushed;
+    }
+    active_.close();
+    active_slot_ = NO_SLOT;
+    open_ = false;
+    return result;
+}
+
+KvStats KvStore::get_stats() const {
+    KvStats stats = stats_;
+    stats.keys = used_;
+    for (const Segment& segment : segments_) {
+        if (segment.id != 0) {
+            ++stats.segments;
+            stats.live_bytes += segment.live;
+            stats.total_bytes += segment.size;
+        }
+    }
+    return stats;
+}
+
+} // namespace MicroSD
@@ -0,0 +1,229 @@
+/**
+ * @file logger.cpp
+ * @brief 追加日志实现
+ * @version 1.0.0
+ */
+
+#include "logger.hpp"
+#include "platform.hpp"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+namespace MicroSD {
+
+Logger::Logger(RWSD& sd, const LoggerConfig& config)
+    : sd_(sd), config_(config),
+      buffer_(sd.get_memory_resource() ? sd.get_memory_resource() : std::pmr::null_memory_resource()),
+      head_(0), count_(0), file_size_(0), unsynced_bytes_(0), last_sync_us_(0) {
+    size_t length = config.path ? strlen(config.path) : MICRO_SD_MAX_PATH;
+    if (length < MICRO_SD_MAX_PATH) {
+        memcpy(path_, config.path, length + 1);
+    } else {
+        path_[0] = '\0';
+    }
+    config_.path = path_;
+}
+
+Result<void> Logger::open() {
+    if (path_[0] == '\0') {
+        return Result<void>(ErrorCode::INVALID_PARAMETER, "日志路径无效");
+    }
+    if (sd_.get_memory_resource() == nullptr) {
+        return Result<void>(ErrorCode::INVALID_PARAMETER, "未设置内存资源");
+    }
+    if (file_.is_open()) {
+        return Result<void>();
+    }
+
+    size_t capacity = std::max<size_t>(config_.buffer_size / BlockDevice::SECTOR_SIZE, 1) * BlockDevice::SECTOR_SIZE;
+    if (buffer_.size() != capacity) {
+        buffer_.resize(capacity);
+    }
+    return open_file();
+}
+
+Result<void> Logger::open_file() {
+    auto handle = sd_.open_file(path_, "a");
+    if (!handle.is_ok()) {
+        return Result<void>(handle.error_code());
+    }
+    file_ = std::move(*handle);
+    file_size_ = file_.size().value_or(0);
+
+    // 缓冲区偏移与文件偏移对扇区同余，缓冲区中的扇区边界即文件的扇区边界
+    head_ = file_size_ % BlockDevice::SECTOR_SIZE;
+    count_ = 0;
+    unsynced_bytes_ = 0;
+    last_sync_us_ = Platform::now_us();
+    return Result<void>();
+}
+
+Result<void> Logger::write(const void* data, size_t size) {
+    if (data == nullptr && size > 0) {
+        return Result<void>(ErrorCode::INVALID_PARAMETER);
+    }
+    auto result = begin_record(size);
+    if (result.is_ok()) {
+        result = append(data, size);
+    }
+    return result.is_ok() ? end_record(size) : result;
+}
+
+Result<void> Logger::log(std::string_view line) {
+    size_t size = line.size() + 1;
+    auto result = begin_record(size);
+    if (result.is_ok()) {
+        result = append(line.data(), line.size());
+    }
+    if (result.is_ok()) {
+        result = append("\n", 1);
+    }
+    return result.is_ok() ? end_record(size) : result;
+}
+
+Result<void> Logger::begin_record(size_t size) {
+    if (!file_.is_open()) {
+        return Result<void>(ErrorCode::INIT_FAILED, "日志未打开");
+    }
+    // 记录不跨文件: 放不下时先轮转
+    if (config_.rotate_bytes > 0 && file_size_ > 0 && file_size_ + size > config_.rotate_bytes) {
+        return rotate();
+    }
+    return Result<void>();
+}
+
+Result<void> Logger::append(const void* data, size_t size) {
+    const uint8_t* source = static_cast<const uint8_t*>(data);
+    size_t capacity = buffer_.size();
+    while (size > 0) {
+        if (count_ == capacity) {
+            auto result = write_out(false);
+            if (!result.is_ok()) {
+                return result;
+            }
+        }
+        size_t tail = (head_ + count_) % capacity;
+        size_t count = std::min({size, capacity - count_, capacity - tail});
+        memcpy(&buffer_[tail], source, count);
+        count_ += count;
+        source += count;
+        size -= count;
+    }
+    return Result<void>();
+}
+
+Result<void> Logger::end_record(size_t size) {
+    file_size_ += size;
+    unsynced_bytes_ += size;
+    stats_.bytes += size;
+    ++stats_.records;
+
+    if (config_.sync_bytes > 0 && unsynced_bytes_ >= config_.sync_bytes) {
+        return flush();
+    }
+    return poll();
+}
+
+Result<void> Logger::write_out(bool partial) {
+    size_t capacity = buffer_.size();
+    while (count_ > 0) {
+        size_t segment = std::min(count_, capacity - head_);
+        if (!partial) {
+            // 只写出完整的扇区，不足一个扇区的尾部留在缓冲区中
+            size_t end = (head_ + segment) / BlockDevice::SECTOR_SIZE * BlockDevice::SECTOR_SIZE;
+            if (end <= head_) {
+                break;
+            }
+            segment = end - head_;
+        }
+
+        auto written = file_.write(&buffer_[head_], segment);
+        if (!written.is_ok()) {
+            return Result<void>(written.error_code());
+        }
+        ++stats_.writes;
+        if (*written < segment) {
+            return Result<void>(ErrorCode::DISK_FULL);
+        }
+        head_ = (head_ + segment) % capacity;
+        count_ -= segment;
+    }
+    return Result<void>();
+}
+
+Result<void> Logger::poll() {
+    if (!file_.is_open() || config_.sync_interval_ms == 0 || (count_ == 0 && unsynced_bytes_ == 0)) {
+        return Result<void>();
+    }
+    if (Platform::now_us() - last_sync_us_ < (uint64_t)config_.sync_interval_ms * 1000) {
+        return Result<void>();
+    }
+    return flush();
+}
+
+Result<void> Logger::flush() {
+    if (!file_.is_open()) {
+        return Result<void>();
+    }
+    auto result = write_out(true);
+    if (!result.is_ok()) {
+        return result;
+    }
+    result = file_.flush();
+    if (!result.is_ok()) {
+        return result;
+    }
+    ++stats_.syncs;
+    unsynced_bytes_ = 0;
+    last_sync_us_ = Platform::now_us();
+    return Result<void>();
+}
+
+Result<void> Logger::rotate() {
+    auto result = flush();
+    if (!result.is_ok()) {
+        return result;
+    }
+    file_.close();
+
+    // path.(n-1)被删除，其余依次后移: path.(i) -> path.(i+1)，当前文件 -> path.1
+    char from[MICRO_SD_MAX_PATH + 4];
+    char to[MICRO_SD_MAX_PATH + 4];
+    uint8_t keep = std::max<uint8_t>(config_.max_files, 1);
+    snprintf(to, sizeof(to), "%s.%u", path_, (unsigned)(keep - 1));
+    if (keep == 1 || sd_.file_exists(to)) {
+        result = sd_.delete_file(keep == 1 ? path_ : to);
+        if (!result.is_ok()) {
+            return result;
+        }
+    }
+    for (unsigned i = keep - 1; i >= 1; --i) {
+        if (i > 1) {
+            snprintf(from, sizeof(from), "%s.%u", path_, i - 1);
+        } else {
+            snprintf(from, sizeof(from), "%s", path_);
+        }
+        snprintf(to, sizeof(to), "%s.%u", path_, i);
+        if (sd_.file_exists(from)) {
+            result = sd_.rename(from, to);
+            if (!result.is_ok()) {
+                return result;
+            }
+        }
+    }
+
+    ++stats_.rotations;
+    return open_file();
+}
+
+Result<void> Logger::close() {
+    if (!file_.is_open()) {
+        return Result<void>();
+    }
+    auto result = flush();
+    file_.close();
+    return result;
+}
+
+} // namespace MicroSD
@@ -0,0 +1,214 @@
+/**
+ * @file open_file_table.cpp
+ * @brief 打开文件表实现
+ * @version 1.0.0
+ */
+
+#include "open_file_table.hpp"
+#include <string.h>
+#include <strings.h>
+
+namespace MicroSD {
+
+static_assert(FF_USE_FASTSEEK, "打开文件的fast_seek需要FF_USE_FASTSEEK=1 (见config/ffconf.h)");
+
+namespace {
+
+constexpr size_t LINK_MAP_INITIAL_WORDS = 32;   // 初始映射表 (可容纳15个片段)
+
+} // namespace
+
+OpenFileTable::OpenFileTable(std::pmr::memory_resource* memory)
+    : memory_(memory), open_count_(0), peak_count_(0) {
+    for (Slot& slot : slots_) {
+        slot.link_map = nullptr;
+        slot.link_map_words = 0;
+        slot.reserved_end = 0;
+        slot.data_end = 0;
+        slot.generation = 0;
+        slot.in_use = false;
+        slot.path[0] = '\0';
+        slot.mode[0] = '\0';
+    }
+}
+
+FRESULT OpenFileTable::open(const char* path, const char* mode, BYTE flags,
+                            uint8_t& slot, uint16_t& generation) {
+    size_t path_length = strlen(path);
+    size_t mode_length = strlen(mode);
+    if (path_length >= MICRO_SD_MAX_PATH || mode_length >= sizeof(Slot::mode)) {
+        return FR_INVALID_NAME;
+    }
+
+    for (uint8_t i = 0; i < CAPACITY; ++i) {
+        Slot& entry = slots_[i];
+        if (entry.in_use) {
+            continue;
+        }
+
+        FRESULT fr = f_open(&entry.file, path, flags);
+        if (fr != FR_OK) {
+            return fr;
+        }
+        entry.in_use = true;
+        entry.reserved_end = 0;
+        entry.data_end = 0;
+        memcpy(entry.path, path, path_length + 1);
+        memcpy(entry.mode, mode, mode_length + 1);
+        slot = i;
+        generation = entry.generation;
+
+        ++open_count_;
+        if (open_count_ > peak_count_) {
+            peak_count_ = open_count_;
+        }
+        return FR_OK;
+    }
+    return FR_TOO_MANY_OPEN_FILES;
+}
+
+OpenFileTable::Slot* OpenFileTable::get(uint8_t slot, uint16_t generation) {
+    if (slot >= CAPACITY || !slots_[slot].in_use || slots_[slot].generation != generation) {
+        return nullptr;
+    }
+    return &slots_[slot];
+}
+
+const OpenFileTable::Slot* OpenFileTable::get(uint8_t slot, uint16_t generation) const {
+    return const_cast<OpenFileTable*>(this)->get(slot, generation);
+}
+
+FRESULT OpenFileTable::close(uint8_t slot, uint16_t generation) {
+    Slot* entry = get(slot, generation);
+    if (entry == nullptr) {
+        return FR_INVALID_OBJECT;
+    }
+
+    FRESULT fr = FR_OK;
+    if (entry->reserved_end != 0) {
+        fr = f_lseek(&entry->file, entry->data_end);
+        if (fr == FR_OK) {
+            fr = f_truncate(&entry->file);
+        }
+    }
+    FRESULT close_fr = f_close(&entry->file);
+    if (fr == FR_OK) {
+        fr = close_fr;
+    }
+    release_link_map(*entry);
+    entry->in_use = false;
+    entry->path[0] = '\0';
+    entry->mode[0] = '\0';
+    ++entry->generation;
+    --open_count_;
+    return fr;
+}
+
+void OpenFileTable::release_link_map(Slot& slot) {
+    if (slot.link_map != nullptr) {
+        memory_->deallocate(slot.link_map, slot.link_map_words * sizeof(DWORD), alignof(DWORD));
+        slot.link_map = nullptr;
+        slot.link_map_words = 0;
+    }
+    slot.file.cltbl = nullptr;
+}
+
+FRESULT OpenFileTable::enable_fast_seek(uint8_t slot, uint16_t generation, size_t max_bytes) {
+    Slot* entry = get(slot, generation);
+    if (entry == nullptr) {
+        return FR_INVALID_OBJECT;
+    }
+    release_link_map(*entry);
+
+    size_t words = LINK_MAP_INITIAL_WORDS;
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        if (words * sizeof(DWORD) > max_bytes) {
+            return FR_NOT_ENOUGH_CORE;
+        }
+        entry->link_map = static_cast<DWORD*>(memory_->allocate(words * sizeof(DWORD), alignof(DWORD)));
+        entry->link_map_words = words;
+        entry->link_map[0] = static_cast<DWORD>(words);
+        entry->file.cltbl = entry->link_map;
+
+        // 建表不改变读写位置
+        FSIZE_t position = f_tell(&entry->file);
+        FRESULT fr = f_lseek(&entry->file, CREATE_LINKMAP);
+        if (fr == FR_OK) {
+            return f_lseek(&entry->file, position);
+        }
+        // 表不足时FatFs在第一个元素中返回所需大小
+        size_t required = entry->link_map[0];
+        release_link_map(*entry);
+        if (fr != FR_NOT_ENOUGH_CORE) {
+            return fr;
+        }
+        words = required;
+    }
+    return FR_NOT_ENOUGH_CORE;
+}
+
+bool OpenFileTable::is_open_for_write(const char* path) const {
+    for (const Slot& entry : slots_) {
+        if (entry.in_use && (entry.file.flag & FA_WRITE) && same_path(entry.path, path)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool OpenFileTable::is_writing_under(const char* directory) const {
+    while (*directory == '/') ++directory;
+    size_t length = strlen(directory);
+    while (length > 0 && directory[length - 1] == '/') --length;
+    for (const Slot& entry : slots_) {
+        if (!entry.in_use || !(entry.file.flag & FA_WRITE)) {
+            continue;
+        }
+        const char* path = entry.path;
+        while (*path == '/') ++path;
+        if (length == 0) {
+            return true;
+        }
+        if (strncasecmp(path, directory, length) == 0 && path[length] == '/') {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool OpenFileTable::same_path(const char* a, const char* b) {
+    while (*a == '/') ++a;
+    while (*b == '/') ++b;
+    for (; *a && *b; ++a, ++b) {
+        char ca = (*a >= 'a' && *a <= 'z') ? *a - 'a' + 'A' : *a;
+        char cb = (*b >= 'a' && *b <= 'z') ? *b - 'a' + 'A' : *b;
+        if (ca != cb) {
+            return false;
+        }
+    }
+    return *a == *b;
+}
+
+FRESULT OpenFileTable::sync_all() {
+    FRESULT first_error = FR_OK;
+    for (Slot& entry : slots_) {
+        if (!entry.in_use || !(entry.file.flag & FA_WRITE)) {
+            continue;
+        }
+        FRESULT fr = f_sync(&entry.file);
+        if (fr != FR_OK && first_error == FR_OK) {
+            first_error = fr;
+        }
+    }
+    return first_error;
+}
+
+void OpenFileTable::close_all() {
+    for (uint8_t i = 0; i < CAPACITY; ++i) {
+        if (slots_[i].in_use) {
+            close(i, slots_[i].generation);
+        }
+    }
+}
+
+} // namespace MicroSD
@@ -0,0 +1,169 @@
+/**
+ * @file pico_spi_transport.cpp
+ * @brief RP2040硬件SPI + DMA传输实现
+ * @version 1.0.0
+ */
+
+#include "pico_spi_transport.hpp"
+#include "pico/stdlib.h"
+#include "hardware/spi.h"
+#include "hardware/gpio.h"
+#include "hardware/dma.h"
+#include <sstream>
+
+namespace MicroSD {
+
+PicoSpiTransport::PicoSpiTransport(const SPIConfig& config, bool use_dma)
+    : config_(config), clock_(0), tx_channel_(-1), rx_channel_(-1),
+      use_dma_(use_dma), busy_(false), dummy_tx_(0xFF), dummy_rx_(0) {}
+
+PicoSpiTransport::~PicoSpiTransport() {
+    end();
+}
+
+Result<void> PicoSpiTransport::begin(uint32_t baudrate) {
+    if (!config_.is_valid()) {
+        return Result<void>(ErrorCode::INVALID_PARAMETER);
+    }
+
+    clock_ = spi_init(config_.spi_port, baudrate);
+    gpio_set_function(config_.pins.pin_miso, GPIO_FUNC_SPI);
+    gpio_set_function(config_.pins.pin_sck, GPIO_FUNC_SPI);
+    gpio_set_function(config_.pins.pin_mosi, GPIO_FUNC_SPI);
+    gpio_init(config_.pins.pin_cs);
+    gpio_set_dir(config_.pins.pin_cs, GPIO_OUT);
+    gpio_put(config_.pins.pin_cs, 1);
+
+    if (config_.pins.use_internal_pullup) {
+        gpio_pull_up(config_.pins.pin_miso);
+        gpio_pull_up(config_.pins.pin_mosi);
+    }
+
+    // 申请一对DMA通道，失败时使用阻塞传输
+    if (use_dma_ && !has_dma()) {
+        tx_channel_ = dma_claim_unused_channel(false);
+        rx_channel_ = dma_claim_unused_channel(false);
+        if (!has_dma()) {
+            if (tx_channel_ >= 0) dma_channel_unclaim(tx_channel_);
+            if (rx_channel_ >= 0) dma_channel_unclaim(rx_channel_);
+            tx_channel_ = rx_channel_ = -1;
+        }
+    }
+    return Result<void>();
+}
+
+void PicoSpiTransport::end() {
+    if (clock_ == 0) {
+        return;
+    }
+    wait_transfer();
+    if (has_dma()) {
+        dma_channel_unclaim(tx_channel_);
+        dma_channel_unclaim(rx_channel_);
+        tx_channel_ = rx_channel_ = -1;
+    }
+    spi_deinit(config_.spi_port);
+    clock_ = 0;
+}
+
+uint32_t PicoSpiTransport::set_clock(uint32_t baudrate) {
+    clock_ = spi_set_baudrate(config_.spi_port, baudrate);
+    return clock_;
+}
+
+void PicoSpiTransport::select() {
+    gpio_put(config_.pins.pin_cs, 0);
+}
+
+void PicoSpiTransport::deselect() {
+    gpio_put(config_.pins.pin_cs, 1);
+}
+
+uint8_t PicoSpiTransport::transfer(uint8_t data) {
+    uint8_t rx;
+    spi_write_read_blocking(config_.spi_port, &data, &rx, 1);
+    return rx;
+}
+
+void PicoSpiTransport::write_bytes(const uint8_t* data, size_t length) {
+    start_write(data, length);
+    wait_transfer();
+}
+
+void PicoSpiTransport::read_bytes(uint8_t* data, size_t length) {
+    start_read(data, length);
+    wait_transfer();
+}
+
+// === DMA数据阶段 ===
+
+void PicoSpiTransport::start_dma(const uint8_t* tx, uint8_t* rx, size_t length) {
+    spi_inst_t* spi = config_.spi_port;
+    volatile void* dr = &spi_get_hw(spi)->dr;
+
+    // TX: 数据缓冲区或固定的0xFF哑元
+    dma_channel_config tx_config = dma_channel_get_default_config(tx_channel_);
+    channel_config_set_transfer_data_size(&tx_config, DMA_SIZE_8);
+    channel_config_set_dreq(&tx_config, spi_get_dreq(spi, true));
+    channel_config_set_read_increment(&tx_config, tx != nullptr);
+    channel_config_set_write_increment(&tx_config, false);
+    dma_channel_configure(tx_channel_, &tx_config, dr, tx != nullptr ? tx : &dummy_tx_, length, false);
+
+    // RX: 数据缓冲区或丢弃到哑元字节，保证接收FIFO不溢出
+    dma_channel_config rx_config = dma_channel_get_default_config(rx_channel_);
+    channel_config_set_transfer_data_size(&rx_config, DMA_SIZE_8);
+    channel_config_set_dreq(&rx_config, spi_get_dreq(spi, false));
+    channel_config_set_read_increment(&rx_config, false);
+    channel_config_set_write_increment(&rx_config, rx != nullptr);
+    dma_channel_configure(rx_channel_, &rx_config, rx != nullptr ? rx : &dummy_rx_, dr, length, false);
+
+    // 两个通道同时启动
+    dma_start_channel_mask((1u << tx_channel_) | (1u << rx_channel_));
+    busy_ = true;
+}
+
+void PicoSpiTransport::start_read(uint8_t* data, size_t length) {
+    wait_transfer();
+    if (has_dma() && length >= DMA_MIN_LENGTH) {
+        start_dma(nullptr, data, length);
+    } else {
+        spi_read_blocking(config_.spi_port, 0xFF, data, length);
+    }
+}
+
+void PicoSpiTransport::start_write(const uint8_t* data, size_t length) {
+    wait_transfer();
+    if (has_dma() && length >= DMA_MIN_LENGTH) {
+        start_dma(data, nullptr, length);
+    } else {
+        spi_write_blocking(config_.spi_port, data, length);
+    }
+}
+
+void PicoSpiTransport::wait_transfer() {
+    if (!busy_) {
+        return;
+    }
+    // RX通道完成意味着最后一个字节已移出移位寄存器
+    dma_channel_wait_for_finish_blocking(rx_channel_);
+    dma_channel_wait_for_finish_blocking(tx_channel_);
+    busy_ = false;
+}
+
+std::string PicoSpiTransport::get_config_info() const {
+    std::ostringstream oss;
+    oss << "SPI实例: " << (config_.spi_port == spi0 ? "SPI0" : "SPI1") << "\n";
+    oss << "MOSI引脚: " << (int)config_.pins.pin_mosi << "\n";
+    oss << "MISO引脚: " << (int)config_.pins.pin_miso << "\n";
+    oss << "SCLK引脚: " << (int)config_.pins.pin_sck << "\n";
+    oss << "CS引脚: " << (int)config_.pins.pin_cs << "\n";
+    oss << "DMA: ";
+    if (has_dma()) {
+        oss << "TX通道" << tx_channel_ << " / RX通道" << rx_channel_ << "\n";
+    } else {
+        oss << "未使用\n";
+    }
+    return oss.str();
+}
+
+} // namespace MicroSD
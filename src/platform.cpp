@@ -0,0 +1,44 @@
+/**
+ * @file platform.cpp
+ * @brief 平台相关的时间函数实现
+ * @version 1.0.0
+ */
+
+#include "platform.hpp"
+
+#if MICRO_SD_HOST
+#include <chrono>
+#include <thread>
+#else
+#include "pico/stdlib.h"
+#include "pico/time.h"
+#endif
+
+namespace MicroSD {
+namespace Platform {
+
+#if MICRO_SD_HOST
+
+uint64_t now_us() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void delay_ms(uint32_t ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+#else
+
+uint64_t now_us() {
+    return time_us_64();
+}
+
+void delay_ms(uint32_t ms) {
+    sleep_ms(ms);
+}
+
+#endif
+
+} // namespace Platform
+} // namespace MicroSD
@@ -0,0 +1,87 @@
+/**
+ * @file read_handle_cache.cpp
+ * @brief 只读文件句柄缓存实现
+ * @version 1.0.0
+ */
+
+#include "read_handle_cache.hpp"
+#include <string.h>
+
+namespace MicroSD {
+
+ReadHandleCache::ReadHandleCache() : clock_(0) {
+    for (Entry& entry : entries_) {
+        entry.last_use = 0;
+        entry.valid = false;
+        entry.path[0] = '\0';
+    }
+}
+
+void ReadHandleCache::drop(Entry& entry) {
+    if (entry.valid) {
+        f_close(&entry.file);
+        entry.valid = false;
+        entry.path[0] = '\0';
+    }
+}
+
+FIL* ReadHandleCache::acquire(const char* path, FRESULT& fr) {
+    fr = FR_OK;
+    size_t length = strlen(path);
+    if (length >= MICRO_SD_MAX_PATH) {
+        return nullptr;
+    }
+
+    Entry* victim = &entries_[0];
+    for (Entry& entry : entries_) {
+        if (entry.valid && OpenFileTable::same_path(entry.path, path)) {
+            entry.last_use = ++clock_;
+            ++stats_.hits;
+            return &entry.file;
+        }
+        if (!entry.valid) {
+            victim = &entry;
+        } else if (victim->valid && entry.last_use < victim->last_use) {
+            victim = &entry;
+        }
+    }
+
+    ++stats_.misses;
+    drop(*victim);
+    fr = f_open(&victim->file, path, FA_READ);
+    if (fr != FR_OK) {
+        return nullptr;
+    }
+    victim->valid = true;
+    victim->last_use = ++clock_;
+    memcpy(victim->path, path, length + 1);
+    return &victim->file;
+}
+
+void ReadHandleCache::release_on_error(FIL* file) {
+    for (Entry& entry : entries_) {
+        if (&entry.file == file) {
+            drop(entry);
+        }
+    }
+}
+
+void ReadHandleCache::invalidate(const char* path) {
+    for (Entry& entry : entries_) {
+        if (entry.valid && OpenFileTable::same_path(entry.path, path)) {
+            drop(entry);
+            ++stats_.invalidations;
+        }
+    }
+}
+
+void ReadHandleCache::invalidate_all() {
+    for (Entry& entry : entries_) {
+        if (entry.valid) {
+            drop(entry);
+            ++stats_.invalidations;
+        }
+    }
+}
+
+} // namespace MicroSD
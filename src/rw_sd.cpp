@@ -5,16 +5,13 @@
  */
 
 #include "rw_sd.hpp"
+#include "tree_walker.hpp"
 #include "pin_config.hpp"
-#include "pico/stdlib.h"
-#include "pico/time.h"
-#include "hardware/spi.h"
-#include "hardware/gpio.h"
-#include "hardware/clocks.h"
+#include "platform.hpp"
+#if !MICRO_SD_HOST
+#include "sd_spi_block_device.hpp"
+#endif
 #include "ff.h"
-#include "diskio.h"
-#include "tf_card.h"
-#include "pio_spi.h"
 #include <stdio.h>
 #include <string.h>
 #include <algorithm>
@@ -25,23 +22,36 @@
 
 namespace MicroSD {
 
+static_assert(FF_USE_EXPAND, "连续预分配和ExtentWriter需要FF_USE_EXPAND=1 (见config/ffconf.h)");
+static_assert(FF_USE_CHMOD, "copy_file保留属性需要FF_USE_CHMOD=1 (见config/ffconf.h)");
+
 // === 构造函数和析构函数 ===
 
+#if !MICRO_SD_HOST
 RWSD::RWSD(SPIConfig config) 
-    : config_(config), fs_type_(0), is_initialized_(false) {
+    : RWSD(std::make_unique<SdSpiBlockDevice>(config)) {}
+#endif
+
+RWSD::RWSD(std::unique_ptr<BlockDevice> device)
+    : device_(std::move(device)), memory_(default_memory_resource()), listener_(nullptr), fs_type_(0),
+      is_initialized_(false), fast_mount_(true),
+      mount_time_us_(0), fsinfo_loaded_(false) {
     memset(&fs_, 0, sizeof(FATFS));
 }
 
 RWSD::~RWSD() {
     if (is_initialized_) {
         unmount_filesystem();
-        deinitialize_spi();
+        deinitialize_device();
     }
 }
 
 RWSD::RWSD(RWSD&& other) noexcept 
-    : config_(other.config_), fs_(other.fs_), fs_type_(other.fs_type_), 
-      is_initialized_(other.is_initialized_), current_dir_(std::move(other.current_dir_)),
+    : device_(std::move(other.device_)), memory_(other.memory_), cache_(std::move(other.cache_)),
+      cache_config_(other.cache_config_), free_map_(std::move(other.free_map_)),
+      files_(std::move(other.files_)), read_cache_(std::move(other.read_cache_)), dentry_cache_(std::move(other.dentry_cache_)), usage_cache_(std::move(other.usage_cache_)), listener_(other.listener_), free_space_config_(other.free_space_config_), fs_(other.fs_), fs_type_(other.fs_type_), 
+      is_initialized_(other.is_initialized_), fast_mount_(other.fast_mount_),
+      mount_time_us_(other.mount_time_us_), fsinfo_loaded_(other.fsinfo_loaded_), current_dir_(std::move(other.current_dir_)),
       current_path_(std::move(other.current_path_)) {
     other.is_initialized_ = false;
     memset(&other.fs_, 0, sizeof(FATFS));
@@ -51,13 +61,26 @@ RWSD& RWSD::operator=(RWSD&& other) noexcept {
     if (this != &other) {
         if (is_initialized_) {
             unmount_filesystem();
-            deinitialize_spi();
+            deinitialize_device();
         }
         
-        config_ = other.config_;
+        device_ = std::move(other.device_);
+        memory_ = other.memory_;
+        cache_ = std::move(other.cache_);
+        cache_config_ = other.cache_config_;
+        free_map_ = std::move(other.free_map_);
+        files_ = std::move(other.files_);
+        read_cache_ = std::move(other.read_cache_);
+        dentry_cache_ = std::move(other.dentry_cache_);
+        usage_cache_ = std::move(other.usage_cache_);
+        listener_ = other.listener_;
+        free_space_config_ = other.free_space_config_;
         fs_ = other.fs_;
         fs_type_ = other.fs_type_;
         is_initialized_ = other.is_initialized_;
+        fast_mount_ = other.fast_mount_;
+        mount_time_us_ = other.mount_time_us_;
+        fsinfo_loaded_ = other.fsinfo_loaded_;
         current_dir_ = std::move(other.current_dir_);
         current_path_ = std::move(other.current_path_);
         
@@ -69,97 +92,346 @@ RWSD& RWSD::operator=(RWSD&& other) noexcept {
 
 // === 初始化方法 ===
 
-void RWSD::initialize_spi() {
-    // 配置pico_fatfs SPI设置
-    pico_fatfs_spi_config_t spi_config = {
-        config_.spi_port,
-        config_.clk_slow,
-        config_.clk_fast,
-        config_.pins.pin_miso,
-        config_.pins.pin_cs,
-        config_.pins.pin_sck,
-        config_.pins.pin_mosi,
-        config_.pins.use_internal_pullup
-    };
+Result<void> RWSD::initialize_device() {
+    if (!device_) {
+        return Result<void>(ErrorCode::INVALID_PARAMETER);
+    }
     
-    // 设置SPI配置
-    pico_fatfs_set_config(&spi_config);
-    
-    // 初始化SPI硬件
-    if (spi_config.spi_inst != NULL) {
-        // 使用硬件SPI
-        spi_init(spi_config.spi_inst, spi_config.clk_slow);
-        gpio_set_function(spi_config.pin_miso, GPIO_FUNC_SPI);
-        gpio_set_function(spi_config.pin_sck, GPIO_FUNC_SPI);
-        gpio_set_function(spi_config.pin_mosi, GPIO_FUNC_SPI);
-        gpio_set_function(spi_config.pin_cs, GPIO_FUNC_SIO);
-        gpio_set_dir(spi_config.pin_cs, GPIO_OUT);
-        gpio_put(spi_config.pin_cs, 1);
-        
-        if (spi_config.pullup) {
-            gpio_pull_up(spi_config.pin_miso);
-            gpio_pull_up(spi_config.pin_mosi);
+    auto result = device_->initialize();
+    if (!result.is_ok()) {
+        return result;
+    }
+    
+    // 将块设备 (或其缓存) 挂接到FatFs驱动器0
+    setup_cache();
+    setup_free_map();
+    return Result<void>();
+}
+
+void RWSD::deinitialize_device() {
+    attach_block_device(0, nullptr);
+    free_map_.reset();
+    cache_.reset();
+    if (device_) {
+        device_->deinitialize();
+    }
+}
+
+void RWSD::setup_free_map() {
+    // 空闲簇索引位于FatFs与缓存之间，观察FAT区写入
+    BlockDevice* lower = cache_ ? static_cast<BlockDevice*>(cache_.get()) : device_.get();
+    if (!free_space_config_.enabled) {
+        free_map_.reset();
+        attach_block_device(0, lower);
+        return;
+    }
+    if (free_map_) {
+        free_map_->set_device(*lower);
+    } else {
+        free_map_ = make_pmr<FreeClusterMap>(memory_, *lower, free_space_config_.ram_budget, memory_);
+    }
+    attach_block_device(0, free_map_.get());
+}
+
+void RWSD::start_free_tracking() {
+    if (!free_map_ || !free_map_->attach(fs_.fs_type, fs_.fatbase, fs_.fsize, fs_.n_fatent)) {
+        return;
+    }
+    // 快速挂载: FSINFO已提供空闲簇数时推迟扫描
+    bool defer = free_space_config_.background_scan || (fast_mount_ && load_fsinfo());
+    if (!defer) {
+        auto result = free_map_->scan();
+        if (!result.is_ok()) {
+            free_map_->detach();
+            return;
         }
+        apply_free_map();
+    }
+}
+
+void RWSD::apply_free_map() {
+    // 同步到FatFs: f_getfree不再扫描FAT，分配器从第一个有空闲簇的组开始查找
+    if (fs_.free_clst != free_map_->free_clusters()) {
+        fs_.free_clst = free_map_->free_clusters();
+        fs_.fsi_flag |= 1;  // FSINFO需要更新
+    }
+    uint32_t first_free = free_map_->find_free(2);
+    if (first_free > 2) {
+        fs_.last_clst = first_free - 1;
+    }
+}
+
+void RWSD::setup_cache() {
+    if (cache_config_.ram_budget >= BlockDevice::SECTOR_SIZE) {
+        cache_ = make_pmr<SectorCache>(memory_, *device_, cache_config_, memory_);
+        attach_block_device(0, cache_.get());
     } else {
-        // 使用PIO SPI
-        pico_fatfs_config_spi_pio(pio0, 0);
+        cache_.reset();
+        attach_block_device(0, device_.get());
     }
 }
 
-void RWSD::deinitialize_spi() {
-    // 关闭SPI
-    spi_deinit(config_.spi_port);
+bool RWSD::load_fsinfo() const {
+    // FatFs在挂载时已读取FSINFO (FF_FS_NOFSINFO未禁用时)
+    if (fs_.fs_type != FS_FAT32 || (fs_.fsi_flag & 0x80)) {
+        return false;
+    }
+    if (fs_.free_clst <= fs_.n_fatent - 2) {
+        return true;
+    }
+    if (fsinfo_loaded_) {
+        return false;
+    }
+    
+    // FatFs配置为忽略FSINFO时在首次需要时自行读取
+    fsinfo_loaded_ = true;
+    BlockDevice* device = attached_block_device(0);
+    uint8_t sector[BlockDevice::SECTOR_SIZE];
+    if (device == nullptr || !device->read(fs_.volbase + 1, sector, 1).is_ok()) {
+        return false;
+    }
+    auto ld_dword = [&](size_t offset) {
+        return (DWORD)sector[offset] | ((DWORD)sector[offset + 1] << 8) |
+               ((DWORD)sector[offset + 2] << 16) | ((DWORD)sector[offset + 3] << 24);
+    };
+    if (ld_dword(0) != 0x41615252 || ld_dword(484) != 0x61417272 ||
+        sector[510] != 0x55 || sector[511] != 0xAA) {
+        return false;
+    }
+    DWORD free_count = ld_dword(488);
+    if (free_count > fs_.n_fatent - 2) {
+        return false;
+    }
+    FATFS& fs = const_cast<FATFS&>(fs_);
+    fs.free_clst = free_count;
+    return true;
+}
+
+Result<void> RWSD::write_fsinfo() {
+    // RWSD::sync()不经过FatFs的sync_fs，因此由这里保持FSINFO最新，下次挂载无需扫描FAT
+    if (fs_.fs_type != FS_FAT32 || (fs_.fsi_flag & 0x80) || fs_.free_clst > fs_.n_fatent - 2) {
+        return Result<void>();
+    }
+    BlockDevice* device = attached_block_device(0);
+    if (device == nullptr) {
+        return Result<void>(ErrorCode::INIT_FAILED);
+    }
+    
+    LBA_t fsinfo_sector = fs_.volbase + 1;
+    uint8_t sector[BlockDevice::SECTOR_SIZE];
+    auto result = device->read(fsinfo_sector, sector, 1);
+    if (!result.is_ok()) {
+        return result;
+    }
+    auto ld_dword = [&](size_t offset) {
+        return (DWORD)sector[offset] | ((DWORD)sector[offset + 1] << 8) |
+               ((DWORD)sector[offset + 2] << 16) | ((DWORD)sector[offset + 3] << 24);
+    };
+    auto st_dword = [&](size_t offset, DWORD value) {
+        for (int i = 0; i < 4; ++i) {
+            sector[offset + i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+    };
+    if (ld_dword(0) != 0x41615252 || ld_dword(484) != 0x61417272) {
+        return Result<void>();
+    }
+    if (ld_dword(488) == fs_.free_clst && ld_dword(492) == fs_.last_clst) {
+        fs_.fsi_flag &= ~1;
+        return Result<void>();
+    }
+    
+    st_dword(488, fs_.free_clst);
+    st_dword(492, fs_.last_clst);
+    result = device->write(fsinfo_sector, sector, 1);
+    if (!result.is_ok()) {
+        return result;
+    }
+    fs_.fsi_flag &= ~1;
+    if (fs_.winsect == fsinfo_sector && !fs_.wflag) {
+        fs_.winsect = (LBA_t)0 - 1;  // 窗口中的FSINFO副本已过期
+    }
+    return Result<void>();
+}
+
+void RWSD::invalidate_path(const std::string& path) {
+    if (read_cache_) {
+        read_cache_->invalidate(path.c_str());
+    }
+    if (dentry_cache_) {
+        dentry_cache_->invalidate(path.c_str());
+    }
+}
+
+void RWSD::notify_change(FileChange change, const std::string& path, const char* new_path) {
+    if (listener_) {
+        listener_->on_file_change(change, path.c_str(), new_path);
+    }
+}
+
+FRESULT RWSD::stat_path(const std::string& path, FILINFO& fno) const {
+    // 正在被写入的文件，目录项中的大小在同步前是旧的，不缓存
+    bool cacheable = dentry_cache_ && !(files_ && files_->is_open_for_write(path.c_str()));
+    if (cacheable) {
+        bool exists;
+        DentryInfo info;
+        const char* name;
+        if (dentry_cache_->lookup(path.c_str(), exists, &info, &name)) {
+            if (!exists) {
+                return FR_NO_FILE;
+            }
+            fno.fsize = info.size;
+            fno.fdate = info.date;
+            fno.ftime = info.time;
+            fno.fattrib = info.attributes;
+            strncpy(fno.fname, name, sizeof(fno.fname) - 1);
+            fno.fname[sizeof(fno.fname) - 1] = '\0';
+            return FR_OK;
+        }
+    }
+    
+    FRESULT fr = f_stat(path.c_str(), &fno);
+    if (cacheable && (fr == FR_OK || fr == FR_NO_FILE || fr == FR_NO_PATH)) {
+        dentry_cache_->insert(path.c_str(), fr == FR_OK ? &fno : nullptr);
+    }
+    return fr;
+}
+
+namespace {
+
+DirectoryUsage file_usage(FSIZE_t size, uint32_t cluster_bytes) {
+    DirectoryUsage usage;
+    usage.files = 1;
+    usage.bytes = size;
+    if (cluster_bytes > 0) {
+        usage.clusters = (uint32_t)((size + cluster_bytes - 1) / cluster_bytes);
+        usage.allocated_bytes = (uint64_t)usage.clusters * cluster_bytes;
+    }
+    return usage;
+}
+
+} // namespace
+
+DirectoryUsage RWSD::path_usage(const std::string& path) const {
+    FILINFO fno;
+    DirectoryUsage usage;
+    if (stat_path(path, fno) != FR_OK) {
+        return usage;
+    }
+    if (fno.fattrib & AM_DIR) {
+        usage.directories = 1;
+        return usage;
+    }
+    return file_usage(fno.fsize, cluster_bytes());
+}
+
+RWSD::UsageUpdate::UsageUpdate(const RWSD& sd, const std::string& path)
+    : UsageUpdate(sd, path, sd.usage_cache_ && sd.usage_cache_->covers(path.c_str())) {}
+
+RWSD::UsageUpdate::UsageUpdate(const RWSD& sd, const std::string& path, bool tracked)
+    : sd_(sd), path_(path), tracked_(tracked && sd.usage_cache_) {
+    // 没有汇总包含该路径时不需要查询
+    if (tracked_) {
+        before_ = sd_.path_usage(path_);
+    }
+}
+
+RWSD::UsageUpdate::~UsageUpdate() {
+    if (tracked_) {
+        sd_.usage_cache_->adjust(path_.c_str(), before_, sd_.path_usage(path_));
+    }
 }
 
 Result<void> RWSD::mount_filesystem() {
+    uint64_t start_us = Platform::now_us();
+    fsinfo_loaded_ = false;
     FRESULT fr = f_mount(&fs_, "", 1);
     if (fr != FR_OK) {
         return Result<void>(fresult_to_error_code(fr));
     }
     
-    // 获取文件系统类型
-    DWORD fre_clust, fre_sect, tot_sect;
-    FATFS* fs_ptr = const_cast<FATFS*>(&fs_);
-    fr = f_getfree("", &fre_clust, &fs_ptr);
-    if (fr == FR_OK) {
-        tot_sect = (fs_.n_fatent - 2) * fs_.csize;
-        fre_sect = fre_clust * fs_.csize;
-        
-        if (tot_sect < 4085) {
-            fs_type_ = 1; // FAT12
-        } else if (fre_sect < 65525) {
-            fs_type_ = 2; // FAT16
-        } else {
-            fs_type_ = 3; // FAT32
-        }
+    // FAT区以及经由FatFs窗口缓冲区访问的目录扇区在缓存中固定
+    if (cache_) {
+        cache_->set_pinned_range(fs_.fatbase, fs_.fsize * fs_.n_fats);
+        cache_->set_metadata_window(fs_.win);
+    }
+    
+    // 文件系统类型直接取自卷信息，不需要扫描FAT
+    switch (fs_.fs_type) {
+        case FS_FAT12: fs_type_ = 1; break;
+        case FS_FAT16: fs_type_ = 2; break;
+        case FS_FAT32: fs_type_ = 3; break;
+        default: fs_type_ = 0; break;
     }
     
+    start_free_tracking();
+    
+    // 打开文件表只分配一次，之后卸载/挂载复用
+    if (!files_) {
+        files_ = make_pmr<OpenFileTable>(memory_, memory_);
+    }
+#if MICRO_SD_READ_CACHE_FILES > 0
+    if (!read_cache_) {
+        read_cache_ = make_pmr<ReadHandleCache>(memory_);
+    }
+#endif
+#if MICRO_SD_DENTRY_CACHE_ENTRIES > 0
+    if (!dentry_cache_) {
+        dentry_cache_ = make_pmr<DentryCache>(memory_);
+    }
+#endif
+#if MICRO_SD_USAGE_CACHE_ENTRIES > 0
+    if (!usage_cache_) {
+        usage_cache_ = make_pmr<UsageCache>(memory_);
+    }
+#endif
+    
+    mount_time_us_ = Platform::now_us() - start_us;
     return Result<void>();
 }
 
 void RWSD::unmount_filesystem() {
+    // 卸载路径尽力而为，错误无处上报
+    if (files_) {
+        files_->close_all();
+    }
+    if (read_cache_) {
+        read_cache_->invalidate_all();
+    }
+    if (dentry_cache_) {
+        dentry_cache_->invalidate_all();
+    }
+    if (usage_cache_) {
+        usage_cache_->invalidate_all();
+    }
+    (void)write_fsinfo();
+    if (free_map_) {
+        free_map_->detach();
+    }
     f_unmount("");
+    if (cache_) {
+        (void)cache_->flush();
+    }
 }
 
 Result<void> RWSD::initialize() {
     if (is_initialized_) {
         return Result<void>();
     }
+    if (memory_ == nullptr) {
+        // 无堆模式下未提供内存资源
+        return Result<void>(ErrorCode::INVALID_PARAMETER, "未设置内存资源");
+    }
     
-    // 初始化SPI
-    initialize_spi();
-    
-    // 初始化SD卡硬件
-    DSTATUS status = disk_initialize(0);
-    if (status != 0) {
-        deinitialize_spi();
+    // 初始化块设备
+    auto device_result = initialize_device();
+    if (!device_result.is_ok()) {
         return Result<void>(ErrorCode::INIT_FAILED);
     }
     
     // 挂载文件系统
     auto mount_result = mount_filesystem();
     if (!mount_result.is_ok()) {
-        deinitialize_spi();
+        deinitialize_device();
         return mount_result;
     }
     
@@ -169,7 +441,7 @@ Result<void> RWSD::initialize() {
 
 // === 错误码转换 ===
 
-ErrorCode RWSD::fresult_to_error_code(FRESULT fr) const {
+ErrorCode RWSD::fresult_to_error_code(FRESULT fr) {
     switch (fr) {
         case FR_OK: return ErrorCode::SUCCESS;
         case FR_DISK_ERR: return ErrorCode::IO_ERROR;
@@ -212,10 +484,18 @@ Result<std::pair<size_t, size_t>> RWSD::get_capacity() const {
     }
     
     DWORD fre_clust, fre_sect, tot_sect;
-    FATFS* fs_ptr = const_cast<FATFS*>(&fs_);
-    FRESULT fr = f_getfree("", &fre_clust, &fs_ptr);
-    if (fr != FR_OK) {
-        return Result<std::pair<size_t, size_t>>(fresult_to_error_code(fr));
+    if (free_map_ && free_map_->is_complete()) {
+        // 常数时间: 由空闲簇索引提供
+        fre_clust = free_map_->free_clusters();
+    } else if (load_fsinfo()) {
+        // FatFs维护的空闲簇数 (来自FSINFO并随分配/释放更新)
+        fre_clust = fs_.free_clst;
+    } else {
+        FATFS* fs_ptr = const_cast<FATFS*>(&fs_);
+        FRESULT fr = f_getfree("", &fre_clust, &fs_ptr);
+        if (fr != FR_OK) {
+            return Result<std::pair<size_t, size_t>>(fresult_to_error_code(fr));
+        }
     }
     
     tot_sect = (fs_.n_fatent - 2) * fs_.csize;
@@ -229,45 +509,242 @@ Result<std::pair<size_t, size_t>> RWSD::get_capacity() const {
 
 // === 目录操作 ===
 
-Result<std::vector<FileInfo>> RWSD::list_directory(const std::string& path) {
-    if (!is_initialized_) {
-        return Result<std::vector<FileInfo>>(ErrorCode::INIT_FAILED);
+namespace {
+
+inline char upper_ascii(char c) {
+    return (c >= 'a' && c <= 'z') ? c - 'a' + 'A' : c;
+}
+
+// 通配符匹配 ('*'任意个字符，'?'一个字符)，不区分大小写
+bool match_pattern(const char* pattern, const char* name) {
+    const char* star = nullptr;
+    const char* resume = nullptr;
+    while (*name) {
+        if (*pattern == '*') {
+            star = pattern++;
+            resume = name;
+        } else if (*pattern == '?' || (*pattern && upper_ascii(*pattern) == upper_ascii(*name))) {
+            ++pattern;
+            ++name;
+        } else if (star) {
+            pattern = star + 1;
+            name = ++resume;
+        } else {
+            return false;
+        }
     }
-    
-    std::vector<FileInfo> files;
-    DIR dir;
-    FILINFO fno;
-    
-    FRESULT fr = f_opendir(&dir, path.c_str());
+    while (*pattern == '*') {
+        ++pattern;
+    }
+    return *pattern == '\0';
+}
+
+bool match_extension(const char* extension, const char* name) {
+    const char* dot = strrchr(name, '.');
+    const char* actual = dot ? dot + 1 : "";
+    for (; *extension && *actual; ++extension, ++actual) {
+        if (upper_ascii(*extension) != upper_ascii(*actual)) {
+            return false;
+        }
+    }
+    return *extension == *actual;
+}
+
+} // namespace
+
+RWSD::DirectoryIterator::DirectoryIterator() : index_(0), error_(ErrorCode::SUCCESS), open_(false) {
+    memset(&dir_, 0, sizeof(DIR));
+    entry_.fname[0] = '\0';
+}
+
+RWSD::DirectoryIterator::DirectoryIterator(DirectoryIterator&& other) noexcept
+    : dir_(other.dir_), entry_(other.entry_), filter_(other.filter_), index_(other.index_),
+      error_(other.error_), open_(other.open_) {
+    other.open_ = false;
+}
+
+RWSD::DirectoryIterator& RWSD::DirectoryIterator::operator=(DirectoryIterator&& other) noexcept {
+    if (this != &other) {
+        close();
+        dir_ = other.dir_;
+        entry_ = other.entry_;
+        filter_ = other.filter_;
+        index_ = other.index_;
+        error_ = other.error_;
+        open_ = other.open_;
+        other.open_ = false;
+    }
+    return *this;
+}
+
+void RWSD::DirectoryIterator::close() {
+    if (open_) {
+        f_closedir(&dir_);
+        open_ = false;
+    }
+}
+
+bool DirectoryFilter::matches(const char* name, uint8_t attributes) const {
+    if ((attributes & this->attributes) != this->attributes || (attributes & exclude_attributes) != 0) {
+        return false;
+    }
+    if (extension && !match_extension(extension, name)) {
+        return false;
+    }
+    return !pattern || match_pattern(pattern, name);
+}
+
+bool RWSD::DirectoryIterator::matches() const {
+    const char* name = entry_.fname;
+    if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+        return false;
+    }
+    return filter_.matches(name, entry_.fattrib);
+}
+
+Result<const FILINFO*> RWSD::DirectoryIterator::next() {
+    if (!open_) {
+        return Result<const FILINFO*>(ErrorCode::INIT_FAILED, "目录未打开");
+    }
+    while (true) {
+        FRESULT fr = f_readdir(&dir_, &entry_);
+        if (fr != FR_OK) {
+            error_ = fresult_to_error_code(fr);
+            return Result<const FILINFO*>(error_);
+        }
+        if (entry_.fname[0] == '\0') {
+            return Result<const FILINFO*>(nullptr);
+        }
+        ++index_;
+        if (matches()) {
+            return Result<const FILINFO*>(&entry_);
+        }
+    }
+}
+
+RWSD::DirectoryIterator::iterator RWSD::DirectoryIterator::begin() {
+    auto entry = next();
+    return iterator(entry.is_ok() && *entry ? this : nullptr);
+}
+
+RWSD::DirectoryIterator::iterator& RWSD::DirectoryIterator::iterator::operator++() {
+    auto entry = owner_->next();
+    if (!entry.is_ok() || *entry == nullptr) {
+        owner_ = nullptr;
+    }
+    return *this;
+}
+
+DirectoryCursor RWSD::DirectoryIterator::cursor() const {
+    DirectoryCursor cursor;
+    cursor.index = index_;
+    cursor.offset = dir_.dptr;
+    cursor.cluster = dir_.clust;
+    cursor.sector = dir_.sect;
+    cursor.start_cluster = dir_.obj.sclust;
+    cursor.volume_id = dir_.obj.id;
+    return cursor;
+}
+
+Result<void> RWSD::DirectoryIterator::rewind() {
+    if (!open_) {
+        return Result<void>(ErrorCode::INIT_FAILED, "目录未打开");
+    }
+    FRESULT fr = f_rewinddir(&dir_);
     if (fr != FR_OK) {
-        return Result<std::vector<FileInfo>>(fresult_to_error_code(fr));
+        return Result<void>(fresult_to_error_code(fr));
+    }
+    index_ = 0;
+    error_ = ErrorCode::SUCCESS;
+    return Result<void>();
+}
+
+Result<void> RWSD::DirectoryIterator::seek(const DirectoryCursor& cursor) {
+    auto result = rewind();
+    if (!result.is_ok()) {
+        return result;
     }
     
-    while (true) {
-        fr = f_readdir(&dir, &fno);
-        if (fr != FR_OK || fno.fname[0] == 0) {
-            break;
+    // 同一次挂载中的同一目录: 直接恢复读取位置 (与FatFs dir_sdi设置的字段一致)
+    if (cursor.volume_id == dir_.obj.id && cursor.start_cluster == dir_.obj.sclust) {
+        dir_.dptr = cursor.offset;
+        dir_.clust = cursor.cluster;
+        dir_.sect = cursor.sector;
+        dir_.dir = dir_.obj.fs->win + cursor.offset % BlockDevice::SECTOR_SIZE;
+        index_ = cursor.index;
+        return Result<void>();
+    }
+    
+    while (index_ < cursor.index) {
+        FRESULT fr = f_readdir(&dir_, &entry_);
+        if (fr != FR_OK) {
+            return Result<void>(fresult_to_error_code(fr));
         }
-        
-        // 跳过 "." 和 ".." 目录
-        if (strcmp(fno.fname, ".") == 0 || strcmp(fno.fname, "..") == 0) {
-            continue;
+        if (entry_.fname[0] == '\0') {
+            break;
         }
-        
+        ++index_;
+    }
+    return Result<void>();
+}
+
+Result<RWSD::DirectoryIterator> RWSD::open_directory(const std::string& path, const DirectoryFilter& filter) {
+    if (!is_initialized_) {
+        return Result<DirectoryIterator>(ErrorCode::INIT_FAILED);
+    }
+    
+    DirectoryIterator iterator;
+    FRESULT fr = f_opendir(&iterator.dir_, path.c_str());
+    if (fr != FR_OK) {
+        return Result<DirectoryIterator>(fresult_to_error_code(fr));
+    }
+    iterator.open_ = true;
+    iterator.filter_ = filter;
+    return Result<DirectoryIterator>(std::move(iterator));
+}
+
+Result<std::vector<FileInfo>> RWSD::list_directory(const std::string& path) {
+    auto directory = open_directory(path);
+    if (!directory.is_ok()) {
+        return Result<std::vector<FileInfo>>(directory.error_code());
+    }
+    
+    // 根目录 ("" 或 "/") 下的完整路径为 "/name"
+    std::string prefix = path;
+    if (prefix.empty() || prefix.back() != '/') {
+        prefix += '/';
+    }
+    
+    std::vector<FileInfo> files;
+    for (const FILINFO& fno : *directory) {
         FileInfo info;
         info.name = fno.fname;
-        info.full_path = path + "/" + fno.fname;
+        info.full_path = prefix + fno.fname;
         info.size = fno.fsize;
         info.is_directory = (fno.fattrib & AM_DIR) != 0;
-        
-        files.push_back(info);
+        info.attributes = fno.fattrib;
+        files.push_back(std::move(info));
     }
-    
-    f_closedir(&dir);
-    return Result<std::vector<FileInfo>>(files);
+    if (directory->error() != ErrorCode::SUCCESS) {
+        return Result<std::vector<FileInfo>>(directory->error());
+    }
+    return Result<std::vector<FileInfo>>(std::move(files));
+}
+
+Result<void> RWSD::print_tree(const std::string& path, TreePrinter& printer, int max_depth, bool sorted) const {
+    // 遍历器约1KB以上，不放在调用者的栈上
+    auto walker = make_pmr<TreeWalker>(memory_, *this);
+    WalkOptions options;
+    options.sorted = sorted;
+    options.max_depth = (uint8_t)std::min<int>(max_depth, TreeWalker::MAX_DEPTH);
+    auto walked = walker->walk(path, printer, options);
+    if (!walked.is_ok()) {
+        return Result<void>(walked.error_code(), walked.error_message());
+    }
+    return Result<void>(printer.error());
 }
 
-Result<std::string> RWSD::list_directory_tree(const std::string& path, int max_depth) const {
+Result<std::string> RWSD::list_directory_tree(const std::string& path, int max_depth, bool sorted) const {
     if (!is_initialized_) {
         return Result<std::string>(ErrorCode::INIT_FAILED);
     }
@@ -277,100 +754,137 @@ Result<std::string> RWSD::list_directory_tree(const std::string& path, int max_d
     }
     
     std::string result;
-    std::vector<FileInfo> files;
-    DIR dir;
-    FILINFO fno;
+    TreePrinter printer(result);
+    auto printed = print_tree(path, printer, max_depth, sorted);
+    if (!printed.is_ok()) {
+        return Result<std::string>(printed.error_code());
+    }
+    return Result<std::string>(std::move(result));
+}
+
+Result<void> RWSD::print_directory_tree(const std::string& path, FILE* stream, int max_depth, bool sorted) const {
+    if (!is_initialized_) {
+        return Result<void>(ErrorCode::INIT_FAILED);
+    }
+    if (stream == nullptr) {
+        return Result<void>(ErrorCode::INVALID_PARAMETER);
+    }
     
-    FRESULT fr = f_opendir(&dir, path.c_str());
-    if (fr != FR_OK) {
-        return Result<std::string>(fresult_to_error_code(fr));
+    if (max_depth <= 0) {
+        fputs("[达到最大深度限制]\n", stream);
+        return Result<void>();
     }
     
-    // 收集所有文件和目录
-    while (true) {
-        fr = f_readdir(&dir, &fno);
-        if (fr != FR_OK || fno.fname[0] == 0) {
-            break;
+    TreePrinter printer(stream);
+    return print_tree(path, printer, max_depth, sorted);
+}
+
+namespace {
+
+/**
+ * @brief 目录占用汇总接收器
+ * 每层一个累加器，目录的后序回调时其子树的汇总已完整，计入上一层并缓存
+ */
+class UsageSink : public WalkSink {
+private:
+    const RWSD& sd_;
+    UsageCache* cache_;
+    const OpenFileTable* files_;
+    uint32_t cluster_bytes_;
+    const RWSD::UsageVisitor& visit_;
+    uint8_t report_depth_;
+    DirectoryUsage levels_[TreeWalker::MAX_DEPTH + 1];  // levels_[d]: 深度为d的目录项所在目录的累计
+    ErrorCode error_;
+
+    void add_directory(const WalkEntry& entry, const DirectoryUsage& usage, bool cache) {
+        levels_[entry.depth] += usage;
+        ++levels_[entry.depth].directories;
+        // 含有正在写入的文件时目录项中的大小可能是旧的
+        if (cache && cache_ && !(files_ && files_->is_writing_under(entry.path))) {
+            cache_->insert(entry.path, usage);
         }
-        
-        // 跳过 "." 和 ".." 目录
-        if (strcmp(fno.fname, ".") == 0 || strcmp(fno.fname, "..") == 0) {
-            continue;
+        if (visit_ && entry.depth < report_depth_) {
+            visit_(entry.path, usage);
         }
-        
-        FileInfo info;
-        info.name = fno.fname;
-        info.full_path = path + "/" + fno.fname;
-        info.size = fno.fsize;
-        info.is_directory = (fno.fattrib & AM_DIR) != 0;
-        
-        files.push_back(info);
     }
-    
-    f_closedir(&dir);
-    
-    // 按名称排序
-    std::sort(files.begin(), files.end(), [](const FileInfo& a, const FileInfo& b) {
-        // 目录优先，然后按名称排序
-        if (a.is_directory != b.is_directory) {
-            return a.is_directory > b.is_directory;
+
+public:
+    UsageSink(const RWSD& sd, UsageCache* cache, const OpenFileTable* files, uint32_t cluster_bytes,
+              const RWSD::UsageVisitor& visit, uint8_t report_depth)
+        : sd_(sd), cache_(cache), files_(files), cluster_bytes_(cluster_bytes), visit_(visit),
+          report_depth_(report_depth), error_(ErrorCode::SUCCESS) {}
+
+    WalkAction enter(const WalkEntry& entry) override {
+        if (error_ != ErrorCode::SUCCESS) {
+            return WalkAction::STOP;
         }
-        return a.name < b.name;
-    });
-    
-    // 构建树形输出
-    for (size_t i = 0; i < files.size(); ++i) {
-        const auto& file = files[i];
-        bool is_last = (i == files.size() - 1);
-        
-        // 添加前缀
-        std::string prefix = (max_depth == 10) ? "" : std::string((10 - max_depth) * 2, ' ');
-        if (!prefix.empty()) {
-            prefix += (is_last ? "└── " : "├── ");
+        if (!entry.is_directory()) {
+            levels_[entry.depth] += file_usage(entry.size, cluster_bytes_);
+            return WalkAction::CONTINUE;
         }
-        
-        // 添加文件/目录图标和名称
-        std::string icon = file.is_directory ? "📁" : "📄";
-        result += prefix + icon + " " + file.name;
-        
-        // 添加文件大小信息
-        if (!file.is_directory && file.size > 0) {
-            if (file.size < 1024) {
-                result += " (" + std::to_string(file.size) + " B)";
-            } else if (file.size < 1024 * 1024) {
-                result += " (" + std::to_string(file.size / 1024) + " KB)";
-            } else {
-                result += " (" + std::to_string(file.size / (1024 * 1024)) + " MB)";
-            }
+        // 不需要报告其下的子目录时，已缓存的目录直接计入
+        DirectoryUsage cached;
+        if (entry.depth + 1 >= report_depth_ && cache_ && cache_->lookup(entry.path, cached)) {
+            add_directory(entry, cached, false);
+            return WalkAction::SKIP;
         }
-        result += "\n";
-        
-        // 递归处理子目录
-        if (file.is_directory) {
-            auto sub_result = list_directory_tree(file.full_path, max_depth - 1);
-            if (sub_result.is_ok()) {
-                std::string sub_prefix = (max_depth == 10) ? "" : std::string((10 - max_depth) * 2, ' ');
-                if (!sub_prefix.empty()) {
-                    sub_prefix += (is_last ? "    " : "│   ");
-                }
-                
-                // 为子目录的每一行添加前缀
-                std::string sub_content = *sub_result;
-                size_t pos = 0;
-                while ((pos = sub_content.find('\n', pos)) != std::string::npos) {
-                    if (pos > 0) {
-                        sub_content.insert(pos, sub_prefix);
-                        pos += sub_prefix.length() + 1;
-                    } else {
-                        pos++;
-                    }
-                }
-                result += sub_content;
-            }
+        levels_[entry.depth + 1] = DirectoryUsage();
+        return WalkAction::CONTINUE;
+    }
+
+    void leave(const WalkEntry& entry) override {
+        add_directory(entry, levels_[entry.depth + 1], true);
+    }
+
+    void depth_limit(const WalkEntry& entry) override {
+        // 超过遍历层数的目录用新的遍历器单独汇总
+        auto nested = sd_.disk_usage(entry.path);
+        if (!nested.is_ok()) {
+            error_ = nested.error_code();
+            return;
         }
+        add_directory(entry, *nested, false);
+    }
+
+    const DirectoryUsage& total() const { return levels_[0]; }
+    ErrorCode error() const { return error_; }
+};
+
+} // namespace
+
+Result<DirectoryUsage> RWSD::disk_usage(const std::string& path, const UsageVisitor& per_directory,
+                                        uint8_t report_depth) const {
+    if (!is_initialized_) {
+        return Result<DirectoryUsage>(ErrorCode::INIT_FAILED);
+    }
+    
+    DirectoryUsage usage;
+    if (report_depth == 0 && usage_cache_ && usage_cache_->lookup(path.c_str(), usage)) {
+        if (per_directory) {
+            per_directory(path.c_str(), usage);
+        }
+        return Result<DirectoryUsage>(usage);
+    }
+    
+    // 遍历器约1KB以上，不放在调用者的栈上
+    auto walker = make_pmr<TreeWalker>(memory_, *this);
+    UsageSink sink(*this, usage_cache_.get(), files_.get(), cluster_bytes(), per_directory, report_depth);
+    auto walked = walker->walk(path, sink);
+    if (!walked.is_ok()) {
+        return Result<DirectoryUsage>(walked.error_code(), walked.error_message());
+    }
+    if (sink.error() != ErrorCode::SUCCESS) {
+        return Result<DirectoryUsage>(sink.error());
     }
     
-    return Result<std::string>(result);
+    usage = sink.total();
+    if (usage_cache_ && !(files_ && files_->is_writing_under(path.c_str()))) {
+        usage_cache_->insert(path.c_str(), usage);
+    }
+    if (per_directory) {
+        per_directory(path.c_str(), usage);
+    }
+    return Result<DirectoryUsage>(usage);
 }
 
 Result<void> RWSD::create_directory(const std::string& path) {
@@ -378,6 +892,8 @@ Result<void> RWSD::create_directory(const std::string& path) {
         return Result<void>(ErrorCode::INIT_FAILED);
     }
     
+    UsageUpdate usage(*this, path);
+    invalidate_path(path);
     FRESULT fr = f_mkdir(path.c_str());
     return Result<void>(fresult_to_error_code(fr));
 }
@@ -387,7 +903,12 @@ Result<void> RWSD::remove_directory(const std::string& path) {
         return Result<void>(ErrorCode::INIT_FAILED);
     }
     
+    UsageUpdate usage(*this, path);
+    invalidate_path(path);
     FRESULT fr = f_rmdir(path.c_str());
+    if (fr == FR_OK) {
+        notify_change(FileChange::REMOVED, path);
+    }
     return Result<void>(fresult_to_error_code(fr));
 }
 
@@ -397,8 +918,7 @@ bool RWSD::file_exists(const std::string& path) const {
     }
     
     FILINFO fno;
-    FRESULT fr = f_stat(path.c_str(), &fno);
-    return fr == FR_OK;
+    return stat_path(path, fno) == FR_OK;
 }
 
 Result<FileInfo> RWSD::get_file_info(const std::string& path) const {
@@ -407,7 +927,7 @@ Result<FileInfo> RWSD::get_file_info(const std::string& path) const {
     }
     
     FILINFO fno;
-    FRESULT fr = f_stat(path.c_str(), &fno);
+    FRESULT fr = stat_path(path, fno);
     if (fr != FR_OK) {
         return Result<FileInfo>(fresult_to_error_code(fr));
     }
@@ -428,73 +948,122 @@ Result<std::vector<uint8_t>> RWSD::read_file(const std::string& path) const {
         return Result<std::vector<uint8_t>>(ErrorCode::INIT_FAILED);
     }
     
-    FIL file;
-    FRESULT fr = f_open(&file, path.c_str(), FA_READ);
+    // 大小取自目录项缓存，内容经由read_file_into读取 (复用只读句柄缓存)
+    FILINFO fno;
+    FRESULT fr = stat_path(path, fno);
     if (fr != FR_OK) {
         return Result<std::vector<uint8_t>>(fresult_to_error_code(fr));
     }
     
-    UINT bytes_read;
-    std::vector<uint8_t> data(f_size(&file));
-    
-    fr = f_read(&file, data.data(), f_size(&file), &bytes_read);
-    f_close(&file);
-    
-    if (fr != FR_OK) {
-        return Result<std::vector<uint8_t>>(fresult_to_error_code(fr));
+    std::vector<uint8_t> data(fno.fsize);
+    auto result = read_file_into(path, data.data(), data.size());
+    if (!result.is_ok()) {
+        return Result<std::vector<uint8_t>>(result.error_code());
     }
     
-    data.resize(bytes_read);
-    return Result<std::vector<uint8_t>>(data);
+    data.resize(*result);
+    return Result<std::vector<uint8_t>>(std::move(data));
 }
 
 Result<std::vector<uint8_t>> RWSD::read_file_chunk(const std::string& path, 
                                                    size_t offset, size_t size) const {
+    std::vector<uint8_t> data(size);
+    auto result = read_file_into(path, data.data(), size, offset);
+    if (!result.is_ok()) {
+        return Result<std::vector<uint8_t>>(result.error_code());
+    }
+    
+    data.resize(*result);
+    return Result<std::vector<uint8_t>>(std::move(data));
+}
+
+Result<size_t> RWSD::read_file_into(const std::string& path, void* buffer, size_t capacity,
+                                    size_t offset) const {
     if (!is_initialized_) {
-        return Result<std::vector<uint8_t>>(ErrorCode::INIT_FAILED);
+        return Result<size_t>(ErrorCode::INIT_FAILED);
+    }
+    if (buffer == nullptr && capacity > 0) {
+        return Result<size_t>(ErrorCode::INVALID_PARAMETER);
     }
     
-    FIL file;
-    FRESULT fr = f_open(&file, path.c_str(), FA_READ);
-    if (fr != FR_OK) {
-        return Result<std::vector<uint8_t>>(fresult_to_error_code(fr));
+    // 复用缓存的只读句柄；同一文件正以写入方式打开时其内容可能尚未落盘，绕过缓存
+    FRESULT fr = FR_OK;
+    FIL* cached = nullptr;
+    if (read_cache_ && !(files_ && files_->is_open_for_write(path.c_str()))) {
+        cached = read_cache_->acquire(path.c_str(), fr);
+        if (fr != FR_OK) {
+            return Result<size_t>(fresult_to_error_code(fr));
+        }
     }
     
-    fr = f_lseek(&file, offset);
-    if (fr != FR_OK) {
-        f_close(&file);
-        return Result<std::vector<uint8_t>>(fresult_to_error_code(fr));
+    FIL local;
+    FIL* file = cached;
+    if (file == nullptr) {
+        fr = f_open(&local, path.c_str(), FA_READ);
+        if (fr != FR_OK) {
+            return Result<size_t>(fresult_to_error_code(fr));
+        }
+        file = &local;
     }
     
-    UINT bytes_read;
-    std::vector<uint8_t> data(size);
+    // 缓存的句柄位置任意；向后定位时FatFs从当前簇继续
+    if (offset > 0 || cached) {
+        fr = f_lseek(file, offset);
+    }
     
-    fr = f_read(&file, data.data(), size, &bytes_read);
-    f_close(&file);
+    UINT bytes_read = 0;
+    if (fr == FR_OK) {
+        fr = f_read(file, buffer, capacity, &bytes_read);
+    }
+    if (cached == nullptr) {
+        f_close(&local);
+    } else if (fr != FR_OK) {
+        read_cache_->release_on_error(cached);
+    }
     
     if (fr != FR_OK) {
-        return Result<std::vector<uint8_t>>(fresult_to_error_code(fr));
+        return Result<size_t>(fresult_to_error_code(fr));
     }
     
-    data.resize(bytes_read);
-    return Result<std::vector<uint8_t>>(data);
+    return Result<size_t>(bytes_read);
 }
 
 Result<std::string> RWSD::read_text_file(const std::string& path) const {
-    auto result = read_file(path);
+    if (!is_initialized_) {
+        return Result<std::string>(ErrorCode::INIT_FAILED);
+    }
+    
+    FILINFO fno;
+    FRESULT fr = stat_path(path, fno);
+    if (fr != FR_OK) {
+        return Result<std::string>(fresult_to_error_code(fr));
+    }
+    
+    // 直接读入字符串，避免经过临时vector再复制一次
+    std::string text(fno.fsize, '\0');
+    auto result = read_file_into(path, &text[0], text.size());
     if (!result.is_ok()) {
         return Result<std::string>(result.error_code());
     }
     
-    std::string text(reinterpret_cast<const char*>(result->data()), result->size());
-    return Result<std::string>(text);
+    text.resize(*result);
+    return Result<std::string>(std::move(text));
 }
 
 Result<void> RWSD::write_file(const std::string& path, const std::vector<uint8_t>& data) {
+    return write_file(path, data.data(), data.size());
+}
+
+Result<void> RWSD::write_file(const std::string& path, const void* data, size_t size) {
     if (!is_initialized_) {
         return Result<void>(ErrorCode::INIT_FAILED);
     }
+    if (data == nullptr && size > 0) {
+        return Result<void>(ErrorCode::INVALID_PARAMETER);
+    }
     
+    UsageUpdate usage(*this, path);
+    invalidate_path(path);
     FIL file;
     FRESULT fr = f_open(&file, path.c_str(), FA_WRITE | FA_CREATE_ALWAYS);
     if (fr != FR_OK) {
@@ -502,73 +1071,481 @@ Result<void> RWSD::write_file(const std::string& path, const std::vector<uint8_t
     }
     
     UINT bytes_written;
-    fr = f_write(&file, data.data(), data.size(), &bytes_written);
-    f_close(&file);
+    fr = f_write(&file, data, size, &bytes_written);
+    FRESULT close_fr = f_close(&file);
     
     if (fr != FR_OK) {
         return Result<void>(fresult_to_error_code(fr));
     }
+    if (bytes_written < size) {
+        return Result<void>(ErrorCode::DISK_FULL);
+    }
+    if (close_fr != FR_OK) {
+        return Result<void>(fresult_to_error_code(close_fr));
+    }
     
+    // 写入和关闭都成功后才通知，监听器看到的是完整的文件
+    notify_change(FileChange::CREATED, path);
     return Result<void>();
 }
 
-Result<void> RWSD::write_text_file(const std::string& path, const std::string& content) {
-    std::vector<uint8_t> data(content.begin(), content.end());
-    return write_file(path, data);
+Result<void> RWSD::write_text_file(const std::string& path, std::string_view content) {
+    return write_file(path, content.data(), content.size());
 }
 
 Result<void> RWSD::append_file(const std::string& path, const std::vector<uint8_t>& data) {
+    return append_file(path, data.data(), data.size());
+}
+
+Result<void> RWSD::append_file(const std::string& path, const void* data, size_t size) {
     if (!is_initialized_) {
         return Result<void>(ErrorCode::INIT_FAILED);
     }
+    if (data == nullptr && size > 0) {
+        return Result<void>(ErrorCode::INVALID_PARAMETER);
+    }
     
+    UsageUpdate usage(*this, path);
+    invalidate_path(path);
     FIL file;
     FRESULT fr = f_open(&file, path.c_str(), FA_WRITE | FA_OPEN_APPEND);
     if (fr != FR_OK) {
-        return Result<void>(fresult_to_error_code(fr));
+        return Result<void>(fresult_to_error_code(fr));
+    }
+    
+    UINT bytes_written;
+    fr = f_write(&file, data, size, &bytes_written);
+    FRESULT close_fr = f_close(&file);
+    
+    if (fr != FR_OK) {
+        return Result<void>(fresult_to_error_code(fr));
+    }
+    if (bytes_written < size) {
+        return Result<void>(ErrorCode::DISK_FULL);
+    }
+    if (close_fr != FR_OK) {
+        return Result<void>(fresult_to_error_code(close_fr));
+    }
+    
+    // 写入和关闭都成功后才通知，监听器看到的是完整的文件
+    notify_change(FileChange::CREATED, path);
+    return Result<void>();
+}
+
+Result<void> RWSD::append_text_file(const std::string& path, std::string_view content) {
+    return append_file(path, content.data(), content.size());
+}
+
+// === 原子写入 ===
+
+namespace {
+
+constexpr const char* ATOMIC_TEMP_SUFFIX = ".tmp";      // 正在写入，内容未经证实
+constexpr const char* ATOMIC_COMMIT_SUFFIX = ".new";    // 已完整落盘，等待替换原文件
+
+} // namespace
+
+Result<void> RWSD::write_barrier() {
+    // 缓存不响应CTRL_SYNC (honor_device_sync为false) 时，f_close/f_rename的同步
+    // 不会落盘，需要显式回写才能保证临时文件先于目录项修改写入卡
+    if (cache_) {
+        return cache_->flush();
+    }
+    return Result<void>();
+}
+
+Result<void> RWSD::write_file_atomic(const std::string& path, const void* data, size_t size) {
+    if (!is_initialized_) {
+        return Result<void>(ErrorCode::INIT_FAILED);
+    }
+    if (data == nullptr && size > 0) {
+        return Result<void>(ErrorCode::INVALID_PARAMETER);
+    }
+    if (files_ && files_->is_open_for_write(path.c_str())) {
+        return Result<void>(ErrorCode::PERMISSION_DENIED);
+    }
+    
+    // 上次中断的提交留下的path.new比path新，先换上，免得下面的提交把它当作残留
+    auto recovered = recover_file(path);
+    if (!recovered.is_ok()) {
+        return Result<void>(recovered.error_code());
+    }
+    
+    // 1. 写入并关闭临时文件 (f_close同步数据和目录项)
+    std::string temp_path = path + ATOMIC_TEMP_SUFFIX;
+    {
+        UsageUpdate temp_usage(*this, temp_path);
+        invalidate_path(temp_path);
+        FIL file;
+        FRESULT fr = f_open(&file, temp_path.c_str(), FA_WRITE | FA_CREATE_ALWAYS);
+        if (fr != FR_OK) {
+            return Result<void>(fresult_to_error_code(fr));
+        }
+        UINT bytes_written = 0;
+        fr = f_write(&file, data, size, &bytes_written);
+        FRESULT close_fr = f_close(&file);
+        if (fr == FR_OK && bytes_written < size) {
+            fr = FR_DENIED;  // 磁盘已满
+        }
+        if (fr == FR_OK) {
+            fr = close_fr;
+        }
+        if (fr != FR_OK) {
+            f_unlink(temp_path.c_str());
+            return Result<void>(fr == FR_DENIED ? ErrorCode::DISK_FULL : fresult_to_error_code(fr));
+        }
+    }
+    
+    // 2. 提交
+    return replace_file(path, temp_path);
+}
+
+Result<void> RWSD::write_file_atomic(const std::string& path, std::string_view content) {
+    return write_file_atomic(path, content.data(), content.size());
+}
+
+Result<void> RWSD::replace_file(const std::string& path, const std::string& source) {
+    if (!is_initialized_) {
+        return Result<void>(ErrorCode::INIT_FAILED);
+    }
+    if (files_ && (files_->is_open_for_write(path.c_str()) || files_->is_open_for_write(source.c_str()))) {
+        return Result<void>(ErrorCode::PERMISSION_DENIED);
+    }
+    
+    std::string commit_path = path + ATOMIC_COMMIT_SUFFIX;
+    UsageUpdate usage(*this, path);
+    UsageUpdate source_usage(*this, source);
+    UsageUpdate commit_usage(*this, commit_path);
+    invalidate_path(path);
+    invalidate_path(source);
+    invalidate_path(commit_path);
+    
+    // source的数据和目录项先于任何目录修改落盘
+    auto result = write_barrier();
+    if (!result.is_ok()) {
+        return result;
+    }
+    
+    FILINFO info;
+    FRESULT fr = f_stat(path.c_str(), &info);
+    if (fr == FR_NO_FILE) {
+        // 没有原文件可丢: 直接重命名。此前掉电只会留下source，不会被当作新内容
+        fr = f_rename(source.c_str(), path.c_str());
+    } else if (fr == FR_OK) {
+        // FAT不支持覆盖式重命名。先改为提交名并落盘，证明内容完整，之后才能删除原文件；
+        // 删除和最后的重命名也分开落盘，因为缓存回写不保证两个目录扇区的先后
+        fr = f_rename(source.c_str(), commit_path.c_str());
+        if (fr == FR_OK) {
+            result = write_barrier();
+            if (!result.is_ok()) {
+                return result;
+            }
+            fr = f_unlink(path.c_str());
+        }
+        if (fr == FR_OK) {
+            result = write_barrier();
+            if (!result.is_ok()) {
+                return result;
+            }
+            fr = f_rename(commit_path.c_str(), path.c_str());
+        }
+    }
+    if (fr != FR_OK) {
+        return Result<void>(fresult_to_error_code(fr));
+    }
+    notify_change(FileChange::CREATED, path);
+    return write_barrier();
+}
+
+Result<bool> RWSD::recover_file(const std::string& path) {
+    if (!is_initialized_) {
+        return Result<bool>(ErrorCode::INIT_FAILED);
+    }
+    
+    std::string temp_path = path + ATOMIC_TEMP_SUFFIX;
+    std::string commit_path = path + ATOMIC_COMMIT_SUFFIX;
+    UsageUpdate usage(*this, path);
+    UsageUpdate temp_usage(*this, temp_path);
+    UsageUpdate commit_usage(*this, commit_path);
+    invalidate_path(path);
+    invalidate_path(temp_path);
+    invalidate_path(commit_path);
+    
+    // 临时文件可能在写入中途掉电 (首次写入时path也不存在)，无法证明完整，一律删除
+    FRESULT fr = f_unlink(temp_path.c_str());
+    if (fr != FR_OK && fr != FR_NO_FILE && fr != FR_NO_PATH) {
+        return Result<bool>(fresult_to_error_code(fr));
+    }
+    
+    // 提交名只在内容落盘之后出现: 完成被中断的替换
+    FILINFO info;
+    fr = f_stat(commit_path.c_str(), &info);
+    if (fr == FR_NO_FILE || fr == FR_NO_PATH) {
+        return Result<bool>(false);
+    }
+    if (fr != FR_OK) {
+        return Result<bool>(fresult_to_error_code(fr));
+    }
+    fr = f_unlink(path.c_str());
+    if (fr != FR_OK && fr != FR_NO_FILE) {
+        return Result<bool>(fresult_to_error_code(fr));
+    }
+    auto result = write_barrier();
+    if (!result.is_ok()) {
+        return Result<bool>(result.error_code());
+    }
+    fr = f_rename(commit_path.c_str(), path.c_str());
+    if (fr != FR_OK) {
+        return Result<bool>(fresult_to_error_code(fr));
+    }
+    notify_change(FileChange::CREATED, path);
+    result = write_barrier();
+    if (!result.is_ok()) {
+        return Result<bool>(result.error_code());
+    }
+    return Result<bool>(true);
+}
+
+Result<void> RWSD::reserve_space(FIL* fp, FSIZE_t size, bool contiguous) {
+    if (f_size(fp) >= size) {
+        return Result<void>();
+    }
+    
+    // 连续分配只能用于空文件 (f_expand)；FatFs从last_clst开始线性查找连续空闲簇，
+    // 空闲簇索引完整时直接从一段完全空闲的区域开始，避免扫描整个FAT
+    if (f_size(fp) == 0) {
+        uint32_t cluster_bytes = fs_.csize * BlockDevice::SECTOR_SIZE;
+        uint32_t run = free_map_ ? free_map_->find_free_run((size + cluster_bytes - 1) / cluster_bytes) : 0;
+        if (run != 0) {
+            fs_.last_clst = run;
+        }
+        FRESULT fr = f_expand(fp, size, 1);
+        if (fr == FR_OK) {
+            return Result<void>();
+        }
+        if (contiguous) {
+            return Result<void>(fr == FR_DENIED ? ErrorCode::DISK_FULL : fresult_to_error_code(fr));
+        }
+    } else if (contiguous) {
+        return Result<void>(ErrorCode::INVALID_PARAMETER, "连续预分配只适用于空文件");
+    }
+    
+    // 普通簇链: 定位到末尾之后，FatFs逐簇扩展簇链
+    FSIZE_t position = f_tell(fp);
+    FSIZE_t old_size = f_size(fp);
+    FRESULT fr = f_lseek(fp, size);
+    if (fr == FR_OK && f_tell(fp) != size) {
+        // 空间不足: 撤销已扩展的部分
+        fr = f_lseek(fp, old_size);
+        if (fr == FR_OK) {
+            fr = f_truncate(fp);
+        }
+        (void)f_lseek(fp, position);
+        return Result<void>(fr == FR_OK ? ErrorCode::DISK_FULL : fresult_to_error_code(fr));
+    }
+    if (fr == FR_OK) {
+        fr = f_lseek(fp, position);
+    }
+    return Result<void>(fresult_to_error_code(fr));
+}
+
+Result<void> RWSD::preallocate(const std::string& path, size_t bytes, bool contiguous) {
+    if (!is_initialized_) {
+        return Result<void>(ErrorCode::INIT_FAILED);
+    }
+    if (files_ && files_->is_open_for_write(path.c_str())) {
+        return Result<void>(ErrorCode::PERMISSION_DENIED);
+    }
+    
+    UsageUpdate usage(*this, path);
+    invalidate_path(path);
+    FIL file;
+    FRESULT fr = f_open(&file, path.c_str(), FA_WRITE | FA_OPEN_ALWAYS);
+    if (fr != FR_OK) {
+        return Result<void>(fresult_to_error_code(fr));
+    }
+    
+    auto result = reserve_space(&file, bytes, contiguous);
+    FRESULT close_fr = f_close(&file);
+    if (!result.is_ok()) {
+        return result;
+    }
+    if (close_fr != FR_OK) {
+        return Result<void>(fresult_to_error_code(close_fr));
+    }
+    notify_change(FileChange::CREATED, path);
+    return Result<void>();
+}
+
+Result<void> RWSD::delete_file(const std::string& path) {
+    if (!is_initialized_) {
+        return Result<void>(ErrorCode::INIT_FAILED);
+    }
+    
+    UsageUpdate usage(*this, path);
+    invalidate_path(path);
+    FRESULT fr = f_unlink(path.c_str());
+    if (fr == FR_OK) {
+        notify_change(FileChange::REMOVED, path);
+    }
+    return Result<void>(fresult_to_error_code(fr));
+}
+
+Result<void> RWSD::rename(const std::string& old_path, const std::string& new_path) {
+    if (!is_initialized_) {
+        return Result<void>(ErrorCode::INIT_FAILED);
+    }
+    
+    // 任一侧被汇总包含时两侧都要记录，才能判断移动的是否为目录
+    bool tracked = usage_cache_ && (usage_cache_->covers(old_path.c_str()) || usage_cache_->covers(new_path.c_str()));
+    UsageUpdate old_usage(*this, old_path, tracked);
+    UsageUpdate new_usage(*this, new_path, tracked);
+    
+    // 重命名目录会改变其下所有文件的路径
+    if (read_cache_) {
+        read_cache_->invalidate_all();
+    }
+    if (dentry_cache_) {
+        dentry_cache_->invalidate(old_path.c_str());
+        dentry_cache_->invalidate(new_path.c_str());
+    }
+    FRESULT fr = f_rename(old_path.c_str(), new_path.c_str());
+    if (fr == FR_OK) {
+        // 移动的目录的内容不在差值中，两侧包含它的汇总失效
+        if (old_usage.was_directory() && usage_cache_) {
+            usage_cache_->invalidate(old_path.c_str());
+            usage_cache_->invalidate(new_path.c_str());
+        }
+        notify_change(FileChange::RENAMED, old_path, new_path.c_str());
+    }
+    return Result<void>(fresult_to_error_code(fr));
+}
+
+Result<void> RWSD::copy_file(const std::string& src_path, const std::string& dst_path) {
+    auto copy_result = copy_file(src_path, dst_path, CopyOptions());
+    if (!copy_result.is_ok()) {
+        return Result<void>(copy_result.error_code());
+    }
+    return Result<void>();
+}
+
+Result<CopyProgress> RWSD::copy_file(const std::string& src_path, const std::string& dst_path,
+                                     const CopyOptions& options) {
+    if (!is_initialized_) {
+        return Result<CopyProgress>(ErrorCode::INIT_FAILED);
+    }
+    
+    // 缓冲区按整扇区使用，使FatFs直接以多块传输读写用户缓冲区
+    size_t buffer_size = options.buffer_size / BlockDevice::SECTOR_SIZE * BlockDevice::SECTOR_SIZE;
+    if (buffer_size == 0) {
+        return Result<CopyProgress>(ErrorCode::INVALID_PARAMETER);
+    }
+    if (files_ && files_->is_open_for_write(dst_path.c_str())) {
+        return Result<CopyProgress>(ErrorCode::PERMISSION_DENIED);
+    }
+    std::pmr::vector<uint8_t> owned_buffer(memory_);
+    uint8_t* buffer = options.buffer;
+    if (buffer == nullptr) {
+        owned_buffer.resize(buffer_size);
+        buffer = owned_buffer.data();
+    }
+    
+    FIL src;
+    FRESULT fr = f_open(&src, src_path.c_str(), FA_READ);
+    if (fr != FR_OK) {
+        return Result<CopyProgress>(fresult_to_error_code(fr));
+    }
+    
+    // 目标以FA_CREATE_ALWAYS打开会截断文件，先按目录项位置确认不是源文件本身
+    // (路径可能只是大小写、分隔符或长短文件名不同)
+    FIL dst;
+    if (f_open(&dst, dst_path.c_str(), FA_READ) == FR_OK) {
+        bool same_file = dst.dir_sect == src.dir_sect && dst.dir_ptr == src.dir_ptr;
+        f_close(&dst);
+        if (same_file) {
+            f_close(&src);
+            return Result<CopyProgress>(ErrorCode::INVALID_PARAMETER, "源和目标是同一文件");
+        }
+    }
+    
+    UsageUpdate usage(*this, dst_path);
+    invalidate_path(dst_path);
+    fr = f_open(&dst, dst_path.c_str(), FA_WRITE | FA_CREATE_ALWAYS);
+    if (fr != FR_OK) {
+        f_close(&src);
+        return Result<CopyProgress>(fresult_to_error_code(fr));
     }
     
-    UINT bytes_written;
-    fr = f_write(&file, data.data(), data.size(), &bytes_written);
-    f_close(&file);
+    CopyProgress progress;
+    progress.total_bytes = f_size(&src);
+    uint64_t start_us = Platform::now_us();
     
-    if (fr != FR_OK) {
-        return Result<void>(fresult_to_error_code(fr));
+    // 预分配: 优先连续簇 (写入时无需在数据和FAT之间来回切换)，否则一次性扩展簇链
+    if (options.preallocate && progress.total_bytes > 0) {
+        auto reserved = reserve_space(&dst, progress.total_bytes, false);
+        if (!reserved.is_ok()) {
+            f_close(&src);
+            f_close(&dst);
+            return Result<CopyProgress>(reserved.error_code());
+        }
     }
     
-    return Result<void>();
-}
-
-Result<void> RWSD::append_text_file(const std::string& path, const std::string& content) {
-    std::vector<uint8_t> data(content.begin(), content.end());
-    return append_file(path, data);
-}
-
-Result<void> RWSD::delete_file(const std::string& path) {
-    if (!is_initialized_) {
-        return Result<void>(ErrorCode::INIT_FAILED);
+    bool cancelled = false;
+    bool disk_full = false;
+    while (fr == FR_OK && progress.bytes_copied < progress.total_bytes) {
+        UINT bytes_read = 0;
+        fr = f_read(&src, buffer, buffer_size, &bytes_read);
+        if (fr != FR_OK || bytes_read == 0) {
+            break;
+        }
+        UINT bytes_written = 0;
+        fr = f_write(&dst, buffer, bytes_read, &bytes_written);
+        if (fr != FR_OK) {
+            break;
+        }
+        if (bytes_written < bytes_read) {
+            disk_full = true;  // 没有空闲簇时FatFs只写入一部分
+            break;
+        }
+        
+        progress.bytes_copied += bytes_written;
+        progress.elapsed_us = Platform::now_us() - start_us;
+        if (options.on_progress && !options.on_progress(progress)) {
+            cancelled = true;
+            break;
+        }
     }
     
-    FRESULT fr = f_unlink(path.c_str());
-    return Result<void>(fresult_to_error_code(fr));
-}
-
-Result<void> RWSD::rename(const std::string& old_path, const std::string& new_path) {
-    if (!is_initialized_) {
-        return Result<void>(ErrorCode::INIT_FAILED);
+    // 中途失败时去掉预分配的尾部
+    if (fr == FR_OK && progress.bytes_copied < progress.total_bytes) {
+        fr = f_truncate(&dst);
+    }
+    f_close(&src);
+    FRESULT close_fr = f_close(&dst);
+    if (fr == FR_OK) {
+        fr = close_fr;
     }
     
-    FRESULT fr = f_rename(old_path.c_str(), new_path.c_str());
-    return Result<void>(fresult_to_error_code(fr));
-}
-
-Result<void> RWSD::copy_file(const std::string& src_path, const std::string& dst_path) {
-    auto read_result = read_file(src_path);
-    if (!read_result.is_ok()) {
-        return Result<void>(read_result.error_code());
+    if (cancelled || disk_full || fr != FR_OK) {
+        f_unlink(dst_path.c_str());
+        if (cancelled) {
+            return Result<CopyProgress>(ErrorCode::CANCELLED);
+        }
+        return Result<CopyProgress>(disk_full && fr == FR_OK ? ErrorCode::DISK_FULL : fresult_to_error_code(fr));
+    }
+    
+    if (options.preserve_attributes) {
+        FILINFO fno;
+        if (f_stat(src_path.c_str(), &fno) == FR_OK) {
+            progress.attributes_preserved =
+                f_utime(dst_path.c_str(), &fno) == FR_OK &&
+                f_chmod(dst_path.c_str(), fno.fattrib, AM_RDO | AM_HID | AM_SYS | AM_ARC) == FR_OK;
+        }
     }
     
-    return write_file(dst_path, *read_result);
+    notify_change(FileChange::CREATED, dst_path);
+    progress.elapsed_us = Platform::now_us() - start_us;
+    return Result<CopyProgress>(progress);
 }
 
 Result<void> RWSD::sync() {
@@ -577,23 +1554,30 @@ Result<void> RWSD::sync() {
     }
     
     // 同步所有打开的文件
-    f_sync(nullptr);
-    return Result<void>();
+    if (files_) {
+        FRESULT fr = files_->sync_all();
+        if (fr != FR_OK) {
+            return Result<void>(fresult_to_error_code(fr));
+        }
+    }
+    
+    auto fsinfo_result = write_fsinfo();
+    if (!fsinfo_result.is_ok()) {
+        return fsinfo_result;
+    }
+    
+    // 回写扇区缓存
+    if (cache_) {
+        return cache_->flush();
+    }
+    return device_->sync();
 }
 
 // === 文件句柄类实现 ===
 
-RWSD::FileHandle::FileHandle(FileHandle&& other) noexcept 
-    : file_(other.file_), is_open_(other.is_open_), 
-      path_(std::move(other.path_)), mode_(std::move(other.mode_)) {
-    other.is_open_ = false;
-}
+namespace {
 
-Result<void> RWSD::FileHandle::open(const std::string& path, const std::string& mode) {
-    if (is_open_) {
-        close();
-    }
-    
+BYTE mode_to_flags(const std::string& mode) {
     BYTE flags = 0;
     if (mode.find('r') != std::string::npos) flags |= FA_READ;
     if (mode.find('w') != std::string::npos) flags |= FA_WRITE;
@@ -607,142 +1591,530 @@ Result<void> RWSD::FileHandle::open(const std::string& path, const std::string&
     } else {
         flags |= FA_OPEN_EXISTING;
     }
-    
-    FRESULT fr = f_open(&file_, path.c_str(), flags);
-    if (fr != FR_OK) {
-        return Result<void>(static_cast<ErrorCode>(fr));
+    return flags;
+}
+
+} // namespace
+
+RWSD::FileHandle::FileHandle(FileHandle&& other) noexcept 
+    : table_(other.table_), slot_(other.slot_), generation_(other.generation_) {
+    other.table_ = nullptr;
+}
+
+RWSD::FileHandle& RWSD::FileHandle::operator=(FileHandle&& other) noexcept {
+    if (this != &other) {
+        close();
+        table_ = other.table_;
+        slot_ = other.slot_;
+        generation_ = other.generation_;
+        other.table_ = nullptr;
     }
-    
-    is_open_ = true;
-    path_ = path;
-    mode_ = mode;
-    
-    return Result<void>();
+    return *this;
+}
+
+OpenFileTable::Slot* RWSD::FileHandle::slot() const {
+    return table_ ? table_->get(slot_, generation_) : nullptr;
+}
+
+FIL* RWSD::FileHandle::file() const {
+    OpenFileTable::Slot* entry = slot();
+    return entry ? &entry->file : nullptr;
+}
+
+std::string_view RWSD::FileHandle::get_path() const {
+    const OpenFileTable::Slot* slot = table_ ? table_->get(slot_, generation_) : nullptr;
+    return slot ? std::string_view(slot->path) : std::string_view();
+}
+
+std::string_view RWSD::FileHandle::get_mode() const {
+    const OpenFileTable::Slot* slot = table_ ? table_->get(slot_, generation_) : nullptr;
+    return slot ? std::string_view(slot->mode) : std::string_view();
+}
+
+FastSeekInfo RWSD::FileHandle::fast_seek_info() const {
+    FastSeekInfo info;
+    const OpenFileTable::Slot* slot = table_ ? table_->get(slot_, generation_) : nullptr;
+    if (slot != nullptr && slot->link_map != nullptr) {
+        // 映射表: [大小, (片段长度, 起始簇)..., 0]，第一个元素建表后为实际使用的字数
+        info.enabled = true;
+        info.fragments = (slot->link_map[0] - 2) / 2;
+        info.table_bytes = slot->link_map_words * sizeof(DWORD);
+    }
+    return info;
 }
 
 void RWSD::FileHandle::close() {
-    if (is_open_) {
-        f_close(&file_);
-        is_open_ = false;
-        path_.clear();
-        mode_.clear();
+    if (table_) {
+        table_->close(slot_, generation_);
+        table_ = nullptr;
     }
 }
 
 Result<std::vector<uint8_t>> RWSD::FileHandle::read(size_t size) {
-    if (!is_open_) {
-        return Result<std::vector<uint8_t>>(ErrorCode::INVALID_PARAMETER);
+    std::vector<uint8_t> data(size);
+    auto result = read_into(data.data(), size);
+    if (!result.is_ok()) {
+        return Result<std::vector<uint8_t>>(result.error_code());
     }
     
-    std::vector<uint8_t> data(size);
-    UINT bytes_read;
+    data.resize(*result);
+    return Result<std::vector<uint8_t>>(std::move(data));
+}
+
+Result<size_t> RWSD::FileHandle::read_into(void* buffer, size_t size) {
+    FIL* fp = file();
+    if (fp == nullptr || (buffer == nullptr && size > 0)) {
+        return Result<size_t>(ErrorCode::INVALID_PARAMETER);
+    }
     
-    FRESULT fr = f_read(&file_, data.data(), size, &bytes_read);
+    UINT bytes_read;
+    FRESULT fr = f_read(fp, buffer, size, &bytes_read);
     if (fr != FR_OK) {
-        return Result<std::vector<uint8_t>>(static_cast<ErrorCode>(fr));
+        return Result<size_t>(fresult_to_error_code(fr));
     }
     
-    data.resize(bytes_read);
-    return Result<std::vector<uint8_t>>(data);
+    return Result<size_t>(bytes_read);
 }
 
 Result<size_t> RWSD::FileHandle::read_text(std::string& text, size_t max_size) {
-    auto result = read(max_size);
+    // text的容量足够时不会重新分配
+    text.resize(max_size);
+    auto result = read_into(&text[0], max_size);
     if (!result.is_ok()) {
-        return Result<size_t>(result.error_code());
+        text.clear();
+        return result;
     }
     
-    text.assign(reinterpret_cast<const char*>(result->data()), result->size());
-    return Result<size_t>(result->size());
+    text.resize(*result);
+    return result;
 }
 
 Result<size_t> RWSD::FileHandle::write(const std::vector<uint8_t>& data) {
-    if (!is_open_) {
+    return write(data.data(), data.size());
+}
+
+Result<size_t> RWSD::FileHandle::write(const void* data, size_t size) {
+    OpenFileTable::Slot* entry = slot();
+    if (entry == nullptr || (data == nullptr && size > 0)) {
         return Result<size_t>(ErrorCode::INVALID_PARAMETER);
     }
     
     UINT bytes_written;
-    FRESULT fr = f_write(&file_, data.data(), data.size(), &bytes_written);
+    FRESULT fr = f_write(&entry->file, data, size, &bytes_written);
     if (fr != FR_OK) {
-        return Result<size_t>(static_cast<ErrorCode>(fr));
+        return Result<size_t>(fresult_to_error_code(fr));
+    }
+    if (entry->reserved_end != 0 && f_tell(&entry->file) > entry->data_end) {
+        entry->data_end = f_tell(&entry->file);
     }
     
     return Result<size_t>(bytes_written);
 }
 
-Result<size_t> RWSD::FileHandle::write(const std::string& text) {
-    std::vector<uint8_t> data(text.begin(), text.end());
-    return write(data);
+Result<size_t> RWSD::FileHandle::write(std::string_view text) {
+    return write(text.data(), text.size());
 }
 
-Result<size_t> RWSD::FileHandle::write_line(const std::string& line) {
-    std::string text = line + "\n";
-    return write(text);
+Result<size_t> RWSD::FileHandle::write_line(std::string_view line) {
+    auto result = write(line);
+    if (!result.is_ok() || *result < line.size()) {
+        return result;
+    }
+    
+    auto newline = write("\n", 1);
+    if (!newline.is_ok()) {
+        return newline;
+    }
+    return Result<size_t>(*result + *newline);
 }
 
 Result<void> RWSD::FileHandle::seek(size_t position) {
-    if (!is_open_) {
+    FIL* fp = file();
+    if (fp == nullptr) {
         return Result<void>(ErrorCode::INVALID_PARAMETER);
     }
     
-    FRESULT fr = f_lseek(&file_, position);
-    return Result<void>(static_cast<ErrorCode>(fr));
+    FRESULT fr = f_lseek(fp, position);
+    return Result<void>(fresult_to_error_code(fr));
 }
 
 Result<size_t> RWSD::FileHandle::tell() const {
-    if (!is_open_) {
+    FIL* fp = file();
+    if (fp == nullptr) {
         return Result<size_t>(ErrorCode::INVALID_PARAMETER);
     }
     
-    return Result<size_t>(f_tell(&file_));
+    return Result<size_t>(f_tell(fp));
 }
 
 Result<size_t> RWSD::FileHandle::size() const {
-    if (!is_open_) {
+    const OpenFileTable::Slot* entry = slot();
+    if (entry == nullptr) {
         return Result<size_t>(ErrorCode::INVALID_PARAMETER);
     }
     
-    return Result<size_t>(f_size(&file_));
+    return Result<size_t>(entry->reserved_end != 0 ? entry->data_end : f_size(&entry->file));
 }
 
 Result<void> RWSD::FileHandle::flush() {
-    if (!is_open_) {
+    FIL* fp = file();
+    if (fp == nullptr) {
         return Result<void>(ErrorCode::INVALID_PARAMETER);
     }
     
-    FRESULT fr = f_sync(&file_);
-    return Result<void>(static_cast<ErrorCode>(fr));
+    FRESULT fr = f_sync(fp);
+    return Result<void>(fresult_to_error_code(fr));
 }
 
 Result<void> RWSD::FileHandle::truncate(size_t size) {
-    if (!is_open_) {
+    OpenFileTable::Slot* entry = slot();
+    if (entry == nullptr) {
         return Result<void>(ErrorCode::INVALID_PARAMETER);
     }
     
-    FRESULT fr = f_truncate(&file_);
-    return Result<void>(static_cast<ErrorCode>(fr));
+    // 显式截断后文件末尾由调用者决定，不再保留预分配
+    entry->reserved_end = 0;
+    FRESULT fr = f_lseek(&entry->file, size);
+    if (fr == FR_OK) {
+        fr = f_truncate(&entry->file);
+    }
+    return Result<void>(fresult_to_error_code(fr));
 }
 
 Result<RWSD::FileHandle> RWSD::open_file(const std::string& path, const std::string& mode) {
-    if (!is_initialized_) {
+    return open_file(path, mode, OpenOptions());
+}
+
+Result<RWSD::FileHandle> RWSD::open_file(const std::string& path, const std::string& mode,
+                                         const OpenOptions& options) {
+    if (!is_initialized_ || !files_) {
         return Result<FileHandle>(ErrorCode::INIT_FAILED);
     }
     
-    FileHandle handle;
-    auto result = handle.open(path, mode);
-    if (!result.is_ok()) {
-        return Result<FileHandle>(result.error_code());
+    BYTE flags = mode_to_flags(mode);
+    if (flags & FA_WRITE) {
+        invalidate_path(path);
+    }
+    
+    uint8_t slot;
+    uint16_t generation;
+    FRESULT fr = files_->open(path.c_str(), mode.c_str(), flags, slot, generation);
+    if (fr != FR_OK) {
+        return Result<FileHandle>(fresult_to_error_code(fr));
+    }
+    FileHandle handle(files_.get(), slot, generation);
+    if (flags & FA_WRITE) {
+        // 通过句柄的写入不经过RWSD，包含该文件的目录汇总失效 (关闭前也不再缓存)
+        if (usage_cache_) {
+            usage_cache_->invalidate(path.c_str());
+        }
+        notify_change(FileChange::CREATED, path);
+    }
+    
+    // 先预分配再建立映射表，使映射表覆盖预留的簇
+    if (options.preallocate_bytes > 0 && (flags & FA_WRITE)) {
+        OpenFileTable::Slot* entry = handle.slot();
+        FSIZE_t data_end = f_size(&entry->file);
+        auto reserved = reserve_space(&entry->file, data_end + options.preallocate_bytes, options.contiguous);
+        if (!reserved.is_ok()) {
+            return Result<FileHandle>(reserved.error_code());
+        }
+        entry->reserved_end = f_size(&entry->file);
+        entry->data_end = data_end;
+    }
+    
+    if (options.fast_seek) {
+        // 映射表超出上限时按普通模式使用
+        fr = files_->enable_fast_seek(slot, generation, options.max_link_map_bytes);
+        if (fr != FR_OK && fr != FR_NOT_ENOUGH_CORE) {
+            return Result<FileHandle>(fresult_to_error_code(fr));
+        }
     }
     
     return Result<FileHandle>(std::move(handle));
 }
 
+// === 连续区段写入器 ===
+
+namespace {
+
+// sync_entry_size依赖ff.c的实现细节而非公开API，只在核对过以下版本的ff.c后放行:
+//   R0.13c (86604), R0.14 (86606), R0.14a (80196), R0.14b (86631), R0.15 (80286)
+// 更新FatFs时需重新核对f_write与f_sync的行为，再把新的FF_DEFINED加入列表
+static_assert(FF_DEFINED == 86604 || FF_DEFINED == 86606 || FF_DEFINED == 80196 ||
+              FF_DEFINED == 86631 || FF_DEFINED == 80286,
+              "ExtentWriter的检查点依赖ff.c内部行为，请核对新版本FatFs后更新此处");
+
+/**
+ * @brief 把size写入已打开文件的目录项，FIL中的大小保持不变
+ * f_sync把obj.objsize写入目录项，但只在文件带有修改标志时回写；零长度的f_write
+ * 不传输数据，只设置该标志 (上面列出的版本均在写入循环之后无条件置位FA_MODIFIED)
+ */
+FRESULT sync_entry_size(FIL* file, FSIZE_t size) {
+    UINT written = 0;
+    FRESULT fr = f_write(file, "", 0, &written);
+    if (fr != FR_OK) {
+        return fr;
+    }
+    FSIZE_t actual = file->obj.objsize;
+    file->obj.objsize = size;
+    fr = f_sync(file);
+    file->obj.objsize = actual;
+    return fr;
+}
+
+} // namespace
+
+RWSD::ExtentWriter::ExtentWriter()
+    : first_sector_(0), capacity_(0), written_(0), checkpointed_(0), checkpoint_bytes_(0), tail_length_(0) {}
+
+RWSD::ExtentWriter::ExtentWriter(FileHandle&& handle, uint32_t first_sector, size_t capacity,
+                                 size_t checkpoint_bytes)
+    : handle_(std::move(handle)), first_sector_(first_sector), capacity_(capacity), written_(0),
+      checkpointed_(0), checkpoint_bytes_(checkpoint_bytes), tail_length_(0) {
+    memset(tail_, 0, sizeof(tail_));
+}
+
+RWSD::ExtentWriter::ExtentWriter(ExtentWriter&& other) noexcept
+    : handle_(std::move(other.handle_)), first_sector_(other.first_sector_), capacity_(other.capacity_),
+      written_(other.written_), checkpointed_(other.checkpointed_),
+      checkpoint_bytes_(other.checkpoint_bytes_), tail_length_(other.tail_length_) {
+    memcpy(tail_, other.tail_, sizeof(tail_));
+}
+
+RWSD::ExtentWriter& RWSD::ExtentWriter::operator=(ExtentWriter&& other) noexcept {
+    if (this != &other) {
+        (void)close();
+        handle_ = std::move(other.handle_);
+        first_sector_ = other.first_sector_;
+        capacity_ = other.capacity_;
+        written_ = other.written_;
+        checkpointed_ = other.checkpointed_;
+        checkpoint_bytes_ = other.checkpoint_bytes_;
+        tail_length_ = other.tail_length_;
+        memcpy(tail_, other.tail_, sizeof(tail_));
+    }
+    return *this;
+}
+
+Result<size_t> RWSD::ExtentWriter::write(const void* data, size_t size) {
+    // 每次取当前挂接的设备: 重新配置缓存后下层设备对象会改变
+    BlockDevice* device = attached_block_device(0);
+    if (!handle_.is_open() || device == nullptr || (data == nullptr && size > 0)) {
+        return Result<size_t>(ErrorCode::INVALID_PARAMETER);
+    }
+    
+    size = std::min(size, capacity_ - written_);
+    const uint8_t* source = static_cast<const uint8_t*>(data);
+    size_t remaining = size;
+    
+    // 先补满暂存的尾部扇区
+    if (tail_length_ > 0) {
+        size_t count = std::min<size_t>(remaining, BlockDevice::SECTOR_SIZE - tail_length_);
+        memcpy(tail_ + tail_length_, source, count);
+        tail_length_ += count;
+        source += count;
+        remaining -= count;
+        if (tail_length_ == BlockDevice::SECTOR_SIZE) {
+            auto result = device->write(first_sector_ + written_ / BlockDevice::SECTOR_SIZE, tail_, 1);
+            if (!result.is_ok()) {
+                return Result<size_t>(result.error_code());
+            }
+            memset(tail_, 0, sizeof(tail_));
+            tail_length_ = 0;
+        }
+        written_ += count;
+    }
+    
+    // 整扇区直接从调用者的缓冲区多块写入
+    uint32_t sectors = remaining / BlockDevice::SECTOR_SIZE;
+    if (sectors > 0) {
+        auto result = device->write(first_sector_ + written_ / BlockDevice::SECTOR_SIZE, source, sectors);
+        if (!result.is_ok()) {
+            return Result<size_t>(result.error_code());
+        }
+        size_t count = (size_t)sectors * BlockDevice::SECTOR_SIZE;
+        source += count;
+        remaining -= count;
+        written_ += count;
+    }
+    
+    if (remaining > 0) {
+        memcpy(tail_, source, remaining);
+        tail_length_ = remaining;
+        written_ += remaining;
+    }
+    
+    if (checkpoint_bytes_ > 0 && written_ - checkpointed_ >= checkpoint_bytes_) {
+        auto result = checkpoint();
+        if (!result.is_ok()) {
+            return Result<size_t>(result.error_code());
+        }
+    }
+    return Result<size_t>(size);
+}
+
+Result<void> RWSD::ExtentWriter::checkpoint() {
+    OpenFileTable::Slot* entry = handle_.slot();
+    BlockDevice* device = attached_block_device(0);
+    if (entry == nullptr || device == nullptr) {
+        return Result<void>(ErrorCode::INVALID_PARAMETER);
+    }
+    
+    // 尾部扇区补零写出，后续写入补满后会再次写入同一扇区
+    if (tail_length_ > 0) {
+        auto result = device->write(first_sector_ + written_ / BlockDevice::SECTOR_SIZE, tail_, 1);
+        if (!result.is_ok()) {
+            return result;
+        }
+    }
+    
+    // 目录项记录已写入的大小，FIL中仍保持预分配大小，使关闭时能截断未用的簇
+    entry->data_end = written_;
+    FRESULT fr = sync_entry_size(&entry->file, written_);
+    if (fr != FR_OK) {
+        return Result<void>(fresult_to_error_code(fr));
+    }
+    
+    checkpointed_ = written_;
+    return Result<void>();
+}
+
+Result<void> RWSD::ExtentWriter::close() {
+    if (!handle_.is_open()) {
+        return Result<void>();
+    }
+    
+    auto result = checkpoint();
+    FRESULT fr = handle_.table_->close(handle_.slot_, handle_.generation_);
+    handle_.table_ = nullptr;
+    if (!result.is_ok()) {
+        return result;
+    }
+    return Result<void>(fresult_to_error_code(fr));
+}
+
+Result<RWSD::ExtentWriter> RWSD::open_extent_writer(const std::string& path, size_t capacity,
+                                                    const ExtentWriterOptions& options) {
+    if (capacity == 0) {
+        return Result<ExtentWriter>(ErrorCode::INVALID_PARAMETER);
+    }
+    
+    OpenOptions open_options;
+    open_options.preallocate_bytes = capacity;
+    open_options.contiguous = true;
+    auto handle = open_file(path, "w", open_options);
+    if (!handle.is_ok()) {
+        return Result<ExtentWriter>(handle.error_code());
+    }
+    
+    // 连续簇链: 起始扇区由首簇号直接换算
+    DWORD first_cluster = handle->file()->obj.sclust;
+    uint32_t first_sector = static_cast<uint32_t>(fs_.database + (LBA_t)(first_cluster - 2) * fs_.csize);
+    ExtentWriter writer(std::move(*handle), first_sector, capacity, options.checkpoint_bytes);
+    
+    // 立即写入大小为0的目录项，掉电时不会留下包含未写入区域的文件
+    auto result = writer.checkpoint();
+    if (!result.is_ok()) {
+        return Result<ExtentWriter>(result.error_code());
+    }
+    return Result<ExtentWriter>(std::move(writer));
+}
+
 // === 高级功能 ===
 
-Result<void> RWSD::format(const std::string& volume_label) {
+Result<void> RWSD::configure_cache(const CacheConfig& config) {
+    cache_config_ = config;
+    if (!is_initialized_) {
+        return Result<void>();
+    }
+    
+    if (cache_) {
+        auto result = cache_->flush();
+        if (!result.is_ok()) {
+            return result;
+        }
+    }
+    setup_cache();
+    setup_free_map();
+    if (cache_) {
+        cache_->set_pinned_range(fs_.fatbase, fs_.fsize * fs_.n_fats);
+        cache_->set_metadata_window(fs_.win);
+    }
+    return Result<void>();
+}
+
+CacheStats RWSD::get_cache_stats() const {
+    return cache_ ? cache_->get_stats() : CacheStats();
+}
+
+Result<void> RWSD::configure_free_space(const FreeSpaceConfig& config) {
+    free_space_config_ = config;
+    if (!is_initialized_) {
+        return Result<void>();
+    }
+    
+    free_map_.reset();
+    setup_free_map();
+    start_free_tracking();
+    return Result<void>();
+}
+
+Result<bool> RWSD::scan_free_space(uint32_t max_sectors) {
+    if (!is_initialized_) {
+        return Result<bool>(ErrorCode::INIT_FAILED);
+    }
+    if (!free_map_ || !free_map_->is_tracking()) {
+        return Result<bool>(ErrorCode::INVALID_PARAMETER);
+    }
+    if (free_map_->is_complete()) {
+        return Result<bool>(true);
+    }
+    
+    auto result = free_map_->scan(max_sectors);
+    if (!result.is_ok()) {
+        free_map_->detach();
+        return result;
+    }
+    if (*result) {
+        apply_free_map();
+    }
+    return result;
+}
+
+Result<void> RWSD::maintain_device() {
     if (!is_initialized_) {
         return Result<void>(ErrorCode::INIT_FAILED);
     }
+    return device_->maintain();
+}
+
+Result<void> RWSD::format(const std::string& volume_label) {
+    // 未格式化的卡无法挂载，此时直接初始化块设备
+    bool opened_device = false;
+    if (!is_initialized_) {
+        auto device_result = initialize_device();
+        if (!device_result.is_ok()) {
+            return Result<void>(ErrorCode::INIT_FAILED);
+        }
+        FRESULT fr = f_mount(&fs_, "", 0);
+        if (fr != FR_OK) {
+            deinitialize_device();
+            return Result<void>(fresult_to_error_code(fr));
+        }
+        is_initialized_ = true;
+        opened_device = true;
+    }
+    
+    // 由format打开的设备在失败时关闭，恢复到未初始化状态
+    auto fail = [this, opened_device](Result<void> error) {
+        if (opened_device) {
+            unmount_filesystem();
+            deinitialize_device();
+            is_initialized_ = false;
+        }
+        return error;
+    };
     
     BYTE work[FF_MAX_SS];
     MKFS_PARM opt = {0};
@@ -752,19 +2124,42 @@ Result<void> RWSD::format(const std::string& volume_label) {
     opt.n_root = 0;
     opt.au_size = 0;
     
+    // 格式化会重写整个FAT，挂载后重新建立索引；已打开的文件全部失效
+    if (free_map_) {
+        free_map_->detach();
+    }
+    if (files_) {
+        files_->close_all();
+    }
+    if (read_cache_) {
+        read_cache_->invalidate_all();
+    }
+    if (dentry_cache_) {
+        dentry_cache_->invalidate_all();
+    }
+    if (usage_cache_) {
+        usage_cache_->invalidate_all();
+    }
     FRESULT fr = f_mkfs("", &opt, work, sizeof(work));
     if (fr != FR_OK) {
-        return Result<void>(fresult_to_error_code(fr));
+        return fail(Result<void>(fresult_to_error_code(fr)));
+    }
+    
+    // 重新挂载以刷新文件系统信息
+    auto mount_result = mount_filesystem();
+    if (!mount_result.is_ok()) {
+        return fail(mount_result);
     }
     
     // 设置卷标
     if (!volume_label.empty()) {
         fr = f_setlabel(volume_label.c_str());
         if (fr != FR_OK) {
-            return Result<void>(fresult_to_error_code(fr));
+            return fail(Result<void>(fresult_to_error_code(fr)));
         }
     }
     
+    notify_change(FileChange::FORMATTED, "");
     return Result<void>();
 }
 
@@ -795,6 +2190,11 @@ Result<bool> RWSD::check_filesystem_integrity() const {
         return Result<bool>(ErrorCode::INIT_FAILED);
     }
     
+    // 索引完整时，比较FatFs维护的空闲簇数与索引是否一致
+    if (free_map_ && free_map_->is_complete() && fs_.free_clst <= fs_.n_fatent - 2) {
+        return Result<bool>(fs_.free_clst == free_map_->free_clusters());
+    }
+    
     // 简单的完整性检查：尝试获取空闲簇信息
     DWORD fre_clust;
     FATFS* fs_ptr = const_cast<FATFS*>(&fs_);
@@ -805,15 +2205,10 @@ Result<bool> RWSD::check_filesystem_integrity() const {
 // === 工具方法 ===
 
 std::string RWSD::get_config_info() const {
-    std::ostringstream oss;
-    oss << "=== SPI配置信息 ===\n";
-    oss << "SPI实例: " << (config_.spi_port == spi0 ? "SPI0" : "SPI1") << "\n";
-    oss << "MOSI引脚: " << (int)config_.pins.pin_mosi << "\n";
-    oss << "MISO引脚: " << (int)config_.pins.pin_miso << "\n";
-    oss << "SCLK引脚: " << (int)config_.pins.pin_sck << "\n";
-    oss << "CS引脚: " << (int)config_.pins.pin_cs << "\n";
-    oss << "波特率: " << config_.clk_slow << " Hz\n";
-    return oss.str();
+    if (!device_) {
+        return "=== 块设备配置信息 ===\n未配置块设备\n";
+    }
+    return device_->get_config_info();
 }
 
 std::string RWSD::get_status_info() const {
@@ -823,6 +2218,8 @@ std::string RWSD::get_status_info() const {
     
     if (is_initialized_) {
         oss << "文件系统类型: " << get_filesystem_type() << "\n";
+        oss << "挂载耗时: " << std::fixed << std::setprecision(1) << mount_time_us_ / 1000.0 << " ms ("
+            << (fast_mount_ ? "快速挂载" : "完整扫描") << ")\n";
         
         auto capacity_result = get_capacity();
         if (capacity_result.is_ok()) {
@@ -832,6 +2229,46 @@ std::string RWSD::get_status_info() const {
             oss << "可用容量: " << (free / 1024 / 1024) << " MB\n";
             oss << "使用率: " << std::fixed << std::setprecision(1) << usage_percent << "%\n";
         }
+        
+        if (free_map_ && free_map_->is_tracking()) {
+            oss << "空闲簇索引: ";
+            if (free_map_->is_complete()) {
+                oss << "已建立 (" << free_map_->memory_usage() << " 字节)\n";
+            } else {
+                oss << "建立中 " << (int)free_map_->scan_progress() << "%\n";
+            }
+        }
+        
+        if (files_) {
+            oss << "打开文件: " << files_->open_count() << " / " << OpenFileTable::capacity()
+                << " (峰值 " << files_->peak_count() << ")\n";
+        }
+        
+        if (read_cache_) {
+            const ReadCacheStats& stats = read_cache_->get_stats();
+            oss << "只读句柄缓存: 命中 " << stats.hits << " / 未命中 " << stats.misses
+                << " / 失效 " << stats.invalidations << "\n";
+        }
+        
+        if (dentry_cache_) {
+            const DentryCacheStats& stats = dentry_cache_->get_stats();
+            oss << "路径查找缓存: 命中 " << stats.hits << " (不存在 " << stats.negative_hits << ") / 未命中 "
+                << stats.misses << " (" << std::fixed << std::setprecision(1) << stats.hit_rate() * 100.0f
+                << "%) / 失效 " << stats.invalidations << "\n";
+        }
+        
+        if (usage_cache_) {
+            const UsageCacheStats& stats = usage_cache_->get_stats();
+            oss << "目录占用缓存: 命中 " << stats.hits << " / 未命中 " << stats.misses
+                << " / 增量更新 " << stats.updates << " / 失效 " << stats.invalidations << "\n";
+        }
+        
+        if (cache_) {
+            const CacheStats& stats = cache_->get_stats();
+            oss << "扇区缓存: " << cache_->capacity() << " 扇区, 命中 " << stats.hits
+                << " / 未命中 " << stats.misses << " ("
+                << std::fixed << std::setprecision(1) << stats.hit_rate() * 100.0f << "%)\n";
+        }
     }
     
     return oss.str();
@@ -842,6 +2279,9 @@ std::string RWSD::get_memory_usage() const {
     oss << "=== 内存使用情况 ===\n";
     // 使用标准C库函数获取内存信息
     oss << "堆内存: 可用 (具体大小需要运行时获取)\n";
+    if (files_) {
+        oss << "打开文件表: " << sizeof(OpenFileTable) << " 字节 (" << OpenFileTable::capacity() << " 槽位)\n";
+    }
     return oss.str();
 }
 
@@ -0,0 +1,572 @@
+/**
+ * @file sd_card_emulator.cpp
+ * @brief SPI模式SD卡模拟器实现
+ * @version 1.0.0
+ */
+
+#include "sd_card_emulator.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+
+namespace MicroSD {
+
+namespace {
+
+constexpr size_t BLOCK_SIZE = BlockDevice::SECTOR_SIZE;
+
+// === R1响应位 ===
+constexpr uint8_t R1_IDLE            = 0x01;
+constexpr uint8_t R1_ILLEGAL_COMMAND = 0x04;
+constexpr uint8_t R1_COM_CRC_ERROR   = 0x08;
+constexpr uint8_t R1_PARAMETER_ERROR = 0x40;
+
+// === 数据令牌/响应 ===
+constexpr uint8_t TOKEN_START_BLOCK  = 0xFE;
+constexpr uint8_t TOKEN_START_MULTI  = 0xFC;
+constexpr uint8_t TOKEN_STOP_TRAN    = 0xFD;
+constexpr uint8_t TOKEN_OUT_OF_RANGE = 0x08;
+constexpr uint8_t DATA_ACCEPTED      = 0x05;
+constexpr uint8_t DATA_CRC_ERROR     = 0x0B;
+constexpr uint8_t DATA_WRITE_ERROR   = 0x0D;
+
+uint8_t crc7(const uint8_t* data, size_t length) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < length; ++i) {
+        uint8_t byte = data[i];
+        for (int bit = 0; bit < 8; ++bit) {
+            crc <<= 1;
+            if ((byte ^ crc) & 0x80) {
+                crc ^= 0x09;
+            }
+            byte <<= 1;
+        }
+    }
+    return (crc << 1) | 0x01;
+}
+
+uint16_t crc16(const uint8_t* data, size_t length) {
+    uint16_t crc = 0;
+    for (size_t i = 0; i < length; ++i) {
+        crc ^= static_cast<uint16_t>(data[i] << 8);
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+uint64_t host_now_ns() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+/**
+ * @brief 总线操作的作用域: 进入时计入调用者的CPU时间，退出时重新开始计时
+ */
+struct SdCardEmulator::CpuSpan {
+    SdCardEmulator& emulator;
+
+    explicit CpuSpan(SdCardEmulator& owner) : emulator(owner) { emulator.charge_cpu(); }
+    ~CpuSpan() { emulator.mark_cpu(); }
+};
+
+SdCardEmulator::SdCardEmulator(BlockDevice& backing, const EmulatorTiming& timing, bool async)
+    : backing_(backing), timing_(timing), clock_(0), selected_(false), async_(async),
+      state_(State::IDLE), receive_return_(State::IDLE), idle_(true), app_cmd_(false),
+      crc_on_(false), init_polls_left_(timing.init_polls), next_block_(0), preerase_left_(0),
+      corrupt_left_(0), frame_(), frame_len_(0), block_(BLOCK_SIZE + 2), block_len_(0),
+      out_pos_(0), now_ps_(0), busy_until_ps_(0),
+      pending_rx_(nullptr), pending_tx_(nullptr), pending_len_(0),
+      cpu_mark_ns_(host_now_ns()), dma_start_ps_(0), dma_cpu_ps_(0) {}
+
+// === SpiTransport接口 ===
+
+Result<void> SdCardEmulator::begin(uint32_t baudrate) {
+    auto result = backing_.initialize();
+    if (!result.is_ok()) {
+        return result;
+    }
+
+    // 上电复位: 等待CMD0
+    state_ = State::IDLE;
+    idle_ = true;
+    app_cmd_ = false;
+    crc_on_ = false;
+    init_polls_left_ = timing_.init_polls;
+    preerase_left_ = 0;
+    frame_len_ = 0;
+    out_.clear();
+    out_pos_ = 0;
+    busy_until_ps_ = 0;
+    set_clock(baudrate);
+    return Result<void>();
+}
+
+void SdCardEmulator::end() {
+    complete_transfer();
+    if (clock_ != 0) {
+        (void)backing_.sync();
+        clock_ = 0;
+    }
+}
+
+uint32_t SdCardEmulator::set_clock(uint32_t baudrate) {
+    // 与RP2040 SPI相同: 分频系数为不小于2的偶数，实际频率不超过请求频率
+    uint32_t divisor = baudrate > 0 ? (timing_.reference_clock_hz + baudrate - 1) / baudrate : 2;
+    if (divisor < 2) {
+        divisor = 2;
+    }
+    if (divisor & 1) {
+        ++divisor;
+    }
+    clock_ = timing_.reference_clock_hz / divisor;
+    return clock_;
+}
+
+void SdCardEmulator::select() {
+    selected_ = true;
+}
+
+void SdCardEmulator::deselect() {
+    // 未读取的响应随片选释放丢失，忙状态和传输状态保持
+    selected_ = false;
+    frame_len_ = 0;
+    out_.clear();
+    out_pos_ = 0;
+}
+
+uint8_t SdCardEmulator::transfer(uint8_t data) {
+    CpuSpan span(*this);
+    complete_transfer();
+    return exchange(data);
+}
+
+void SdCardEmulator::write_bytes(const uint8_t* data, size_t length) {
+    CpuSpan span(*this);
+    complete_transfer();
+    exchange_block(nullptr, data, length);
+}
+
+void SdCardEmulator::read_bytes(uint8_t* data, size_t length) {
+    CpuSpan span(*this);
+    complete_transfer();
+    exchange_block(data, nullptr, length);
+}
+
+void SdCardEmulator::start_read(uint8_t* data, size_t length) {
+    CpuSpan span(*this);
+    complete_transfer();
+    if (!async_) {
+        exchange_block(data, nullptr, length);
+        return;
+    }
+    // 填充哑元数据，提前访问缓冲区的调用者会读到错误内容
+    memset(data, 0xA5, length);
+    pending_rx_ = data;
+    pending_len_ = length;
+    dma_start_ps_ = now_ps_;
+    dma_cpu_ps_ = 0;
+}
+
+void SdCardEmulator::start_write(const uint8_t* data, size_t length) {
+    CpuSpan span(*this);
+    complete_transfer();
+    if (!async_) {
+        exchange_block(nullptr, data, length);
+        return;
+    }
+    pending_tx_ = data;
+    pending_len_ = length;
+    dma_start_ps_ = now_ps_;
+    dma_cpu_ps_ = 0;
+}
+
+void SdCardEmulator::wait_transfer() {
+    CpuSpan span(*this);
+    complete_transfer();
+}
+
+void SdCardEmulator::set_async(bool async) {
+    complete_transfer();
+    async_ = async;
+}
+
+void SdCardEmulator::set_timing(const EmulatorTiming& timing) {
+    timing_ = timing;
+    cpu_mark_ns_ = host_now_ns();
+}
+
+void SdCardEmulator::complete_transfer() {
+    if (pending_len_ == 0) {
+        return;
+    }
+    size_t length = pending_len_;
+    uint8_t* rx = pending_rx_;
+    const uint8_t* tx = pending_tx_;
+    pending_len_ = 0;
+    pending_rx_ = nullptr;
+    pending_tx_ = nullptr;
+
+    // DMA与调用者的CPU处理同时进行，结束时间取两者中较晚者
+    exchange_block(rx, tx, length);
+    now_ps_ = std::max(now_ps_, dma_start_ps_ + dma_cpu_ps_);
+}
+
+void SdCardEmulator::charge_cpu() {
+    if (timing_.cpu_scale == 0) {
+        return;
+    }
+    uint64_t cpu_ps = (host_now_ns() - cpu_mark_ns_) * 1000 * timing_.cpu_scale;
+    if (pending_len_ > 0) {
+        dma_cpu_ps_ += cpu_ps;
+    } else {
+        now_ps_ += cpu_ps;
+    }
+}
+
+void SdCardEmulator::mark_cpu() {
+    if (timing_.cpu_scale != 0) {
+        cpu_mark_ns_ = host_now_ns();
+    }
+}
+
+std::string SdCardEmulator::get_config_info() const {
+    std::ostringstream oss;
+    oss << "传输: SD卡模拟器 (SDHC, " << backing_.geometry().sector_count << " 扇区"
+        << (async_ ? ", 异步数据阶段" : "") << ")\n";
+    oss << "时序: Ncr " << (int)timing_.command_latency_bytes << " 字节, 访问延迟 "
+        << timing_.read_access_us << " us, 写忙 " << timing_.write_busy_us << "/"
+        << timing_.multi_write_busy_us << "/" << timing_.preerased_write_busy_us << " us\n";
+    oss << "稳定时钟上限: " << timing_.max_stable_hz << " Hz\n";
+    return oss.str();
+}
+
+// === 字节交换 ===
+
+uint8_t SdCardEmulator::exchange(uint8_t data) {
+    uint64_t byte_ps = clock_ > 0 ? 8000000000000ULL / clock_ : 0;
+    now_ps_ += byte_ps;
+    ++stats_.bytes;
+
+    if (!selected_) {
+        return 0xFF;
+    }
+    uint8_t out = next_output();
+    consume_input(data);
+    return out;
+}
+
+void SdCardEmulator::exchange_block(uint8_t* rx, const uint8_t* tx, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        uint8_t out = exchange(tx != nullptr ? tx[i] : 0xFF);
+        if (rx != nullptr) {
+            rx[i] = out;
+        }
+    }
+}
+
+// === 输出队列 ===
+
+uint32_t SdCardEmulator::us_to_bytes(uint32_t us) const {
+    return static_cast<uint32_t>(((uint64_t)us * clock_ + 7999999) / 8000000);
+}
+
+bool SdCardEmulator::should_corrupt() {
+    if (corrupt_left_ > 0) {
+        --corrupt_left_;
+    } else if (clock_ <= timing_.max_stable_hz) {
+        return false;
+    }
+    ++stats_.injected_errors;
+    return true;
+}
+
+void SdCardEmulator::respond(uint32_t delay, std::initializer_list<uint8_t> bytes) {
+    if (out_pos_ >= out_.size()) {
+        out_.clear();
+        out_pos_ = 0;
+    }
+    out_.insert(out_.end(), delay, 0xFF);
+    out_.insert(out_.end(), bytes.begin(), bytes.end());
+}
+
+void SdCardEmulator::queue_data_block(const uint8_t* data, size_t length, uint32_t delay) {
+    uint16_t crc = crc16(data, length);
+    respond(delay, {TOKEN_START_BLOCK});
+    size_t first = out_.size();
+    out_.insert(out_.end(), data, data + length);
+    if (should_corrupt()) {
+        out_[first + length / 2] ^= 0x10;  // 线路位错误: 数据变化而CRC不变
+    }
+    out_.push_back(static_cast<uint8_t>(crc >> 8));
+    out_.push_back(static_cast<uint8_t>(crc));
+}
+
+void SdCardEmulator::queue_read_block() {
+    uint32_t delay = us_to_bytes(timing_.read_access_us);
+    uint8_t data[BLOCK_SIZE];
+    if (next_block_ >= backing_.geometry().sector_count || !backing_.read(next_block_, data, 1).is_ok()) {
+        respond(delay, {TOKEN_OUT_OF_RANGE});
+        state_ = State::IDLE;
+        return;
+    }
+    queue_data_block(data, BLOCK_SIZE, delay);
+    ++next_block_;
+    ++stats_.blocks_read;
+}
+
+uint8_t SdCardEmulator::next_output() {
+    if (out_pos_ < out_.size()) {
+        return out_[out_pos_++];
+    }
+    if (state_ == State::READ_MULTI) {
+        // 主机继续读取: 准备下一个数据块
+        queue_read_block();
+        return next_output();
+    }
+    return now_ps_ < busy_until_ps_ ? 0x00 : 0xFF;
+}
+
+// === 输入处理 ===
+
+void SdCardEmulator::consume_input(uint8_t data) {
+    switch (state_) {
+    case State::RECEIVE_BLOCK:
+        block_[block_len_++] = data;
+        if (block_len_ == block_.size()) {
+            finish_receive();
+        }
+        return;
+
+    case State::WRITE_SINGLE:
+    case State::WRITE_MULTI:
+        if (now_ps_ < busy_until_ps_) {
+            return;
+        }
+        if ((data == TOKEN_START_BLOCK && state_ == State::WRITE_SINGLE) ||
+            (data == TOKEN_START_MULTI && state_ == State::WRITE_MULTI)) {
+            receive_return_ = state_;
+            state_ = State::RECEIVE_BLOCK;
+            block_len_ = 0;
+            return;
+        }
+        if (data == TOKEN_STOP_TRAN && state_ == State::WRITE_MULTI) {
+            state_ = State::IDLE;
+            preerase_left_ = 0;
+            busy_until_ps_ = now_ps_ + us_to_ps(timing_.stop_busy_us);
+            return;
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    // 命令帧以01xxxxxx开始，共6字节
+    if (frame_len_ == 0 && (data & 0xC0) != 0x40) {
+        return;
+    }
+    frame_[frame_len_++] = data;
+    if (frame_len_ == sizeof(frame_)) {
+        frame_len_ = 0;
+        handle_command();
+    }
+}
+
+void SdCardEmulator::handle_command() {
+    uint8_t cmd = frame_[0] & 0x3F;
+    uint32_t arg = ((uint32_t)frame_[1] << 24) | ((uint32_t)frame_[2] << 16) |
+                   ((uint32_t)frame_[3] << 8) | frame_[4];
+    bool app = app_cmd_;
+    app_cmd_ = false;
+    ++stats_.commands;
+
+    // CMD0/CMD8始终校验CRC，其余命令在CMD59启用后校验
+    if ((crc_on_ || cmd == 0 || cmd == 8) && crc7(frame_, 5) != frame_[5]) {
+        ++stats_.crc_rejects;
+        respond(timing_.command_latency_bytes, {static_cast<uint8_t>(R1_COM_CRC_ERROR | (idle_ ? R1_IDLE : 0))});
+        return;
+    }
+    execute(cmd, arg, app);
+}
+
+void SdCardEmulator::execute(uint8_t cmd, uint32_t arg, bool app) {
+    const uint32_t ncr = timing_.command_latency_bytes;
+    const uint32_t sector_count = backing_.geometry().sector_count;
+    uint8_t r1 = idle_ ? R1_IDLE : 0;
+
+    switch (cmd) {
+    case 0:     // GO_IDLE_STATE
+        state_ = State::IDLE;
+        idle_ = true;
+        crc_on_ = false;
+        init_polls_left_ = timing_.init_polls;
+        out_.clear();
+        out_pos_ = 0;
+        respond(ncr, {R1_IDLE});
+        break;
+
+    case 8:     // SEND_IF_COND: 回显电压和检查模式
+        respond(ncr, {r1, 0x00, 0x00, static_cast<uint8_t>((arg >> 8) & 0x0F), static_cast<uint8_t>(arg)});
+        break;
+
+    case 55:    // APP_CMD
+        app_cmd_ = true;
+        respond(ncr, {r1});
+        break;
+
+    case 41:    // ACMD41 SD_SEND_OP_COND
+        if (!app) {
+            respond(ncr, {static_cast<uint8_t>(r1 | R1_ILLEGAL_COMMAND)});
+            break;
+        }
+        if (init_polls_left_ > 0) {
+            --init_polls_left_;
+        } else {
+            idle_ = false;
+        }
+        respond(ncr, {static_cast<uint8_t>(idle_ ? R1_IDLE : 0)});
+        break;
+
+    case 58:    // READ_OCR: 上电完成后置位CCS (高容量)
+        respond(ncr, {r1, static_cast<uint8_t>(idle_ ? 0x00 : 0xC0), 0xFF, 0x80, 0x00});
+        break;
+
+    case 59:    // CRC_ON_OFF
+        crc_on_ = (arg & 1) != 0;
+        respond(ncr, {r1});
+        break;
+
+    case 16:    // SET_BLOCKLEN
+        respond(ncr, {static_cast<uint8_t>(arg == BLOCK_SIZE ? r1 : (r1 | R1_PARAMETER_ERROR))});
+        break;
+
+    case 9: {   // SEND_CSD (CSD v2.0)
+        uint32_t c_size = sector_count / 1024 - 1;
+        uint8_t csd[16] = {
+            0x40, 0x0E, 0x00, 0x5A, 0x5B, 0x59, 0x00,
+            static_cast<uint8_t>((c_size >> 16) & 0x3F),
+            static_cast<uint8_t>(c_size >> 8),
+            static_cast<uint8_t>(c_size),
+            0x7F, 0x80, 0x0A, 0x40, 0x00, 0x00
+        };
+        csd[15] = crc7(csd, 15);
+        respond(ncr, {r1});
+        queue_data_block(csd, sizeof(csd), 1);
+        break;
+    }
+
+    case 13:    // SEND_STATUS / ACMD13 SD_STATUS
+        respond(ncr, {r1, 0x00});
+        if (app) {
+            uint8_t status[64] = {};
+            status[10] = 0x90;  // AU_SIZE = 4MB
+            queue_data_block(status, sizeof(status), 1);
+        }
+        break;
+
+    case 23:    // ACMD23 SET_WR_BLK_ERASE_COUNT
+        if (app) {
+            preerase_left_ = arg & 0x7FFFFF;
+            respond(ncr, {r1});
+        } else {
+            respond(ncr, {static_cast<uint8_t>(r1 | R1_ILLEGAL_COMMAND)});
+        }
+        break;
+
+    case 17:    // READ_SINGLE_BLOCK
+    case 18:    // READ_MULTIPLE_BLOCK
+        if (arg >= sector_count) {
+            respond(ncr, {static_cast<uint8_t>(r1 | R1_PARAMETER_ERROR)});
+            break;
+        }
+        respond(ncr, {r1});
+        next_block_ = arg;
+        if (cmd == 17) {
+            queue_read_block();
+        } else {
+            state_ = State::READ_MULTI;
+        }
+        break;
+
+    case 12:    // STOP_TRANSMISSION: 丢弃未发送的数据，跳过一个填充字节后响应
+        state_ = State::IDLE;
+        out_.clear();
+        out_pos_ = 0;
+        respond(ncr + 1, {r1});
+        busy_until_ps_ = now_ps_ + us_to_ps(timing_.stop_busy_us);
+        break;
+
+    case 24:    // WRITE_BLOCK
+    case 25:    // WRITE_MULTIPLE_BLOCK
+        if (arg >= sector_count) {
+            respond(ncr, {static_cast<uint8_t>(r1 | R1_PARAMETER_ERROR)});
+            break;
+        }
+        respond(ncr, {r1});
+        next_block_ = arg;
+        state_ = cmd == 24 ? State::WRITE_SINGLE : State::WRITE_MULTI;
+        break;
+
+    case 32:    // ERASE_WR_BLK_START
+    case 33:    // ERASE_WR_BLK_END
+        if (cmd == 32) {
+            next_block_ = arg;
+        } else if (arg >= next_block_ && arg < sector_count) {
+            (void)backing_.trim(next_block_, arg - next_block_ + 1);
+        }
+        respond(ncr, {r1});
+        break;
+
+    case 38:    // ERASE
+        respond(ncr, {r1});
+        busy_until_ps_ = now_ps_ + us_to_ps(timing_.erase_busy_us);
+        break;
+
+    default:
+        respond(ncr, {static_cast<uint8_t>(r1 | R1_ILLEGAL_COMMAND)});
+        break;
+    }
+}
+
+void SdCardEmulator::finish_receive() {
+    uint8_t* data = block_.data();
+    uint16_t crc = static_cast<uint16_t>((block_[BLOCK_SIZE] << 8) | block_[BLOCK_SIZE + 1]);
+    if (should_corrupt()) {
+        data[BLOCK_SIZE / 2] ^= 0x10;
+    }
+
+    bool single = receive_return_ == State::WRITE_SINGLE;
+    state_ = single ? State::IDLE : State::WRITE_MULTI;
+
+    if (crc_on_ && crc16(data, BLOCK_SIZE) != crc) {
+        ++stats_.crc_rejects;
+        respond(0, {DATA_CRC_ERROR});
+        return;
+    }
+    if (!backing_.write(next_block_, data, 1).is_ok()) {
+        respond(0, {DATA_WRITE_ERROR});
+        return;
+    }
+    ++next_block_;
+    ++stats_.blocks_written;
+
+    uint32_t busy_us = timing_.write_busy_us;
+    if (!single) {
+        busy_us = timing_.multi_write_busy_us;
+        if (preerase_left_ > 0) {
+            busy_us = timing_.preerased_write_busy_us;
+            --preerase_left_;
+        }
+    }
+    respond(0, {DATA_ACCEPTED});
+    // 忙信号从数据响应之后开始
+    uint64_t byte_ps = 8000000000000ULL / clock_;
+    busy_until_ps_ = now_ps_ + byte_ps + us_to_ps(busy_us);
+}
+
+} // namespace MicroSD
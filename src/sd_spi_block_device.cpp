@@ -0,0 +1,832 @@
+/**
+ * @file sd_spi_block_device.cpp
+ * @brief SPI模式SD卡块设备实现
+ * @version 1.0.0
+ */
+
+#include "sd_spi_block_device.hpp"
+#include "platform.hpp"
+#if !MICRO_SD_HOST
+#include "pico_spi_transport.hpp"
+#endif
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+namespace MicroSD {
+
+namespace {
+
+// === SD卡命令 (SPI模式) ===
+constexpr uint8_t CMD0   = 0;            // GO_IDLE_STATE
+constexpr uint8_t CMD1   = 1;            // SEND_OP_COND (MMC)
+constexpr uint8_t CMD8   = 8;            // SEND_IF_COND
+constexpr uint8_t CMD9   = 9;            // SEND_CSD
+constexpr uint8_t CMD12  = 12;           // STOP_TRANSMISSION
+constexpr uint8_t CMD16  = 16;           // SET_BLOCKLEN
+constexpr uint8_t CMD17  = 17;           // READ_SINGLE_BLOCK
+constexpr uint8_t CMD18  = 18;           // READ_MULTIPLE_BLOCK
+constexpr uint8_t CMD24  = 24;           // WRITE_BLOCK
+constexpr uint8_t CMD25  = 25;           // WRITE_MULTIPLE_BLOCK
+constexpr uint8_t CMD32  = 32;           // ERASE_WR_BLK_START
+constexpr uint8_t CMD33  = 33;           // ERASE_WR_BLK_END
+constexpr uint8_t CMD38  = 38;           // ERASE
+constexpr uint8_t CMD55  = 55;           // APP_CMD
+constexpr uint8_t CMD58  = 58;           // READ_OCR
+constexpr uint8_t CMD59  = 59;           // CRC_ON_OFF
+constexpr uint8_t ACMD13 = 0x80 | 13;    // SD_STATUS
+constexpr uint8_t ACMD23 = 0x80 | 23;    // SET_WR_BLK_ERASE_COUNT
+constexpr uint8_t ACMD41 = 0x80 | 41;    // SD_SEND_OP_COND
+
+// === 数据令牌 ===
+constexpr uint8_t TOKEN_START_BLOCK = 0xFE;
+constexpr uint8_t TOKEN_START_MULTI = 0xFC;
+constexpr uint8_t TOKEN_STOP_TRAN   = 0xFD;
+
+// === 超时 (毫秒) ===
+constexpr uint32_t TIMEOUT_INIT_MS  = 1000;
+constexpr uint32_t TIMEOUT_READY_MS = 500;
+constexpr uint32_t TIMEOUT_READ_MS  = 200;
+constexpr uint32_t TIMEOUT_ERASE_MS = 30000;
+
+// === 自适应时钟 ===
+// 名义档位，实际频率由传输层按分频取整
+constexpr uint32_t CLOCK_LADDER[] = {
+    1000000, 2000000, 4000000, 8000000, 12500000, 16000000, 20000000,
+    25000000, 31250000, 41666000, 50000000, 62500000
+};
+constexpr int PROBE_READS = 4;                  // 每个档位的CRC校验读取次数
+constexpr int MAX_ATTEMPTS = 3;                 // 读写失败后的尝试次数
+constexpr uint8_t FAULT_BURST = 2;              // 窗口内达到该故障次数即降频
+constexpr uint32_t FAULT_WINDOW_MS = 1000;
+constexpr uint32_t UPSHIFT_INTERVAL_MS = 30000; // 降频后无故障多久尝试升频
+constexpr uint32_t UPSHIFT_INTERVAL_MAX_MS = 8 * 60 * 1000;
+constexpr uint8_t R1_COM_CRC_ERROR = 0x08;
+constexpr uint8_t DATA_RESPONSE_ACCEPTED = 0x05;
+constexpr uint8_t DATA_RESPONSE_CRC_ERROR = 0x0B;
+constexpr uint8_t DATA_RESPONSE_WRITE_ERROR = 0x0D;
+
+uint8_t crc7(const uint8_t* data, size_t length) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < length; ++i) {
+        uint8_t byte = data[i];
+        for (int bit = 0; bit < 8; ++bit) {
+            crc <<= 1;
+            if ((byte ^ crc) & 0x80) {
+                crc ^= 0x09;
+            }
+            byte <<= 1;
+        }
+    }
+    return (crc << 1) | 0x01;
+}
+
+struct Crc16Table {
+    uint16_t entries[256];
+
+    constexpr Crc16Table() : entries() {
+        for (int i = 0; i < 256; ++i) {
+            uint16_t crc = static_cast<uint16_t>(i << 8);
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+            }
+            entries[i] = crc;
+        }
+    }
+};
+
+constexpr Crc16Table CRC16_TABLE;
+
+// CRC-16/XMODEM (多项式0x1021)，SD卡数据块校验
+uint16_t crc16(const uint8_t* data, size_t length) {
+    uint16_t crc = 0;
+    for (size_t i = 0; i < length; ++i) {
+        crc = static_cast<uint16_t>((crc << 8) ^ CRC16_TABLE.entries[((crc >> 8) ^ data[i]) & 0xFF]);
+    }
+    return crc;
+}
+
+} // namespace
+
+// === 构造函数和析构函数 ===
+
+#if !MICRO_SD_HOST
+SdSpiBlockDevice::SdSpiBlockDevice(const SPIConfig& config)
+    : SdSpiBlockDevice(std::make_unique<PicoSpiTransport>(config), config) {}
+#endif
+
+SdSpiBlockDevice::SdSpiBlockDevice(std::unique_ptr<SpiTransport> transport, const SPIConfig& config)
+    : transport_(std::move(transport)), config_(config), card_type_(CardType::UNKNOWN),
+      is_ready_(false), multi_block_(true), crc_enabled_(false), clock_steps_(),
+      step_count_(0), current_step_(0), negotiated_step_(0), last_fault_(LinkFault::NONE),
+      burst_faults_(0), burst_start_us_(0), last_fault_us_(0),
+      upshift_interval_ms_(UPSHIFT_INTERVAL_MS) {}
+
+SdSpiBlockDevice::~SdSpiBlockDevice() {
+    deinitialize();
+}
+
+// === 底层SPI传输 ===
+
+void SdSpiBlockDevice::deselect() {
+    transport_->deselect();
+    transfer(0xFF);  // 释放MISO
+}
+
+void SdSpiBlockDevice::select() {
+    transport_->select();
+    transfer(0xFF);
+}
+
+bool SdSpiBlockDevice::wait_ready(uint32_t timeout_ms) {
+    uint64_t deadline = Platform::now_us() + (uint64_t)timeout_ms * 1000;
+    do {
+        if (transfer(0xFF) == 0xFF) {
+            return true;
+        }
+    } while (Platform::now_us() < deadline);
+    last_fault_ = LinkFault::TIMEOUT;
+    return false;
+}
+
+// === SD协议 ===
+
+uint8_t SdSpiBlockDevice::send_command(uint8_t cmd, uint32_t arg) {
+    // ACMD<n> 需要先发送 CMD55
+    if (cmd & 0x80) {
+        cmd &= 0x7F;
+        uint8_t r1 = send_command(CMD55, 0);
+        if (r1 > 1) {
+            return r1;
+        }
+    }
+
+    // CMD12在多块读取过程中发送，不能重新选择卡
+    if (cmd != CMD12) {
+        deselect();
+        select();
+        if (cmd != CMD0 && !wait_ready(TIMEOUT_READY_MS)) {
+            return 0xFF;
+        }
+    }
+
+    uint8_t frame[6] = {
+        static_cast<uint8_t>(0x40 | cmd),
+        static_cast<uint8_t>(arg >> 24),
+        static_cast<uint8_t>(arg >> 16),
+        static_cast<uint8_t>(arg >> 8),
+        static_cast<uint8_t>(arg),
+        0
+    };
+    frame[5] = crc7(frame, 5);
+    transport_->write_bytes(frame, sizeof(frame));
+
+    if (cmd == CMD12) {
+        transfer(0xFF);  // 跳过填充字节
+    }
+
+    // 等待R1响应 (最多10字节)
+    uint8_t r1;
+    int tries = 10;
+    do {
+        r1 = transfer(0xFF);
+    } while ((r1 & 0x80) && --tries);
+
+    if (r1 == 0xFF) {
+        last_fault_ = LinkFault::TIMEOUT;
+    } else if (r1 & R1_COM_CRC_ERROR) {
+        last_fault_ = LinkFault::CRC;
+    }
+    return r1;
+}
+
+bool SdSpiBlockDevice::wait_data_token() {
+    uint64_t deadline = Platform::now_us() + (uint64_t)TIMEOUT_READ_MS * 1000;
+    uint8_t token;
+    do {
+        token = transfer(0xFF);
+    } while (token == 0xFF && Platform::now_us() < deadline);
+    if (token == 0xFF) {
+        last_fault_ = LinkFault::TIMEOUT;
+        return false;
+    }
+    if (token != TOKEN_START_BLOCK) {
+        // 0000xxxx为卡报告的数据错误令牌 (如地址越界)，不属于链路故障
+        if (token & 0xF0) {
+            last_fault_ = LinkFault::TOKEN;
+        }
+        return false;
+    }
+    return true;
+}
+
+uint16_t SdSpiBlockDevice::receive_crc() {
+    uint16_t received = static_cast<uint16_t>(transfer(0xFF) << 8);
+    return received | transfer(0xFF);
+}
+
+bool SdSpiBlockDevice::check_crc(const uint8_t* buffer, size_t length, uint16_t received) {
+    if (crc_enabled_ && received != crc16(buffer, length)) {
+        last_fault_ = LinkFault::CRC;
+        return false;
+    }
+    return true;
+}
+
+uint16_t SdSpiBlockDevice::block_crc(const uint8_t* buffer) const {
+    return crc_enabled_ ? crc16(buffer, SECTOR_SIZE) : 0xFFFF;
+}
+
+bool SdSpiBlockDevice::receive_data_block(uint8_t* buffer, size_t length) {
+    if (!wait_data_token()) {
+        return false;
+    }
+    transport_->read_bytes(buffer, length);
+    return check_crc(buffer, length, receive_crc());
+}
+
+bool SdSpiBlockDevice::send_data_token(uint8_t token) {
+    if (!wait_ready(TIMEOUT_READY_MS)) {
+        return false;
+    }
+    transfer(token);
+    return true;
+}
+
+bool SdSpiBlockDevice::finish_transmit_block(uint16_t crc) {
+    transfer(static_cast<uint8_t>(crc >> 8));
+    transfer(static_cast<uint8_t>(crc));
+
+    uint8_t response = transfer(0xFF) & 0x1F;
+    if (response == DATA_RESPONSE_CRC_ERROR) {
+        last_fault_ = LinkFault::CRC;
+    } else if (response != DATA_RESPONSE_ACCEPTED && response != DATA_RESPONSE_WRITE_ERROR) {
+        last_fault_ = LinkFault::TOKEN;
+    }
+    return response == DATA_RESPONSE_ACCEPTED;
+}
+
+bool SdSpiBlockDevice::transmit_data_block(const uint8_t* buffer, uint8_t token) {
+    if (!send_data_token(token)) {
+        return false;
+    }
+    if (token == TOKEN_STOP_TRAN) {
+        return true;
+    }
+    // CRC在数据块经由DMA发送的同时计算
+    transport_->start_write(buffer, SECTOR_SIZE);
+    uint16_t crc = block_crc(buffer);
+    transport_->wait_transfer();
+    return finish_transmit_block(crc);
+}
+
+bool SdSpiBlockDevice::read_register(uint8_t cmd, uint8_t* buffer, size_t length) {
+    bool ok = send_command(cmd, 0) == 0;
+    if (ok && cmd == ACMD13) {
+        transfer(0xFF);  // R2响应的第二个字节
+    }
+    ok = ok && receive_data_block(buffer, length);
+    deselect();
+    return ok;
+}
+
+bool SdSpiBlockDevice::read_geometry() {
+    uint8_t csd[16];
+    if (!read_register(CMD9, csd, sizeof(csd))) {
+        return false;
+    }
+
+    if ((csd[0] >> 6) == 1) {
+        // CSD v2.0
+        uint32_t c_size = csd[9] + ((uint32_t)csd[8] << 8) + ((uint32_t)(csd[7] & 63) << 16) + 1;
+        geometry_.sector_count = c_size << 10;
+    } else {
+        // CSD v1.0
+        uint8_t n = (csd[5] & 15) + ((csd[10] & 128) >> 7) + ((csd[9] & 3) << 1) + 2;
+        uint32_t c_size = (csd[8] >> 6) + ((uint32_t)csd[7] << 2) + ((uint32_t)(csd[6] & 3) << 10) + 1;
+        geometry_.sector_count = c_size << (n - 9);
+    }
+    geometry_.sector_size = SECTOR_SIZE;
+
+    // 擦除块大小
+    geometry_.erase_block_sectors = 1;
+    if (card_type_ == CardType::SD_V2 || card_type_ == CardType::SDHC) {
+        uint8_t status[64];
+        if (read_register(ACMD13, status, sizeof(status))) {
+            geometry_.erase_block_sectors = 16UL << (status[10] >> 4);
+        }
+    } else if (card_type_ == CardType::SD_V1) {
+        geometry_.erase_block_sectors =
+            (((csd[10] & 63) << 1) + ((csd[11] & 128) >> 7) + 1) << ((csd[13] >> 6) - 1);
+    } else {
+        geometry_.erase_block_sectors =
+            (((csd[10] & 124) >> 2) + 1) * (((csd[11] & 3) << 3) + ((csd[11] & 224) >> 5) + 1);
+    }
+
+    return geometry_.sector_count > 0;
+}
+
+uint32_t SdSpiBlockDevice::card_address(uint32_t sector) const {
+    // 标准容量卡使用字节地址
+    return card_type_ == CardType::SDHC ? sector : sector * SECTOR_SIZE;
+}
+
+// === BlockDevice接口 ===
+
+Result<void> SdSpiBlockDevice::initialize() {
+    if (is_ready_) {
+        return Result<void>();
+    }
+    if (!config_.is_valid()) {
+        return Result<void>(ErrorCode::INVALID_PARAMETER);
+    }
+
+    auto begin_result = transport_->begin(config_.clk_slow);
+    if (!begin_result.is_ok()) {
+        return begin_result;
+    }
+
+    // 至少74个时钟周期唤醒卡
+    transport_->deselect();
+    for (int i = 0; i < 10; ++i) {
+        transfer(0xFF);
+    }
+
+    card_type_ = CardType::UNKNOWN;
+    uint64_t deadline = Platform::now_us() + (uint64_t)TIMEOUT_INIT_MS * 1000;
+
+    if (send_command(CMD0, 0) == 1) {
+        if (send_command(CMD8, 0x1AA) == 1) {
+            // SD v2
+            uint8_t ocr[4];
+            for (auto& b : ocr) b = transfer(0xFF);
+            if (ocr[2] == 0x01 && ocr[3] == 0xAA) {
+                while (Platform::now_us() < deadline && send_command(ACMD41, 1UL << 30) != 0) {}
+                if (Platform::now_us() < deadline && send_command(CMD58, 0) == 0) {
+                    for (auto& b : ocr) b = transfer(0xFF);
+                    card_type_ = (ocr[0] & 0x40) ? CardType::SDHC : CardType::SD_V2;
+                }
+            }
+        } else {
+            // SD v1 或 MMC v3
+            uint8_t cmd;
+            CardType type;
+            if (send_command(ACMD41, 0) <= 1) {
+                type = CardType::SD_V1;
+                cmd = ACMD41;
+            } else {
+                type = CardType::MMC;
+                cmd = CMD1;
+            }
+            while (Platform::now_us() < deadline && send_command(cmd, 0) != 0) {}
+            if (Platform::now_us() < deadline && send_command(CMD16, SECTOR_SIZE) == 0) {
+                card_type_ = type;
+            }
+        }
+    }
+    deselect();
+
+    if (card_type_ == CardType::UNKNOWN) {
+        deinitialize();
+        return Result<void>(ErrorCode::INIT_FAILED);
+    }
+
+    // 启用卡端CRC校验，使链路错误能被检测到而不是静默写入错误数据
+    crc_enabled_ = send_command(CMD59, 1) == 0;
+    deselect();
+
+    build_clock_steps();
+    if (config_.adaptive_clock) {
+        negotiate_clock();
+    } else {
+        apply_clock_step(negotiated_step_);
+    }
+
+    if (!read_geometry()) {
+        deinitialize();
+        return Result<void>(ErrorCode::INIT_FAILED);
+    }
+
+    is_ready_ = true;
+    return Result<void>();
+}
+
+void SdSpiBlockDevice::deinitialize() {
+    transport_->end();
+    card_type_ = CardType::UNKNOWN;
+    crc_enabled_ = false;
+    is_ready_ = false;
+}
+
+bool SdSpiBlockDevice::read_blocks(uint32_t sector, uint8_t* buffer, uint32_t count) {
+    last_fault_ = LinkFault::NONE;
+
+    if (count > 1 && multi_block_) {
+        // CMD18连续读取，最后用CMD12结束传输
+        // 第N块经由DMA接收的同时在CPU上校验第N-1块的CRC
+        uint32_t received = 0;
+        uint16_t previous_crc = 0;
+        if (send_command(CMD18, card_address(sector)) == 0) {
+            while (received < count && wait_data_token()) {
+                uint8_t* block = buffer + (size_t)received * SECTOR_SIZE;
+                transport_->start_read(block, SECTOR_SIZE);
+                bool ok = received == 0 || check_crc(block - SECTOR_SIZE, SECTOR_SIZE, previous_crc);
+                transport_->wait_transfer();
+                previous_crc = receive_crc();
+                if (!ok) {
+                    break;
+                }
+                ++received;
+            }
+            send_command(CMD12, 0);
+        }
+        deselect();
+        return received == count &&
+               check_crc(buffer + (size_t)(count - 1) * SECTOR_SIZE, SECTOR_SIZE, previous_crc);
+    }
+
+    for (uint32_t i = 0; i < count; ++i) {
+        bool ok = send_command(CMD17, card_address(sector + i)) == 0 &&
+                  receive_data_block(buffer + (size_t)i * SECTOR_SIZE, SECTOR_SIZE);
+        deselect();
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 数据取自blocks[i] (非空时) 或buffer中的第i个扇区
+bool SdSpiBlockDevice::write_blocks(uint32_t sector, const uint8_t* buffer, const uint8_t* const* blocks,
+                                    uint32_t count) {
+    auto block_at = [&](uint32_t i) {
+        return blocks != nullptr ? blocks[i] : buffer + (size_t)i * SECTOR_SIZE;
+    };
+    last_fault_ = LinkFault::NONE;
+
+    if (count > 1 && multi_block_) {
+        // 预擦除提示: 告知卡即将写入的块数，减少逐块擦除开销
+        if (card_type_ != CardType::MMC) {
+            send_command(ACMD23, count);
+        }
+
+        // 第N块经由DMA发送的同时在CPU上计算第N+1块的CRC
+        uint32_t sent = 0;
+        if (send_command(CMD25, card_address(sector)) == 0) {
+            uint16_t crc = block_crc(block_at(0));
+            while (sent < count && send_data_token(TOKEN_START_MULTI)) {
+                transport_->start_write(block_at(sent), SECTOR_SIZE);
+                uint16_t next_crc = sent + 1 < count ? block_crc(block_at(sent + 1)) : 0;
+                transport_->wait_transfer();
+                if (!finish_transmit_block(crc)) {
+                    break;
+                }
+                crc = next_crc;
+                ++sent;
+            }
+            // 无论是否出错都必须发送STOP_TRAN结束传输
+            if (!transmit_data_block(nullptr, TOKEN_STOP_TRAN)) {
+                sent = 0;
+            }
+        }
+        deselect();
+        return sent == count;
+    }
+
+    for (uint32_t i = 0; i < count; ++i) {
+        bool ok = send_command(CMD24, card_address(sector + i)) == 0 &&
+                  transmit_data_block(block_at(i), TOKEN_START_BLOCK);
+        deselect();
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Result<void> SdSpiBlockDevice::read(uint32_t sector, uint8_t* buffer, uint32_t count) {
+    if (!is_ready_) {
+        return Result<void>(ErrorCode::INIT_FAILED);
+    }
+
+    for (int attempt = 0; attempt < MAX_ATTEMPTS; ++attempt) {
+        if (read_blocks(sector, buffer, count)) {
+            return Result<void>();
+        }
+        if (last_fault_ == LinkFault::NONE) {
+            break;  // 卡拒绝了请求，重试和降频都无济于事
+        }
+        record_fault();
+    }
+    return Result<void>(ErrorCode::IO_ERROR);
+}
+
+Result<void> SdSpiBlockDevice::write(uint32_t sector, const uint8_t* buffer, uint32_t count) {
+    return write_with_retry(sector, buffer, nullptr, count);
+}
+
+Result<void> SdSpiBlockDevice::write_gather(uint32_t sector, const uint8_t* const* blocks, uint32_t count) {
+    return write_with_retry(sector, nullptr, blocks, count);
+}
+
+Result<void> SdSpiBlockDevice::write_with_retry(uint32_t sector, const uint8_t* buffer,
+                                                const uint8_t* const* blocks, uint32_t count) {
+    if (!is_ready_) {
+        return Result<void>(ErrorCode::INIT_FAILED);
+    }
+
+    for (int attempt = 0; attempt < MAX_ATTEMPTS; ++attempt) {
+        if (write_blocks(sector, buffer, blocks, count)) {
+            return Result<void>();
+        }
+        if (last_fault_ == LinkFault::NONE) {
+            break;  // 卡拒绝了请求，重试和降频都无济于事
+        }
+        record_fault();
+    }
+    return Result<void>(ErrorCode::IO_ERROR);
+}
+
+Result<void> SdSpiBlockDevice::sync() {
+    if (!is_ready_) {
+        return Result<void>(ErrorCode::INIT_FAILED);
+    }
+
+    select();
+    bool ok = wait_ready(TIMEOUT_READY_MS);
+    deselect();
+    return ok ? Result<void>() : Result<void>(ErrorCode::IO_ERROR);
+}
+
+Result<void> SdSpiBlockDevice::trim(uint32_t first_sector, uint32_t count) {
+    if (!is_ready_) {
+        return Result<void>(ErrorCode::INIT_FAILED);
+    }
+    if (count == 0 || (card_type_ != CardType::SD_V2 && card_type_ != CardType::SDHC)) {
+        return Result<void>();
+    }
+
+    uint32_t last_sector = first_sector + count - 1;
+    bool ok = send_command(CMD32, card_address(first_sector)) == 0 &&
+              send_command(CMD33, card_address(last_sector)) == 0 &&
+              send_command(CMD38, 0) == 0 &&
+              wait_ready(TIMEOUT_ERASE_MS);
+    deselect();
+    return ok ? Result<void>() : Result<void>(ErrorCode::IO_ERROR);
+}
+
+// === 双缓冲流水线传输 ===
+
+Result<void> SdSpiBlockDevice::read_pipelined(uint32_t sector, uint32_t count, uint8_t* buffers,
+                                              const BlockVisitor& visit) {
+    if (!is_ready_) {
+        return Result<void>(ErrorCode::INIT_FAILED);
+    }
+    if (count == 0 || buffers == nullptr) {
+        return Result<void>(ErrorCode::INVALID_PARAMETER);
+    }
+
+    last_fault_ = LinkFault::NONE;
+    bool ok = send_command(CMD18, card_address(sector)) == 0;
+    uint32_t received = 0;
+    uint16_t previous_crc = 0;
+    while (ok && received < count) {
+        uint8_t* current = buffers + (size_t)(received & 1) * SECTOR_SIZE;
+        ok = wait_data_token();
+        if (!ok) {
+            break;
+        }
+
+        // 第N块在DMA中接收，同时CPU校验并处理第N-1块
+        transport_->start_read(current, SECTOR_SIZE);
+        if (received > 0) {
+            const uint8_t* previous = buffers + (size_t)((received - 1) & 1) * SECTOR_SIZE;
+            ok = check_crc(previous, SECTOR_SIZE, previous_crc) && visit(received - 1, previous);
+        }
+        transport_->wait_transfer();
+        previous_crc = receive_crc();
+        ++received;
+    }
+    send_command(CMD12, 0);
+    deselect();
+
+    if (ok && received == count) {
+        const uint8_t* last = buffers + (size_t)((count - 1) & 1) * SECTOR_SIZE;
+        ok = check_crc(last, SECTOR_SIZE, previous_crc) && visit(count - 1, last);
+    }
+    if (!ok && last_fault_ != LinkFault::NONE) {
+        record_fault();
+    }
+    return ok ? Result<void>() : Result<void>(ErrorCode::IO_ERROR);
+}
+
+Result<void> SdSpiBlockDevice::write_pipelined(uint32_t sector, uint32_t count, uint8_t* buffers,
+                                               const BlockProducer& produce) {
+    if (!is_ready_) {
+        return Result<void>(ErrorCode::INIT_FAILED);
+    }
+    if (count == 0 || buffers == nullptr) {
+        return Result<void>(ErrorCode::INVALID_PARAMETER);
+    }
+    if (!produce(0, buffers)) {
+        return Result<void>(ErrorCode::IO_ERROR);
+    }
+
+    if (card_type_ != CardType::MMC) {
+        send_command(ACMD23, count);
+    }
+
+    last_fault_ = LinkFault::NONE;
+    bool ok = send_command(CMD25, card_address(sector)) == 0;
+    uint32_t sent = 0;
+    while (ok && sent < count) {
+        const uint8_t* current = buffers + (size_t)(sent & 1) * SECTOR_SIZE;
+        ok = send_data_token(TOKEN_START_MULTI);
+        if (!ok) {
+            break;
+        }
+
+        // 第N块在DMA中发送，同时CPU计算其CRC并准备第N+1块
+        transport_->start_write(current, SECTOR_SIZE);
+        uint16_t crc = block_crc(current);
+        if (sent + 1 < count) {
+            uint8_t* next = buffers + (size_t)((sent + 1) & 1) * SECTOR_SIZE;
+            ok = produce(sent + 1, next);
+        }
+        transport_->wait_transfer();
+        ok = finish_transmit_block(crc) && ok;
+        ++sent;
+    }
+    // 无论是否出错都必须发送STOP_TRAN结束传输
+    if (!transmit_data_block(nullptr, TOKEN_STOP_TRAN)) {
+        ok = false;
+    }
+    deselect();
+    if (!ok && last_fault_ != LinkFault::NONE) {
+        record_fault();
+    }
+    return ok && sent == count ? Result<void>() : Result<void>(ErrorCode::IO_ERROR);
+}
+
+// === 自适应时钟 ===
+
+void SdSpiBlockDevice::build_clock_steps() {
+    // 档位0为初始化时钟，随后是(clk_slow, clk_max]内的名义档位，clk_fast按序插入
+    step_count_ = 0;
+    clock_steps_[step_count_++] = config_.clk_slow;
+    bool fast_inserted = config_.clk_fast <= config_.clk_slow;
+    for (uint32_t hz : CLOCK_LADDER) {
+        if (!fast_inserted && config_.clk_fast <= hz) {
+            clock_steps_[step_count_++] = config_.clk_fast;
+            fast_inserted = true;
+            if (hz == config_.clk_fast) {
+                continue;
+            }
+        }
+        if (hz > config_.clk_slow && hz <= config_.clk_max && step_count_ < MAX_CLOCK_STEPS - 1) {
+            clock_steps_[step_count_++] = hz;
+        }
+    }
+    if (!fast_inserted) {
+        clock_steps_[step_count_++] = config_.clk_fast;
+    }
+
+    // 起始档位为clk_fast
+    negotiated_step_ = 0;
+    for (uint8_t i = 0; i < step_count_; ++i) {
+        if (clock_steps_[i] == config_.clk_fast) {
+            negotiated_step_ = i;
+        }
+    }
+    current_step_ = negotiated_step_;
+}
+
+void SdSpiBlockDevice::apply_clock_step(uint8_t step) {
+    current_step_ = step;
+    clock_stats_.current_hz = transport_->set_clock(clock_steps_[step]);
+}
+
+bool SdSpiBlockDevice::probe_clock_step(uint8_t step) {
+    apply_clock_step(step);
+
+    // 多次读取0扇区: 每次都需通过CRC16校验且内容一致
+    uint8_t reference[SECTOR_SIZE];
+    uint8_t sample[SECTOR_SIZE];
+    if (!read_blocks(0, reference, 1)) {
+        return false;
+    }
+    for (int i = 1; i < PROBE_READS; ++i) {
+        if (!read_blocks(0, sample, 1) || memcmp(reference, sample, SECTOR_SIZE) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SdSpiBlockDevice::negotiate_clock() {
+    uint8_t step = negotiated_step_;
+
+    // 起始频率不稳定时逐级降低
+    while (step > 0 && !probe_clock_step(step)) {
+        --step;
+    }
+
+    // 向上探测直到失败或达到clk_max
+    while (step + 1 < step_count_ && probe_clock_step(step + 1)) {
+        ++step;
+    }
+
+    // 按实际频率去重 (分频取整后多个档位可能相同)，使运行时每次升/降档都真正改变时钟
+    uint8_t count = 0;
+    uint32_t last_hz = 0;
+    for (uint8_t i = 0; i <= step; ++i) {
+        uint32_t actual = transport_->set_clock(clock_steps_[i]);
+        if (count == 0 || actual > last_hz) {
+            clock_steps_[count++] = clock_steps_[i];
+            last_hz = actual;
+        }
+    }
+    step_count_ = count;
+    negotiated_step_ = count - 1;
+    apply_clock_step(negotiated_step_);
+    clock_stats_.negotiated_hz = clock_stats_.current_hz;
+    burst_faults_ = 0;
+    last_fault_us_ = 0;
+    upshift_interval_ms_ = UPSHIFT_INTERVAL_MS;
+}
+
+void SdSpiBlockDevice::record_fault() {
+    uint64_t now = Platform::now_us();
+    if (last_fault_ == LinkFault::CRC) {
+        ++clock_stats_.crc_errors;
+    } else if (last_fault_ == LinkFault::TOKEN) {
+        ++clock_stats_.token_errors;
+    } else {
+        ++clock_stats_.timeouts;
+    }
+    ++clock_stats_.retries;
+    last_fault_us_ = now;
+
+    if (!config_.adaptive_clock) {
+        return;
+    }
+    if (burst_faults_ == 0 || now - burst_start_us_ > (uint64_t)FAULT_WINDOW_MS * 1000) {
+        burst_start_us_ = now;
+        burst_faults_ = 0;
+    }
+    if (++burst_faults_ >= FAULT_BURST && current_step_ > 0) {
+        // 连续故障: 降低一档，稍后再尝试恢复
+        apply_clock_step(current_step_ - 1);
+        ++clock_stats_.downshifts;
+        burst_faults_ = 0;
+    }
+}
+
+Result<void> SdSpiBlockDevice::maintain() {
+    if (!is_ready_) {
+        return Result<void>(ErrorCode::INIT_FAILED);
+    }
+
+    maybe_upshift();
+    return Result<void>();
+}
+
+void SdSpiBlockDevice::maybe_upshift() {
+    if (!config_.adaptive_clock || current_step_ >= negotiated_step_) {
+        return;
+    }
+    uint64_t now = Platform::now_us();
+    if (now - last_fault_us_ < (uint64_t)upshift_interval_ms_ * 1000) {
+        return;
+    }
+
+    uint8_t fallback = current_step_;
+    if (probe_clock_step(current_step_ + 1)) {
+        ++clock_stats_.upshifts;
+        upshift_interval_ms_ = UPSHIFT_INTERVAL_MS;
+    } else {
+        // 升频失败: 退回并延长下次尝试的间隔
+        apply_clock_step(fallback);
+        upshift_interval_ms_ = std::min(upshift_interval_ms_ * 2, UPSHIFT_INTERVAL_MAX_MS);
+    }
+    last_fault_us_ = now;
+}
+
+std::string SdSpiBlockDevice::get_config_info() const {
+    std::ostringstream oss;
+    oss << "=== SPI配置信息 ===\n";
+    oss << transport_->get_config_info();
+    oss << "波特率: " << transport_->get_clock() << " Hz";
+    if (config_.adaptive_clock) {
+        oss << " (协商: " << clock_stats_.negotiated_hz << " Hz)";
+    }
+    oss << "\n";
+    oss << "CRC校验: " << (crc_enabled_ ? "启用" : "禁用") << "\n";
+    oss << "时钟调整: 降频 " << clock_stats_.downshifts << " 次, 升频 " << clock_stats_.upshifts
+        << " 次 (CRC错误 " << clock_stats_.crc_errors << ", 超时 " << clock_stats_.timeouts
+        << ", 令牌错误 " << clock_stats_.token_errors << ")\n";
+    oss << "多块传输: " << (multi_block_ ? "启用" : "禁用") << "\n";
+    return oss.str();
+}
+
+} // namespace MicroSD
@@ -0,0 +1,955 @@
+/**
+ * @file search_index.cpp
+ * @brief 卡上文件搜索索引实现
+ * @version 1.0.0
+ */
+
+#include "search_index.hpp"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+namespace MicroSD {
+
+namespace {
+
+constexpr const char* INDEX_FILE = "names.idx";
+constexpr const char* INDEX_TEMP_FILE = "names.idx.tmp";    // 与write_file_atomic相同的后缀，中断时由recover_file()删除
+constexpr const char* JOURNAL_FILE = "journal.log";
+constexpr const char* PATHS_FILE = "paths.tmp";
+
+constexpr uint8_t INDEX_MAGIC[4] = {'S', 'I', 'D', 'X'};
+constexpr uint8_t JOURNAL_MAGIC[4] = {'S', 'J', 'N', 'L'};
+constexpr uint32_t VERSION = 1;
+constexpr size_t HEADER_SIZE = 32;
+constexpr size_t RECORD_SIZE = 8;
+constexpr size_t JOURNAL_HEADER = sizeof(JOURNAL_MAGIC);
+
+constexpr char OP_ADD = 'A';
+constexpr char OP_REMOVE = 'R';
+constexpr char OP_STAMP = 'T';
+constexpr size_t STAMP_SIZE = 11;       // 'T' 长度(1) 总扇区数(4) 空闲扇区数(4) 标志(1)
+constexpr uint8_t STAMP_STALE = 0x01;
+
+inline char upper(char c) {
+    return (c >= 'a' && c <= 'z') ? c - 'a' + 'A' : c;
+}
+
+uint32_t fnv1a(const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+uint16_t load_u16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+uint32_t load_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void store_u16(uint8_t* p, uint16_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+void store_u32(uint8_t* p, uint32_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+bool same_path(const char* a, const char* b, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        if (upper(a[i]) != upper(b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 不区分大小写比较名字，reversed时从末尾向前比较 (后缀数组的顺序)
+int compare_names(const char* a, size_t a_length, const char* b, size_t b_length, bool reversed) {
+    size_t length = std::min(a_length, b_length);
+    for (size_t i = 0; i < length; ++i) {
+        uint8_t ca = (uint8_t)upper(reversed ? a[a_length - 1 - i] : a[i]);
+        uint8_t cb = (uint8_t)upper(reversed ? b[b_length - 1 - i] : b[i]);
+        if (ca != cb) {
+            return ca < cb ? -1 : 1;
+        }
+    }
+    return a_length < b_length ? -1 : (a_length > b_length ? 1 : 0);
+}
+
+// name是否以key开头 (reversed时为结尾)
+bool name_matches(const char* name, size_t name_length, std::string_view key, bool reversed) {
+    if (key.size() > name_length) {
+        return false;
+    }
+    return compare_names(reversed ? name + name_length - key.size() : name, key.size(),
+                         key.data(), key.size(), false) == 0;
+}
+
+const char* last_component(const char* path, size_t length) {
+    const char* name = path + length;
+    while (name > path && name[-1] != '/') {
+        --name;
+    }
+    return name;
+}
+
+Result<void> write_all(RWSD::FileHandle& file, const void* data, size_t size) {
+    auto written = file.write(data, size);
+    if (!written.is_ok()) {
+        return Result<void>(written.error_code());
+    }
+    if (*written < size) {
+        return Result<void>(ErrorCode::DISK_FULL);
+    }
+    return Result<void>();
+}
+
+template<typename T>
+void release(std::pmr::vector<T>& buffer) {
+    std::pmr::vector<T>(buffer.get_allocator()).swap(buffer);
+}
+
+std::pmr::memory_resource* memory_of(RWSD& sd) {
+    return sd.get_memory_resource() ? sd.get_memory_resource() : std::pmr::null_memory_resource();
+}
+
+} // namespace
+
+SearchIndex::SearchIndex(RWSD& sd, const SearchIndexConfig& config)
+    : sd_(sd), config_(config), directory_length_(0), count_(0), suffix_offset_(0), strings_offset_(0),
+      journal_(memory_of(sd)), journal_records_(0), journal_saved_(false), stale_(true), open_(false),
+      records_(memory_of(sd)), names_(memory_of(sd)), paths_size_(0), journal_mark_(0),
+      rebuilding_(false), incomplete_(false), build_error_(ErrorCode::SUCCESS) {
+    // 目录名之后还要追加"/names.idx.tmp"
+    directory_length_ = config.directory ? normalize(config.directory, directory_) : 0;
+    if (directory_length_ == 0 || directory_length_ + 16 >= MICRO_SD_MAX_PATH) {
+        directory_[0] = '\0';
+        directory_length_ = 0;
+    }
+    config_.directory = directory_;
+    present_[0] = '\0';
+}
+
+void SearchIndex::file_path(const char* name, char* path, size_t size) const {
+    snprintf(path, size, "%s/%s", directory_, name);
+}
+
+size_t SearchIndex::normalize(const char* path, char* out) const {
+    // "/a/b"形式: 一个开头的'/'，去掉重复和结尾的'/'；根目录和放不下的路径返回0
+    size_t length = 0;
+    out[length++] = '/';
+    for (const char* p = path; *p; ++p) {
+        if (*p == '/' && out[length - 1] == '/') {
+            continue;
+        }
+        if (length + 1 >= MICRO_SD_MAX_PATH) {
+            return 0;
+        }
+        out[length++] = *p;
+    }
+    if (out[length - 1] == '/') {
+        --length;
+    }
+    out[length] = '\0';
+    return length;
+}
+
+bool SearchIndex::is_own(const char* normalized, size_t length) const {
+    return directory_length_ > 0 && length >= directory_length_ &&
+           same_path(normalized, directory_, directory_length_) &&
+           (normalized[directory_length_] == '\0' || normalized[directory_length_] == '/');
+}
+
+// === 查询 ===
+
+Result<void> SearchIndex::read_at(uint32_t offset, void* buffer, size_t size) const {
+    char path[MICRO_SD_MAX_PATH];
+    file_path(INDEX_FILE, path, sizeof(path));
+    auto read = sd_.read_file_into(path, buffer, size, offset);
+    if (!read.is_ok()) {
+        return Result<void>(read.error_code());
+    }
+    if (*read != size) {
+        return Result<void>(ErrorCode::IO_ERROR, "索引文件不完整");
+    }
+    return Result<void>();
+}
+
+Result<void> SearchIndex::read_entry(uint32_t position, bool by_suffix, uint8_t* record, char* name) {
+    uint32_t slot = position;
+    if (by_suffix) {
+        uint8_t raw[4];
+        auto read = read_at(suffix_offset_ + position * 4, raw, sizeof(raw));
+        if (!read.is_ok()) {
+            return read;
+        }
+        slot = load_u32(raw);
+        if (slot >= count_) {
+            return Result<void>(ErrorCode::IO_ERROR, "索引文件损坏");
+        }
+    }
+    auto read = read_at(HEADER_SIZE + slot * RECORD_SIZE, record, RECORD_SIZE);
+    if (!read.is_ok()) {
+        return read;
+    }
+    ++stats_.probes;
+
+    // 名字是路径的最后一级
+    uint16_t path_length = load_u16(record + 4);
+    uint8_t name_length = record[6];
+    if (name_length > path_length || path_length >= MICRO_SD_MAX_PATH) {
+        return Result<void>(ErrorCode::IO_ERROR, "索引文件损坏");
+    }
+    name[name_length] = '\0';
+    return read_at(strings_offset_ + load_u32(record) + path_length - name_length, name, name_length);
+}
+
+Result<uint32_t> SearchIndex::lower_bound(std::string_view key, bool by_suffix) {
+    uint8_t record[RECORD_SIZE];
+    char name[256];
+    uint32_t low = 0;
+    uint32_t high = count_;
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        auto read = read_entry(middle, by_suffix, record, name);
+        if (!read.is_ok()) {
+            return Result<uint32_t>(read.error_code(), read.error_message());
+        }
+        if (compare_names(name, record[6], key.data(), key.size(), by_suffix) < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return Result<uint32_t>(low);
+}
+
+Result<bool> SearchIndex::base_contains(const char* path, size_t length) {
+    const char* name = last_component(path, length);
+    std::string_view key(name, path + length - name);
+    auto first = lower_bound(key, false);
+    if (!first.is_ok()) {
+        return Result<bool>(first.error_code(), first.error_message());
+    }
+
+    uint8_t record[RECORD_SIZE];
+    char found[256];
+    for (uint32_t position = *first; position < count_; ++position) {
+        auto read = read_entry(position, false, record, found);
+        if (!read.is_ok()) {
+            return Result<bool>(read.error_code(), read.error_message());
+        }
+        if (compare_names(found, record[6], key.data(), key.size(), false) != 0) {
+            break;
+        }
+        if (load_u16(record + 4) != length) {
+            continue;
+        }
+        char stored[MICRO_SD_MAX_PATH];
+        read = read_at(strings_offset_ + load_u32(record), stored, length);
+        if (!read.is_ok()) {
+            return Result<bool>(read.error_code(), read.error_message());
+        }
+        if (same_path(stored, path, length)) {
+            return Result<bool>(true);
+        }
+    }
+    return Result<bool>(false);
+}
+
+char SearchIndex::journal_state(const char* path, size_t length, size_t from) const {
+    char state = 0;
+    for (size_t position = from; position + 2 <= journal_.size(); position += 2 + journal_[position + 1]) {
+        if (journal_[position + 1] == length &&
+            same_path(reinterpret_cast<const char*>(&journal_[position + 2]), path, length)) {
+            state = (char)journal_[position];
+        }
+    }
+    return state;
+}
+
+Result<size_t> SearchIndex::query(std::string_view key, bool by_suffix, const Visitor& visit) {
+    if (!open_) {
+        return Result<size_t>(ErrorCode::INIT_FAILED);
+    }
+    ++stats_.queries;
+    size_t visited = 0;
+    if (key.size() > UINT8_MAX) {
+        return Result<size_t>(visited);
+    }
+
+    // 1. 变更日志中新增且之后没有被删除的文件 (回调可能修改文件，日志只会在末尾增长)
+    char path[MICRO_SD_MAX_PATH];
+    for (size_t position = JOURNAL_HEADER; position + 2 <= journal_.size();) {
+        char op = (char)journal_[position];
+        size_t length = journal_[position + 1];
+        size_t next = position + 2 + length;
+        if (op == OP_ADD) {
+            memcpy(path, &journal_[position + 2], length);
+            path[length] = '\0';
+            const char* name = last_component(path, length);
+            if (journal_state(path, length, next) == 0 &&
+                name_matches(name, path + length - name, key, by_suffix)) {
+                ++visited;
+                if (!visit(std::string_view(path, length))) {
+                    return Result<size_t>(visited);
+                }
+            }
+        }
+        position = next;
+    }
+
+    // 2. 索引文件: 二分查找第一个不小于key的名字，之后连续的名字都以key开头 (结尾)
+    auto first = lower_bound(key, by_suffix);
+    if (!first.is_ok()) {
+        return Result<size_t>(first.error_code(), first.error_message());
+    }
+    uint8_t record[RECORD_SIZE];
+    char name[256];
+    for (uint32_t position = *first; position < count_; ++position) {
+        auto read = read_entry(position, by_suffix, record, name);
+        if (!read.is_ok()) {
+            return Result<size_t>(read.error_code(), read.error_message());
+        }
+        if (!name_matches(name, record[6], key, by_suffix)) {
+            break;
+        }
+        uint16_t length = load_u16(record + 4);
+        read = read_at(strings_offset_ + load_u32(record), path, length);
+        if (!read.is_ok()) {
+            return Result<size_t>(read.error_code(), read.error_message());
+        }
+        path[length] = '\0';
+        // 日志中出现过的路径已在上面按日志处理
+        if (journal_state(path, length, JOURNAL_HEADER) != 0) {
+            continue;
+        }
+        ++visited;
+        if (!visit(std::string_view(path, length))) {
+            break;
+        }
+    }
+    return Result<size_t>(visited);
+}
+
+bool SearchIndex::confirm(std::string_view path) {
+    if (sd_.file_exists(std::string(path))) {
+        return true;
+    }
+    // 卷状态检测不到的外部修改 (见类注释)；重建中不影响本次遍历的结果
+    stale_ = true;
+    return false;
+}
+
+Result<size_t> SearchIndex::find_prefix(std::string_view prefix, const Visitor& visit) {
+    return query(prefix, false, visit);
+}
+
+Result<size_t> SearchIndex::find_suffix(std::string_view suffix, const Visitor& visit) {
+    return query(suffix, true, visit);
+}
+
+Result<size_t> SearchIndex::find_extension(std::string_view extension, const Visitor& visit) {
+    char suffix[256];
+    if (extension.size() + 1 > sizeof(suffix)) {
+        return Result<size_t>((size_t)0);
+    }
+    suffix[0] = '.';
+    memcpy(suffix + 1, extension.data(), extension.size());
+    return query(std::string_view(suffix, extension.size() + 1), true, visit);
+}
+
+// === 变更记录 ===
+
+void SearchIndex::mark_stale() {
+    stale_ = true;
+    if (rebuilding_) {
+        incomplete_ = true;
+    }
+}
+
+void SearchIndex::append(char op, const char* path, size_t length) {
+    if (journal_.size() + 2 + length > JOURNAL_HEADER + config_.journal_bytes) {
+        mark_stale();
+        return;
+    }
+    journal_.push_back((uint8_t)op);
+    journal_.push_back((uint8_t)length);
+    journal_.insert(journal_.end(), path, path + length);
+    ++journal_records_;
+}
+
+void SearchIndex::record_create(const char* path, size_t length) {
+    char state = journal_state(path, length, JOURNAL_HEADER);
+    if (state == OP_ADD) {
+        return;
+    }
+    // 重建期间遍历结果中可能已有或没有该文件，无条件记录
+    if (state == 0 && !rebuilding_) {
+        if (strlen(present_) == length && same_path(present_, path, length)) {
+            return;
+        }
+        auto present = base_contains(path, length);
+        if (!present.is_ok()) {
+            mark_stale();
+            return;
+        }
+        if (*present) {
+            memcpy(present_, path, length + 1);
+            return;
+        }
+    }
+    append(OP_ADD, path, length);
+}
+
+void SearchIndex::record_remove(const char* path, size_t length) {
+    if (strlen(present_) == length && same_path(present_, path, length)) {
+        present_[0] = '\0';
+    }
+    char state = journal_state(path, length, JOURNAL_HEADER);
+    if (state == OP_REMOVE) {
+        return;
+    }
+    if (state == 0 && !rebuilding_) {
+        auto present = base_contains(path, length);
+        if (!present.is_ok()) {
+            mark_stale();
+            return;
+        }
+        if (!*present) {
+            return;  // 目录或没有被索引的文件
+        }
+    }
+    append(OP_REMOVE, path, length);
+}
+
+void SearchIndex::on_file_change(FileChange change, const char* path, const char* new_path) {
+    if (!open_) {
+        return;
+    }
+    if (change == FileChange::FORMATTED) {
+        // 索引文件随卷一起被清除
+        abort_rebuild();
+        count_ = 0;
+        journal_.resize(JOURNAL_HEADER);
+        journal_records_ = 0;
+        journal_saved_ = false;
+        stale_ = true;
+        present_[0] = '\0';
+        return;
+    }
+
+    char source[MICRO_SD_MAX_PATH];
+    char target[MICRO_SD_MAX_PATH];
+    size_t source_length = normalize(path, source);
+    size_t target_length = (change == FileChange::RENAMED && new_path) ? normalize(new_path, target) : 0;
+    bool source_indexed = source_length > 0 && !is_own(source, source_length);
+    bool target_indexed = target_length > 0 && !is_own(target, target_length);
+    if (!source_indexed && !target_indexed) {
+        return;  // 索引自身的文件
+    }
+    discard_journal_file();
+
+    switch (change) {
+        case FileChange::CREATED:
+            record_create(source, source_length);
+            break;
+        case FileChange::REMOVED:
+            record_remove(source, source_length);
+            break;
+        case FileChange::RENAMED:
+            if (target_indexed) {
+                // 目录改名后其下所有文件的路径都变了，日志无法逐个记录
+                auto info = sd_.get_file_info(target);
+                if (!info.is_ok() || info->is_directory) {
+                    mark_stale();
+                    break;
+                }
+            }
+            if (source_indexed) {
+                record_remove(source, source_length);
+            }
+            if (target_indexed) {
+                record_create(target, target_length);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// === 打开、关闭与持久化 ===
+
+Result<void> SearchIndex::volume_stamp(uint32_t& total, uint32_t& free) const {
+    auto capacity = sd_.get_capacity();
+    if (!capacity.is_ok()) {
+        return Result<void>(capacity.error_code());
+    }
+    total = (uint32_t)(capacity->first / 512);
+    free = (uint32_t)(capacity->second / 512);
+    return Result<void>();
+}
+
+Result<void> SearchIndex::load_header() {
+    count_ = 0;
+    suffix_offset_ = 0;
+    strings_offset_ = 0;
+
+    char path[MICRO_SD_MAX_PATH];
+    file_path(INDEX_FILE, path, sizeof(path));
+    uint8_t header[HEADER_SIZE];
+    auto read = sd_.read_file_into(path, header, sizeof(header));
+    if (!read.is_ok()) {
+        return Result<void>(read.error_code());
+    }
+    if (*read != HEADER_SIZE || memcmp(header, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 ||
+        load_u32(header + 4) != VERSION || load_u32(header + 28) != fnv1a(header, 28)) {
+        return Result<void>(ErrorCode::IO_ERROR, "索引文件损坏");
+    }
+
+    uint32_t count = load_u32(header + 8);
+    uint32_t suffix_offset = load_u32(header + 12);
+    uint32_t strings_offset = load_u32(header + 16);
+    uint32_t strings_size = load_u32(header + 20);
+    if (suffix_offset != HEADER_SIZE + (uint64_t)count * RECORD_SIZE ||
+        strings_offset != suffix_offset + (uint64_t)count * 4) {
+        return Result<void>(ErrorCode::IO_ERROR, "索引文件损坏");
+    }
+    // 索引只经replace_file()整体换上，长度不符说明文件在别处被改动过
+    auto info = sd_.get_file_info(path);
+    if (!info.is_ok() || info->size != (uint64_t)strings_offset + strings_size) {
+        return Result<void>(ErrorCode::IO_ERROR, "索引文件不完整");
+    }
+
+    count_ = count;
+    suffix_offset_ = suffix_offset;
+    strings_offset_ = strings_offset;
+    return Result<void>();
+}
+
+Result<void> SearchIndex::load_journal() {
+    journal_.resize(JOURNAL_HEADER + config_.journal_bytes + STAMP_SIZE);
+    char path[MICRO_SD_MAX_PATH];
+    file_path(JOURNAL_FILE, path, sizeof(path));
+    auto read = sd_.read_file_into(path, journal_.data(), journal_.size());
+    size_t size = read.is_ok() ? *read : 0;
+
+    // 末尾必须是完整的卷状态记录，之前是格式正确的变更记录
+    bool valid = size >= JOURNAL_HEADER + STAMP_SIZE && size < journal_.size() &&
+                 memcmp(journal_.data(), JOURNAL_MAGIC, JOURNAL_HEADER) == 0;
+    size_t end = valid ? size - STAMP_SIZE : 0;
+    const uint8_t* stamp = journal_.data() + end;
+    valid = valid && stamp[0] == OP_STAMP && stamp[1] == STAMP_SIZE - 2;
+    uint32_t records = 0;
+    for (size_t position = JOURNAL_HEADER; valid && position < end; ++records) {
+        char op = (char)journal_[position];
+        size_t length = position + 2 <= end ? journal_[position + 1] : 0;
+        valid = (op == OP_ADD || op == OP_REMOVE) && length > 0 && position + 2 + length <= end;
+        position += 2 + length;
+    }
+    if (valid) {
+        uint32_t total;
+        uint32_t free;
+        auto current = volume_stamp(total, free);
+        valid = current.is_ok() && load_u32(stamp + 2) == total && load_u32(stamp + 6) == free;
+    }
+
+    if (!valid) {
+        // 上次没有正常关闭，或卡在别处被修改过
+        journal_.resize(JOURNAL_HEADER);
+        journal_records_ = 0;
+        stale_ = true;
+        return Result<void>(ErrorCode::IO_ERROR, "索引已过期");
+    }
+    stale_ = stale_ || (stamp[10] & STAMP_STALE) != 0;
+    journal_.resize(end);
+    journal_records_ = records;
+    journal_saved_ = true;
+    return Result<void>();
+}
+
+Result<void> SearchIndex::save_journal() {
+    if (journal_saved_ || !sd_.file_exists(directory_)) {
+        return Result<void>();  // 没有变化，或还没有建立过索引
+    }
+    char path[MICRO_SD_MAX_PATH];
+    file_path(JOURNAL_FILE, path, sizeof(path));
+
+    // 写入日志本身可能改变空闲扇区数，重写直到记录的状态与写入后一致
+    uint32_t total = 0;
+    uint32_t free = 0;
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        uint32_t now_total;
+        uint32_t now_free;
+        auto stamp = volume_stamp(now_total, now_free);
+        if (!stamp.is_ok()) {
+            return stamp;
+        }
+        if (attempt > 0 && now_total == total && now_free == free) {
+            journal_saved_ = true;
+            break;
+        }
+        total = now_total;
+        free = now_free;
+
+        size_t size = journal_.size();
+        journal_.resize(size + STAMP_SIZE);
+        uint8_t* tail = journal_.data() + size;
+        tail[0] = OP_STAMP;
+        tail[1] = STAMP_SIZE - 2;
+        store_u32(tail + 2, total);
+        store_u32(tail + 6, free);
+        tail[10] = stale_ ? STAMP_STALE : 0;
+        auto written = sd_.write_file(path, journal_.data(), journal_.size());
+        journal_.resize(size);
+        if (!written.is_ok()) {
+            return written;
+        }
+    }
+    return Result<void>();
+}
+
+void SearchIndex::discard_journal_file() {
+    // 卡上的日志不再反映当前状态: 删除后若未正常关闭，下次打开时索引为过期状态
+    if (!journal_saved_) {
+        return;
+    }
+    journal_saved_ = false;
+    char path[MICRO_SD_MAX_PATH];
+    file_path(JOURNAL_FILE, path, sizeof(path));
+    (void)sd_.delete_file(path);
+}
+
+Result<void> SearchIndex::open() {
+    if (open_) {
+        return Result<void>();
+    }
+    if (!sd_.is_initialized()) {
+        return Result<void>(ErrorCode::INIT_FAILED);
+    }
+    if (directory_length_ == 0 || config_.journal_bytes == 0 || config_.max_files == 0 ||
+        config_.max_files > UINT32_MAX) {
+        return Result<void>(ErrorCode::INVALID_PARAMETER);
+    }
+    if (sd_.get_memory_resource() == nullptr) {
+        return Result<void>(ErrorCode::INVALID_PARAMETER, "未设置内存资源");
+    }
+    if (sd_.get_change_listener() != nullptr && sd_.get_change_listener() != this) {
+        return Result<void>(ErrorCode::INVALID_PARAMETER, "已设置其他变更监听器");
+    }
+
+    journal_.reserve(JOURNAL_HEADER + config_.journal_bytes + STAMP_SIZE);
+    journal_.assign(JOURNAL_MAGIC, JOURNAL_MAGIC + JOURNAL_HEADER);
+    journal_records_ = 0;
+    journal_saved_ = false;
+    stale_ = false;
+    present_[0] = '\0';
+    stats_ = SearchIndexStats();
+
+    if (sd_.file_exists(directory_)) {
+        char path[MICRO_SD_MAX_PATH];
+        // 重建在替换索引文件时被中断
+        file_path(INDEX_FILE, path, sizeof(path));
+        (void)sd_.recover_file(path);
+        file_path(PATHS_FILE, path, sizeof(path));
+        (void)sd_.delete_file(path);
+
+        bool loaded = load_header().is_ok();
+        (void)load_journal();
+        stale_ = stale_ || !loaded;
+    } else {
+        stale_ = true;
+    }
+
+    sd_.set_change_listener(this);
+    open_ = true;
+    return Result<void>();
+}
+
+Result<void> SearchIndex::close() {
+    if (!open_) {
+        return Result<void>();
+    }
+    abort_rebuild();
+    auto saved = sd_.is_initialized() ? save_journal() : Result<void>();
+    if (sd_.get_change_listener() == this) {
+        sd_.set_change_listener(nullptr);
+    }
+    open_ = false;
+    release(journal_);
+    return saved;
+}
+
+Result<void> SearchIndex::flush() {
+    if (!open_) {
+        return Result<void>(ErrorCode::INIT_FAILED);
+    }
+    return save_journal();
+}
+
+// === 重建 ===
+
+WalkAction SearchIndex::Collector::enter(const WalkEntry& entry) {
+    if (entry.is_directory()) {
+        return index_.is_own(entry.path, strlen(entry.path)) ? WalkAction::SKIP : WalkAction::CONTINUE;
+    }
+    return index_.add_file(entry) ? WalkAction::CONTINUE : WalkAction::STOP;
+}
+
+void SearchIndex::Collector::depth_limit(const WalkEntry& entry) {
+    (void)entry;
+    index_.incomplete_ = true;
+}
+
+bool SearchIndex::add_file(const WalkEntry& entry) {
+    size_t path_length = strlen(entry.path);
+    size_t name_length = strlen(entry.name);
+    if (records_.size() >= config_.max_files || names_.size() + name_length > config_.name_bytes ||
+        name_length > UINT8_MAX) {
+        incomplete_ = true;
+        return false;
+    }
+    auto written = write_all(paths_file_, entry.path, path_length);
+    if (!written.is_ok()) {
+        build_error_ = written.error_code();
+        return false;
+    }
+    records_.push_back(BuildRecord{(uint32_t)names_.size(), paths_size_, 0, (uint16_t)path_length,
+                                   (uint8_t)name_length});
+    names_.insert(names_.end(), entry.name, entry.name + name_length);
+    paths_size_ += (uint32_t)path_length;
+    return true;
+}
+
+Result<void> SearchIndex::start_rebuild() {
+    if (!sd_.file_exists(directory_)) {
+        auto created = sd_.create_directory(directory_);
+        if (!created.is_ok()) {
+            return created;
+        }
+    }
+
+    // 路径直接写入卡上的临时文件，RAM中只保存定长记录和名字
+    char path[MICRO_SD_MAX_PATH];
+    file_path(PATHS_FILE, path, sizeof(path));
+    auto opened = sd_.open_file(path, "w");
+    if (!opened.is_ok()) {
+        return Result<void>(opened.error_code());
+    }
+    paths_file_ = std::move(*opened);
+    records_.reserve(config_.max_files);
+    names_.reserve(config_.name_bytes);
+    paths_size_ = 0;
+
+    walker_ = make_pmr<TreeWalker>(sd_.get_memory_resource(), sd_);
+    auto started = walker_->start("/");
+    if (!started.is_ok()) {
+        abort_rebuild();
+        return started;
+    }
+    journal_mark_ = journal_.size();
+    incomplete_ = false;
+    build_error_ = ErrorCode::SUCCESS;
+    rebuilding_ = true;
+    return Result<void>();
+}
+
+Result<void> SearchIndex::write_index(const char* path) {
+    auto opened = sd_.open_file(path, "w");
+    if (!opened.is_ok()) {
+        return Result<void>(opened.error_code());
+    }
+    RWSD::FileHandle out = std::move(*opened);
+    const char* names = names_.data();
+    uint32_t count = (uint32_t)records_.size();
+
+    uint8_t header[HEADER_SIZE] = {};
+    uint32_t suffix_offset = HEADER_SIZE + count * RECORD_SIZE;
+    uint32_t strings_offset = suffix_offset + count * 4;
+    memcpy(header, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    store_u32(header + 4, VERSION);
+    store_u32(header + 8, count);
+    store_u32(header + 12, suffix_offset);
+    store_u32(header + 16, strings_offset);
+    store_u32(header + 20, paths_size_);
+    store_u32(header + 28, fnv1a(header, 28));
+    auto written = write_all(out, header, sizeof(header));
+
+    // 名字记录
+    std::sort(records_.begin(), records_.end(), [names](const BuildRecord& a, const BuildRecord& b) {
+        return compare_names(names + a.name_offset, a.name_length, names + b.name_offset, b.name_length, false) < 0;
+    });
+    uint8_t buffer[512];
+    size_t used = 0;
+    for (uint32_t i = 0; i < count && written.is_ok(); ++i) {
+        BuildRecord& record = records_[i];
+        record.rank = i;
+        store_u32(buffer + used, record.path_offset);
+        store_u16(buffer + used + 4, record.path_length);
+        buffer[used + 6] = record.name_length;
+        buffer[used + 7] = 0;
+        used += RECORD_SIZE;
+        if (used == sizeof(buffer) || i + 1 == count) {
+            written = write_all(out, buffer, used);
+            used = 0;
+        }
+    }
+
+    // 后缀数组
+    std::sort(records_.begin(), records_.end(), [names](const BuildRecord& a, const BuildRecord& b) {
+        return compare_names(names + a.name_offset, a.name_length, names + b.name_offset, b.name_length, true) < 0;
+    });
+    for (uint32_t i = 0; i < count && written.is_ok(); ++i) {
+        store_u32(buffer + used, records_[i].rank);
+        used += 4;
+        if (used == sizeof(buffer) || i + 1 == count) {
+            written = write_all(out, buffer, used);
+            used = 0;
+        }
+    }
+
+    // 路径区: 从路径文件复制
+    char paths[MICRO_SD_MAX_PATH];
+    file_path(PATHS_FILE, paths, sizeof(paths));
+    for (uint32_t offset = 0; offset < paths_size_ && written.is_ok();) {
+        auto read = sd_.read_file_into(paths, buffer, std::min<size_t>(sizeof(buffer), paths_size_ - offset), offset);
+        if (!read.is_ok() || *read == 0) {
+            written = Result<void>(read.is_ok() ? ErrorCode::IO_ERROR : read.error_code());
+            break;
+        }
+        written = write_all(out, buffer, *read);
+        offset += (uint32_t)*read;
+    }
+
+    auto flushed = out.flush();
+    out.close();
+    return written.is_ok() ? flushed : written;
+}
+
+Result<void> SearchIndex::finish_rebuild() {
+    walker_.reset();
+    auto flushed = paths_file_.flush();
+    paths_file_.close();
+    if (!flushed.is_ok()) {
+        return flushed;
+    }
+
+    // 写入临时文件后替换，中断时旧索引仍然可用
+    char temp[MICRO_SD_MAX_PATH];
+    char path[MICRO_SD_MAX_PATH];
+    file_path(INDEX_TEMP_FILE, temp, sizeof(temp));
+    file_path(INDEX_FILE, path, sizeof(path));
+    auto written = write_index(temp);
+    if (!written.is_ok()) {
+        return written;
+    }
+    auto replaced = sd_.replace_file(path, temp);
+    if (!replaced.is_ok()) {
+        return replaced;
+    }
+
+    bool incomplete = incomplete_;
+    abort_rebuild();  // 释放缓冲区并删除路径文件
+    auto loaded = load_header();
+    if (!loaded.is_ok()) {
+        stale_ = true;
+        return loaded;
+    }
+
+    // 重建开始前的变更已包含在遍历结果中；之后的变更无条件记录，继续有效
+    journal_.erase(journal_.begin() + JOURNAL_HEADER, journal_.begin() + journal_mark_);
+    journal_records_ = 0;
+    for (size_t position = JOURNAL_HEADER; position + 2 <= journal_.size(); position += 2 + journal_[position + 1]) {
+        ++journal_records_;
+    }
+    stale_ = incomplete;
+    present_[0] = '\0';
+    journal_saved_ = false;
+    ++stats_.rebuilds;
+    return save_journal();
+}
+
+void SearchIndex::abort_rebuild() {
+    if (walker_) {
+        walker_->cancel();
+        walker_.reset();
+    }
+    paths_file_.close();
+    release(records_);
+    release(names_);
+    if (rebuilding_ && sd_.is_initialized()) {
+        char path[MICRO_SD_MAX_PATH];
+        file_path(PATHS_FILE, path, sizeof(path));
+        (void)sd_.delete_file(path);
+        file_path(INDEX_TEMP_FILE, path, sizeof(path));
+        (void)sd_.delete_file(path);
+    }
+    rebuilding_ = false;
+}
+
+Result<bool> SearchIndex::rebuild_step(size_t max_entries) {
+    if (!open_) {
+        return Result<bool>(ErrorCode::INIT_FAILED);
+    }
+    if (!rebuilding_) {
+        auto started = start_rebuild();
+        if (!started.is_ok()) {
+            return Result<bool>(started.error_code(), started.error_message());
+        }
+        return Result<bool>(false);
+    }
+
+    Collector collector(*this);
+    auto done = walker_->resume(collector, max_entries);
+    if (!done.is_ok() || build_error_ != ErrorCode::SUCCESS) {
+        ErrorCode code = done.is_ok() ? build_error_ : done.error_code();
+        const char* message = done.is_ok() ? nullptr : done.error_message();
+        abort_rebuild();
+        return Result<bool>(code, message);
+    }
+    if (!*done) {
+        return Result<bool>(false);
+    }
+    auto finished = finish_rebuild();
+    if (!finished.is_ok()) {
+        abort_rebuild();
+        return Result<bool>(finished.error_code(), finished.error_message());
+    }
+    return Result<bool>(true);
+}
+
+Result<void> SearchIndex::rebuild() {
+    while (true) {
+        auto step = rebuild_step(0);
+        if (!step.is_ok()) {
+            return Result<void>(step.error_code(), step.error_message());
+        }
+        if (*step) {
+            return Result<void>();
+        }
+    }
+}
+
+bool SearchIndex::needs_rebuild() const {
+    return open_ && (stale_ || (journal_.size() - JOURNAL_HEADER) * 4 > config_.journal_bytes * 3);
+}
+
+SearchIndexStats SearchIndex::get_stats() const {
+    SearchIndexStats stats = stats_;
+    stats.files = count_;
+    stats.pending = journal_records_;
+    stats.stale = stale_;
+    return stats;
+}
+
+} // namespace MicroSD
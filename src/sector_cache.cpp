@@ -0,0 +1,391 @@
+/**
+ * @file sector_cache.cpp
+ * @brief 写回式LRU扇区缓存实现
+ * @version 1.0.0
+ */
+
+#include "sector_cache.hpp"
+#include <string.h>
+#include <algorithm>
+#include <sstream>
+
+namespace MicroSD {
+
+// === 构造函数和析构函数 ===
+
+SectorCache::SectorCache(BlockDevice& device, const CacheConfig& config,
+                         std::pmr::memory_resource* memory)
+    : device_(device), config_(config), entries_(memory), data_(memory), index_(memory),
+      flush_order_(memory), flush_blocks_(memory), free_head_(NIL), max_pinned_(0),
+      pin_first_(0), pin_count_(0), metadata_window_(nullptr) {
+    size_t count = std::min<size_t>(config_.ram_budget / SECTOR_SIZE, NIL - 1);
+    entries_.resize(count);
+    data_.resize(count * SECTOR_SIZE);
+    flush_order_.reserve(count);
+    flush_blocks_.reserve(count);
+
+    // 哈希表大小取不小于2倍条目数的2的幂
+    size_t slots = 2;
+    while (slots < count * 2) {
+        slots <<= 1;
+    }
+    index_.resize(count > 0 ? slots : 0);
+
+    max_pinned_ = static_cast<uint16_t>(count * std::min<uint8_t>(config_.max_pinned_percent, 100) / 100);
+    invalidate();
+}
+
+SectorCache::~SectorCache() = default;
+
+void SectorCache::deinitialize() {
+    (void)flush();
+    device_.deinitialize();
+}
+
+// === 哈希索引 ===
+
+size_t SectorCache::slot_of(uint32_t sector) const {
+    return (sector * 2654435761u) & (index_.size() - 1);
+}
+
+uint16_t SectorCache::lookup(uint32_t sector) const {
+    if (index_.empty()) {
+        return NIL;
+    }
+    size_t mask = index_.size() - 1;
+    for (size_t i = slot_of(sector); index_[i] != NIL; i = (i + 1) & mask) {
+        if (entries_[index_[i]].sector == sector) {
+            return index_[i];
+        }
+    }
+    return NIL;
+}
+
+void SectorCache::index_insert(uint16_t idx) {
+    size_t mask = index_.size() - 1;
+    size_t i = slot_of(entries_[idx].sector);
+    while (index_[i] != NIL) {
+        i = (i + 1) & mask;
+    }
+    index_[i] = idx;
+}
+
+void SectorCache::index_erase(uint16_t idx) {
+    size_t mask = index_.size() - 1;
+    size_t i = slot_of(entries_[idx].sector);
+    while (index_[i] != idx) {
+        i = (i + 1) & mask;
+    }
+
+    // 线性探测的后移删除，避免墓碑
+    index_[i] = NIL;
+    size_t j = i;
+    while (true) {
+        j = (j + 1) & mask;
+        if (index_[j] == NIL) {
+            break;
+        }
+        size_t home = slot_of(entries_[index_[j]].sector);
+        bool stays = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+        if (!stays) {
+            index_[i] = index_[j];
+            index_[j] = NIL;
+            i = j;
+        }
+    }
+}
+
+// === LRU链表 ===
+
+void SectorCache::list_unlink(uint16_t idx) {
+    Entry& entry = entries_[idx];
+    LruList& list = list_of(entry);
+    if (entry.prev != NIL) {
+        entries_[entry.prev].next = entry.next;
+    } else {
+        list.head = entry.next;
+    }
+    if (entry.next != NIL) {
+        entries_[entry.next].prev = entry.prev;
+    } else {
+        list.tail = entry.prev;
+    }
+    entry.prev = entry.next = NIL;
+    list.size--;
+}
+
+void SectorCache::list_push_front(uint16_t idx) {
+    Entry& entry = entries_[idx];
+    LruList& list = list_of(entry);
+    entry.prev = NIL;
+    entry.next = list.head;
+    if (list.head != NIL) {
+        entries_[list.head].prev = idx;
+    }
+    list.head = idx;
+    if (list.tail == NIL) {
+        list.tail = idx;
+    }
+    list.size++;
+}
+
+void SectorCache::touch(uint16_t idx, bool pin) {
+    list_unlink(idx);
+    if (pin && !entries_[idx].pinned && pinned_.size < max_pinned_) {
+        entries_[idx].pinned = true;
+    }
+    list_push_front(idx);
+}
+
+// === 条目管理 ===
+
+bool SectorCache::should_pin(uint32_t sector, const uint8_t* buffer) const {
+    if (max_pinned_ == 0) {
+        return false;
+    }
+    if (metadata_window_ != nullptr && buffer == metadata_window_) {
+        return true;
+    }
+    return sector >= pin_first_ && sector - pin_first_ < pin_count_;
+}
+
+Result<void> SectorCache::write_back_entry(uint16_t idx) {
+    Entry& entry = entries_[idx];
+    auto result = device_.write(entry.sector, entry_data(idx), 1);
+    if (result.is_ok()) {
+        entry.dirty = false;
+        stats_.writebacks++;
+    }
+    return result;
+}
+
+void SectorCache::drop(uint16_t idx) {
+    index_erase(idx);
+    list_unlink(idx);
+    Entry& entry = entries_[idx];
+    entry.valid = false;
+    entry.dirty = false;
+    entry.pinned = false;
+    entry.next = free_head_;
+    free_head_ = idx;
+}
+
+Result<uint16_t> SectorCache::allocate(uint32_t sector, bool pin) {
+    if (free_head_ == NIL) {
+        // 固定扇区超过上限或普通链表为空时淘汰固定扇区
+        bool evict_pinned = normal_.size == 0 || (pin && pinned_.size >= max_pinned_);
+        uint16_t victim = evict_pinned ? pinned_.tail : normal_.tail;
+        if (entries_[victim].dirty) {
+            auto result = write_back_entry(victim);
+            if (!result.is_ok()) {
+                return Result<uint16_t>(result.error_code());
+            }
+        }
+        drop(victim);
+        stats_.evictions++;
+    }
+
+    uint16_t idx = free_head_;
+    Entry& entry = entries_[idx];
+    free_head_ = entry.next;
+
+    entry.sector = sector;
+    entry.valid = true;
+    entry.dirty = false;
+    entry.pinned = pin && pinned_.size < max_pinned_;
+    index_insert(idx);
+    list_push_front(idx);
+    return Result<uint16_t>(idx);
+}
+
+// === BlockDevice接口 ===
+
+Result<void> SectorCache::read(uint32_t sector, uint8_t* buffer, uint32_t count) {
+    if (entries_.empty()) {
+        return device_.read(sector, buffer, count);
+    }
+
+    // 大块顺序读取直接访问设备，再用脏扇区覆盖
+    if (config_.bypass_threshold > 0 && count >= config_.bypass_threshold) {
+        auto result = device_.read(sector, buffer, count);
+        if (!result.is_ok()) {
+            return result;
+        }
+        for (uint16_t i = 0; i < entries_.size(); ++i) {
+            const Entry& entry = entries_[i];
+            if (entry.valid && entry.dirty && entry.sector >= sector && entry.sector - sector < count) {
+                memcpy(buffer + (size_t)(entry.sector - sector) * SECTOR_SIZE, entry_data(i), SECTOR_SIZE);
+            }
+        }
+        stats_.bypass_sectors += count;
+        return Result<void>();
+    }
+
+    bool pin_hint = metadata_window_ != nullptr && buffer == metadata_window_;
+    uint32_t i = 0;
+    while (i < count) {
+        uint16_t idx = lookup(sector + i);
+        if (idx != NIL) {
+            memcpy(buffer + (size_t)i * SECTOR_SIZE, entry_data(idx), SECTOR_SIZE);
+            touch(idx, pin_hint);
+            stats_.hits++;
+            ++i;
+            continue;
+        }
+
+        // 合并连续未命中扇区为一次设备读取
+        uint32_t run_end = i + 1;
+        while (run_end < count && lookup(sector + run_end) == NIL) {
+            ++run_end;
+        }
+        auto result = device_.read(sector + i, buffer + (size_t)i * SECTOR_SIZE, run_end - i);
+        if (!result.is_ok()) {
+            return result;
+        }
+        stats_.misses += run_end - i;
+
+        for (uint32_t k = i; k < run_end; ++k) {
+            auto slot = allocate(sector + k, should_pin(sector + k, buffer));
+            if (!slot.is_ok()) {
+                return Result<void>(slot.error_code());
+            }
+            memcpy(entry_data(*slot), buffer + (size_t)k * SECTOR_SIZE, SECTOR_SIZE);
+        }
+        i = run_end;
+    }
+    return Result<void>();
+}
+
+Result<void> SectorCache::write(uint32_t sector, const uint8_t* buffer, uint32_t count) {
+    if (entries_.empty()) {
+        return device_.write(sector, buffer, count);
+    }
+
+    bool bypass = config_.bypass_threshold > 0 && count >= config_.bypass_threshold;
+    if (bypass || !config_.write_back) {
+        auto result = device_.write(sector, buffer, count);
+        if (!result.is_ok()) {
+            return result;
+        }
+        if (bypass) {
+            stats_.bypass_sectors += count;
+        }
+    }
+
+    for (uint32_t i = 0; i < count; ++i) {
+        uint16_t idx = lookup(sector + i);
+        if (idx == NIL) {
+            if (bypass) {
+                continue;   // 大块写入不占用缓存
+            }
+            auto slot = allocate(sector + i, should_pin(sector + i, buffer));
+            if (!slot.is_ok()) {
+                return Result<void>(slot.error_code());
+            }
+            idx = *slot;
+        } else if (!bypass) {
+            touch(idx, should_pin(sector + i, buffer));
+        }
+
+        memcpy(entry_data(idx), buffer + (size_t)i * SECTOR_SIZE, SECTOR_SIZE);
+        entries_[idx].dirty = !bypass && config_.write_back;
+    }
+    return Result<void>();
+}
+
+Result<void> SectorCache::sync() {
+    if (!config_.honor_device_sync) {
+        return Result<void>();
+    }
+    return flush();
+}
+
+Result<void> SectorCache::trim(uint32_t first_sector, uint32_t count) {
+    for (uint16_t i = 0; i < entries_.size(); ++i) {
+        const Entry& entry = entries_[i];
+        if (entry.valid && entry.sector >= first_sector && entry.sector - first_sector < count) {
+            drop(i);
+        }
+    }
+    return device_.trim(first_sector, count);
+}
+
+std::string SectorCache::get_config_info() const {
+    std::ostringstream oss;
+    oss << device_.get_config_info();
+    oss << "=== 扇区缓存配置 ===\n";
+    oss << "缓存容量: " << entries_.size() << " 扇区 (" << data_.size() / 1024 << " KB)\n";
+    oss << "写入策略: " << (config_.write_back ? "写回" : "写穿透") << "\n";
+    oss << "固定扇区上限: " << max_pinned_ << "\n";
+    return oss.str();
+}
+
+// === 缓存控制 ===
+
+Result<void> SectorCache::flush() {
+    // 按扇区号排序，连续的脏扇区合并为一次write_gather (SD卡上为一条多块写命令)
+    flush_order_.clear();
+    for (uint16_t i = 0; i < entries_.size(); ++i) {
+        if (entries_[i].valid && entries_[i].dirty) {
+            flush_order_.push_back(i);
+        }
+    }
+    std::sort(flush_order_.begin(), flush_order_.end(), [this](uint16_t a, uint16_t b) {
+        return entries_[a].sector < entries_[b].sector;
+    });
+
+    size_t run_start = 0;
+    while (run_start < flush_order_.size()) {
+        uint32_t first_sector = entries_[flush_order_[run_start]].sector;
+        size_t run_end = run_start + 1;
+        while (run_end < flush_order_.size() &&
+               entries_[flush_order_[run_end]].sector == first_sector + (run_end - run_start)) {
+            ++run_end;
+        }
+
+        flush_blocks_.clear();
+        for (size_t k = run_start; k < run_end; ++k) {
+            flush_blocks_.push_back(entry_data(flush_order_[k]));
+        }
+        uint32_t count = static_cast<uint32_t>(run_end - run_start);
+        auto result = device_.write_gather(first_sector, flush_blocks_.data(), count);
+        if (!result.is_ok()) {
+            return result;
+        }
+        for (size_t k = run_start; k < run_end; ++k) {
+            entries_[flush_order_[k]].dirty = false;
+        }
+        stats_.writebacks += count;
+        run_start = run_end;
+    }
+    return device_.sync();
+}
+
+void SectorCache::invalidate() {
+    std::fill(index_.begin(), index_.end(), NIL);
+    normal_ = LruList();
+    pinned_ = LruList();
+    free_head_ = entries_.empty() ? NIL : 0;
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        Entry& entry = entries_[i];
+        entry.sector = 0;
+        entry.prev = NIL;
+        entry.next = (i + 1 < entries_.size()) ? static_cast<uint16_t>(i + 1) : NIL;
+        entry.valid = false;
+        entry.dirty = false;
+        entry.pinned = false;
+    }
+}
+
+void SectorCache::set_pinned_range(uint32_t first_sector, uint32_t count) {
+    pin_first_ = first_sector;
+    pin_count_ = count;
+}
+
+size_t SectorCache::dirty_count() const {
+    return std::count_if(entries_.begin(), entries_.end(), [](const Entry& entry) {
+        return entry.valid && entry.dirty;
+    });
+}
+
+} // namespace MicroSD
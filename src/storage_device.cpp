@@ -24,6 +24,8 @@ std::string StorageDevice::get_error_description(ErrorCode error_code) {
             return "无效参数";
         case ErrorCode::FATFS_ERROR:
             return "文件系统错误";
+        case ErrorCode::CANCELLED:
+            return "操作已取消";
         case ErrorCode::UNKNOWN_ERROR:
         default:
             return "未知错误";
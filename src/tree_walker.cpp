@@ -0,0 +1,385 @@
+/**
+ * @file tree_walker.cpp
+ * @brief 目录树遍历实现
+ * @version 1.0.0
+ */
+
+#include "tree_walker.hpp"
+#include <string.h>
+#include <algorithm>
+
+namespace MicroSD {
+
+namespace {
+
+// 目录在前，然后按名字
+int compare_entries(bool a_directory, const char* a, bool b_directory, const char* b) {
+    if (a_directory != b_directory) {
+        return a_directory ? -1 : 1;
+    }
+    return strcmp(a, b);
+}
+
+} // namespace
+
+// === TreeWalker ===
+
+TreeWalker::TreeWalker(const RWSD& sd)
+    : sd_(sd), batch_count_(0), batch_next_(0), batch_depth_(NO_BATCH), batch_complete_(false), open_levels_(0),
+      max_depth_(0) {
+    path_[0] = '\0';
+}
+
+void TreeWalker::close_levels() {
+    while (open_levels_ > 0) {
+        f_closedir(&levels_[--open_levels_].dir);
+    }
+}
+
+bool TreeWalker::accept(const FILINFO& entry) const {
+    const char* name = entry.fname;
+    if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+        return false;
+    }
+    if (entry.fattrib & AM_DIR) {
+        const DirectoryFilter& filter = options_.filter;
+        return (entry.fattrib & filter.attributes) == filter.attributes &&
+               (entry.fattrib & filter.exclude_attributes) == 0;
+    }
+    return options_.filter.matches(name, entry.fattrib);
+}
+
+FRESULT TreeWalker::read_entry(DIR& dir, bool& end) {
+    FRESULT fr = f_readdir(&dir, &entry_);
+    end = fr != FR_OK || entry_.fname[0] == '\0';
+    if (!end) {
+        ++stats_.entries_read;
+    }
+    return fr;
+}
+
+FRESULT TreeWalker::next_unsorted(Level& level, bool& found) {
+    found = false;
+    bool end;
+    do {
+        FRESULT fr = read_entry(level.dir, end);
+        if (fr != FR_OK || end) {
+            return fr;
+        }
+    } while (!accept(entry_));
+
+    current_.size = entry_.fsize;
+    current_.date = entry_.fdate;
+    current_.time = entry_.ftime;
+    current_.attributes = entry_.fattrib;
+    memcpy(current_.name, entry_.fname, sizeof(current_.name));
+
+    // 预读下一个符合条件的目录项以确定is_last，然后恢复读取位置
+    DIR saved = level.dir;
+    current_.is_last = true;
+    while (true) {
+        FRESULT fr = read_entry(level.dir, end);
+        if (fr != FR_OK) {
+            return fr;
+        }
+        if (end) {
+            break;
+        }
+        if (accept(entry_)) {
+            current_.is_last = false;
+            break;
+        }
+    }
+    level.dir = saved;
+    found = true;
+    return FR_OK;
+}
+
+FRESULT TreeWalker::next_sorted(Level& level, uint8_t depth, bool& found) {
+    found = false;
+    if (batch_depth_ != depth || batch_next_ == batch_count_) {
+        if (batch_depth_ == depth && batch_complete_) {
+            return FR_OK;
+        }
+        FRESULT fr = fill_batch(level);
+        if (fr != FR_OK) {
+            return fr;
+        }
+        batch_depth_ = depth;
+        if (batch_count_ == 0) {
+            return FR_OK;
+        }
+    }
+
+    current_ = batch_[batch_next_++];
+    current_.is_last = batch_complete_ && batch_next_ == batch_count_;
+    found = true;
+    return FR_OK;
+}
+
+FRESULT TreeWalker::fill_batch(Level& level) {
+    batch_count_ = 0;
+    batch_next_ = 0;
+    batch_complete_ = true;
+    FRESULT fr = f_rewinddir(&level.dir);
+    if (fr != FR_OK) {
+        return fr;
+    }
+
+    // 上一个输出的子项仍在路径缓冲区中，作为本次扫描的下界；保留下界之后最小的SORT_BATCH项
+    const char* last = level.has_last ? path_ + level.path_length + 1 : nullptr;
+    bool end;
+    while (true) {
+        fr = read_entry(level.dir, end);
+        if (fr != FR_OK) {
+            return fr;
+        }
+        if (end) {
+            break;
+        }
+        if (!accept(entry_)) {
+            continue;
+        }
+        bool directory = (entry_.fattrib & AM_DIR) != 0;
+        if (last && compare_entries(directory, entry_.fname, level.last_is_directory, last) <= 0) {
+            continue;
+        }
+
+        // 插入有序的批缓冲区，满时挤掉最大的一项
+        uint8_t position = batch_count_;
+        while (position > 0 && compare_entries(directory, entry_.fname, (batch_[position - 1].attributes & AM_DIR) != 0,
+                                               batch_[position - 1].name) < 0) {
+            --position;
+        }
+        if (batch_count_ == SORT_BATCH) {
+            batch_complete_ = false;
+            if (position == SORT_BATCH) {
+                continue;
+            }
+        } else {
+            ++batch_count_;
+        }
+        for (uint8_t i = batch_count_ - 1; i > position; --i) {
+            batch_[i] = batch_[i - 1];
+        }
+        Candidate& candidate = batch_[position];
+        candidate.size = entry_.fsize;
+        candidate.date = entry_.fdate;
+        candidate.time = entry_.ftime;
+        candidate.attributes = entry_.fattrib;
+        memcpy(candidate.name, entry_.fname, sizeof(candidate.name));
+    }
+    return FR_OK;
+}
+
+Result<WalkStats> TreeWalker::walk(const std::string& root, WalkSink& sink, const WalkOptions& options) {
+    auto started = start(root, options);
+    if (!started.is_ok()) {
+        return Result<WalkStats>(started.error_code(), started.error_message());
+    }
+    auto done = resume(sink, 0);
+    if (!done.is_ok()) {
+        return Result<WalkStats>(done.error_code(), done.error_message());
+    }
+    return Result<WalkStats>(stats_);
+}
+
+Result<void> TreeWalker::start(const std::string& root, const WalkOptions& options) {
+    if (!sd_.is_initialized()) {
+        return Result<void>(ErrorCode::INIT_FAILED);
+    }
+    close_levels();
+    options_ = options;
+    stats_ = WalkStats();
+    max_depth_ = std::min(options.max_depth, MAX_DEPTH);
+    if (max_depth_ == 0) {
+        return Result<void>();
+    }
+
+    // 根目录 ("" 或 "/") 下的路径为 "/name"
+    size_t length = root.size();
+    while (length > 0 && root[length - 1] == '/') {
+        --length;
+    }
+    if (length >= MICRO_SD_MAX_PATH) {
+        return Result<void>(ErrorCode::INVALID_PARAMETER, "路径过长");
+    }
+    memcpy(path_, root.data(), length);
+    path_[length] = '\0';
+
+    Level& top = levels_[0];
+    FRESULT fr = f_opendir(&top.dir, length > 0 ? path_ : "/");
+    if (fr != FR_OK) {
+        return Result<void>(RWSD::fresult_to_error_code(fr));
+    }
+    top.path_length = (uint16_t)length;
+    top.has_last = false;
+    batch_depth_ = NO_BATCH;
+    open_levels_ = 1;
+    return Result<void>();
+}
+
+Result<bool> TreeWalker::resume(WalkSink& sink, size_t max_entries) {
+    size_t reported = 0;
+    while (open_levels_ > 0) {
+        if (max_entries > 0 && reported == max_entries) {
+            return Result<bool>(false);
+        }
+        uint8_t depth = open_levels_ - 1;
+        Level& level = levels_[depth];
+        bool found;
+        FRESULT fr = options_.sorted ? next_sorted(level, depth, found) : next_unsorted(level, found);
+        if (fr != FR_OK) {
+            close_levels();
+            return Result<bool>(RWSD::fresult_to_error_code(fr));
+        }
+
+        if (!found) {
+            // 本层结束，回到上一层并报告该目录的后序回调
+            f_closedir(&level.dir);
+            --open_levels_;
+            path_[level.path_length] = '\0';
+            if (depth > 0) {
+                WalkEntry entry = {path_, path_ + levels_[depth - 1].path_length + 1, 0,
+                                   level.date, level.time, level.attributes, (uint8_t)(depth - 1), level.is_last};
+                sink.leave(entry);
+            }
+            continue;
+        }
+
+        size_t name_length = strlen(current_.name);
+        size_t child_length = level.path_length + 1 + name_length;
+        if (child_length >= MICRO_SD_MAX_PATH) {
+            close_levels();
+            return Result<bool>(ErrorCode::INVALID_PARAMETER, "路径过长");
+        }
+        path_[level.path_length] = '/';
+        memcpy(path_ + level.path_length + 1, current_.name, name_length + 1);
+
+        bool directory = (current_.attributes & AM_DIR) != 0;
+        level.has_last = true;
+        level.last_is_directory = directory;
+        if (directory) {
+            ++stats_.directories;
+        } else {
+            ++stats_.files;
+            stats_.bytes += current_.size;
+        }
+
+        WalkEntry entry = {path_, path_ + level.path_length + 1, current_.size, current_.date,
+                           current_.time, current_.attributes, depth, current_.is_last};
+        ++reported;
+        WalkAction action = sink.enter(entry);
+        if (action == WalkAction::STOP) {
+            close_levels();
+            break;
+        }
+        if (!directory || action == WalkAction::SKIP) {
+            continue;
+        }
+        if (depth + 1 >= max_depth_) {
+            ++stats_.depth_limited;
+            sink.depth_limit(entry);
+            continue;
+        }
+
+        Level& child = levels_[depth + 1];
+        fr = f_opendir(&child.dir, path_);
+        if (fr != FR_OK) {
+            close_levels();
+            return Result<bool>(RWSD::fresult_to_error_code(fr));
+        }
+        child.path_length = (uint16_t)child_length;
+        child.has_last = false;
+        child.date = current_.date;
+        child.time = current_.time;
+        child.attributes = current_.attributes;
+        child.is_last = current_.is_last;
+        batch_depth_ = NO_BATCH;        // 子目录的扫描会占用批缓冲区，回到本层时从下界重新扫描
+        ++open_levels_;
+    }
+    return Result<bool>(true);
+}
+
+// === TreePrinter ===
+
+TreePrinter::TreePrinter(FILE* stream)
+    : stream_(stream), file_(nullptr), text_(nullptr), last_mask_(0), error_(ErrorCode::SUCCESS) {}
+
+TreePrinter::TreePrinter(RWSD::FileHandle& file)
+    : stream_(nullptr), file_(&file), text_(nullptr), last_mask_(0), error_(ErrorCode::SUCCESS) {}
+
+TreePrinter::TreePrinter(std::string& text)
+    : stream_(nullptr), file_(nullptr), text_(&text), last_mask_(0), error_(ErrorCode::SUCCESS) {}
+
+void TreePrinter::write_line(size_t length) {
+    if (stream_) {
+        fwrite(line_, 1, length, stream_);
+    } else if (file_) {
+        auto written = file_->write(line_, length);
+        if (!written.is_ok()) {
+            error_ = written.error_code();
+        } else if (*written < length) {
+            error_ = ErrorCode::DISK_FULL;
+        }
+    } else if (text_) {
+        text_->append(line_, length);
+    }
+}
+
+size_t TreePrinter::format_prefix(uint8_t depth, bool is_last) {
+    if (depth < 32) {
+        last_mask_ = is_last ? (last_mask_ | (1u << depth)) : (last_mask_ & ~(1u << depth));
+    }
+    if (depth == 0) {
+        return 0;
+    }
+
+    // 祖先不是最后一项时画竖线，本项画分支
+    size_t length = 0;
+    for (uint8_t level = 1; level < depth; ++level) {
+        bool ancestor_last = level < 32 && (last_mask_ & (1u << level));
+        const char* segment = ancestor_last ? "    " : "│   ";
+        size_t segment_length = strlen(segment);
+        if (length + segment_length >= sizeof(line_) / 2) {
+            break;
+        }
+        memcpy(line_ + length, segment, segment_length);
+        length += segment_length;
+    }
+    const char* branch = is_last ? "└── " : "├── ";
+    size_t branch_length = strlen(branch);
+    memcpy(line_ + length, branch, branch_length);
+    return length + branch_length;
+}
+
+WalkAction TreePrinter::enter(const WalkEntry& entry) {
+    size_t length = format_prefix(entry.depth, entry.is_last);
+    size_t room = sizeof(line_) - 1;
+    length += snprintf(line_ + length, sizeof(line_) - length, "%s %s",
+                       entry.is_directory() ? "📁" : "📄", entry.name);
+    length = std::min(length, room);
+
+    if (!entry.is_directory() && entry.size > 0) {
+        unsigned long long size = entry.size;
+        if (size < 1024) {
+            length += snprintf(line_ + length, sizeof(line_) - length, " (%llu B)", size);
+        } else if (size < 1024 * 1024) {
+            length += snprintf(line_ + length, sizeof(line_) - length, " (%llu KB)", size / 1024);
+        } else {
+            length += snprintf(line_ + length, sizeof(line_) - length, " (%llu MB)", size / (1024 * 1024));
+        }
+        length = std::min(length, room);
+    }
+    line_[length++] = '\n';
+    write_line(length);
+    return error_ == ErrorCode::SUCCESS ? WalkAction::CONTINUE : WalkAction::STOP;
+}
+
+void TreePrinter::depth_limit(const WalkEntry& entry) {
+    size_t length = format_prefix(entry.depth + 1, true);
+    length += snprintf(line_ + length, sizeof(line_) - length, "[达到最大深度限制]\n");
+    write_line(std::min(length, sizeof(line_) - 1));
+}
+
+} // namespace MicroSD
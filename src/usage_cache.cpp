@@ -0,0 +1,171 @@
+/**
+ * @file usage_cache.cpp
+ * @brief 目录占用缓存实现
+ * @version 1.0.0
+ */
+
+#include "usage_cache.hpp"
+#include <string.h>
+
+namespace MicroSD {
+
+namespace {
+
+inline char upper(char c) {
+    return (c >= 'a' && c <= 'z') ? c - 'a' + 'A' : c;
+}
+
+bool same_name(const char* a, const char* b, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        if (upper(a[i]) != upper(b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+UsageCache::UsageCache() : clock_(0) {
+    for (Entry& entry : entries_) {
+        entry.last_use = 0;
+        entry.valid = false;
+        entry.length = 0;
+        entry.path[0] = '\0';
+    }
+}
+
+size_t UsageCache::normalize(const char* path, char* out) {
+    size_t length = 0;
+    for (const char* p = path; *p; ++p) {
+        if (*p == '/' && (length == 0 || out[length - 1] == '/')) {
+            continue;
+        }
+        if (length + 1 >= MAX_PATH) {
+            return MAX_PATH;
+        }
+        out[length++] = *p;
+    }
+    if (length > 0 && out[length - 1] == '/') {
+        --length;
+    }
+    out[length] = '\0';
+    return length;
+}
+
+bool UsageCache::contains(const Entry& entry, const char* normalized, size_t length) {
+    return entry.valid && length >= entry.length && same_name(entry.path, normalized, entry.length) &&
+           (entry.length == 0 || normalized[entry.length] == '\0' || normalized[entry.length] == '/');
+}
+
+bool UsageCache::lookup(const char* path, DirectoryUsage& usage) {
+    char normalized[MAX_PATH];
+    size_t length = normalize(path, normalized);
+    if (length < MAX_PATH) {
+        for (Entry& entry : entries_) {
+            if (entry.valid && entry.length == length && same_name(entry.path, normalized, length)) {
+                entry.last_use = ++clock_;
+                ++stats_.hits;
+                usage = entry.usage;
+                return true;
+            }
+        }
+    }
+    ++stats_.misses;
+    return false;
+}
+
+void UsageCache::insert(const char* path, const DirectoryUsage& usage) {
+    char normalized[MAX_PATH];
+    size_t length = normalize(path, normalized);
+    if (length >= MAX_PATH) {
+        return;
+    }
+
+    Entry* target = &entries_[0];
+    for (Entry& entry : entries_) {
+        if (entry.valid && entry.length == length && same_name(entry.path, normalized, length)) {
+            target = &entry;
+            break;
+        }
+        if (!entry.valid) {
+            target = &entry;
+        } else if (target->valid && entry.last_use < target->last_use) {
+            target = &entry;
+        }
+    }
+
+    target->usage = usage;
+    target->last_use = ++clock_;
+    target->valid = true;
+    target->length = (uint16_t)length;
+    memcpy(target->path, normalized, length + 1);
+}
+
+bool UsageCache::covers(const char* path) const {
+    char normalized[MAX_PATH];
+    size_t length = normalize(path, normalized);
+    for (const Entry& entry : entries_) {
+        // 放不下的路径无法比较，保守地认为被任何汇总包含
+        if (entry.valid && (length >= MAX_PATH || contains(entry, normalized, length))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void UsageCache::adjust(const char* path, const DirectoryUsage& before, const DirectoryUsage& after) {
+    char normalized[MAX_PATH];
+    size_t length = normalize(path, normalized);
+    for (Entry& entry : entries_) {
+        if (!entry.valid) {
+            continue;
+        }
+        if (length >= MAX_PATH) {
+            // 无法判断是否包含，保守地失效
+            entry.valid = false;
+            ++stats_.invalidations;
+            continue;
+        }
+        if (!contains(entry, normalized, length)) {
+            continue;
+        }
+        if (entry.length < length) {
+            entry.usage -= before;
+            entry.usage += after;
+            ++stats_.updates;
+        } else {
+            // 汇总的就是被修改的目录本身
+            entry.valid = false;
+            ++stats_.invalidations;
+        }
+    }
+}
+
+void UsageCache::invalidate(const char* path) {
+    char normalized[MAX_PATH];
+    size_t length = normalize(path, normalized);
+    for (Entry& entry : entries_) {
+        if (!entry.valid) {
+            continue;
+        }
+        bool above = length < MAX_PATH && contains(entry, normalized, length);
+        bool below = length < MAX_PATH && entry.length >= length && same_name(entry.path, normalized, length) &&
+                     (length == 0 || entry.path[length] == '\0' || entry.path[length] == '/');
+        if (above || below || length >= MAX_PATH) {
+            entry.valid = false;
+            ++stats_.invalidations;
+        }
+    }
+}
+
+void UsageCache::invalidate_all() {
+    for (Entry& entry : entries_) {
+        if (entry.valid) {
+            entry.valid = false;
+            ++stats_.invalidations;
+        }
+    }
+}
+
+} // namespace MicroSD